@@ -0,0 +1,165 @@
+/*
+ * textscanner.h
+ */
+
+#ifndef BINARY_TEXTSCANNER_H_
+#define BINARY_TEXTSCANNER_H_
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * Splits delimited text into fields. Calls f(begin, end, endOfLine) for every
+ * field; '\n' terminates a line and a trailing '\r' is stripped from the last
+ * field of the line. Text after the last '\n' is reported as a final line.
+ * With SSE2 the input is classified 16 bytes at a time and field boundaries
+ * are taken from the resulting bitmask.
+ */
+template <typename F>
+void scanFields(const char* begin, const char* end, char delimiter, F f)
+{
+	const char* fieldStart = begin;
+	const char* p = begin;
+
+	auto boundary = [&](const char* at)
+		{
+			bool endOfLine = *at == '\n';
+			const char* fieldEnd = at;
+			if(endOfLine && fieldEnd > fieldStart && fieldEnd[-1] == '\r')
+				fieldEnd--;
+			f(fieldStart, fieldEnd, endOfLine);
+			fieldStart = at + 1;
+		};
+
+#if defined(__SSE2__)
+	const __m128i delimiters = _mm_set1_epi8(delimiter);
+	const __m128i newlines = _mm_set1_epi8('\n');
+	while(end - p >= 16)
+	{
+		__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+		unsigned mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, delimiters), _mm_cmpeq_epi8(block, newlines)));
+		while(mask)
+		{
+			int bit = __builtin_ctz(mask);
+			boundary(p + bit);
+			mask &= mask - 1;
+		}
+		p += 16;
+	}
+#endif
+
+	for(; p < end; p++)
+	{
+		if(*p == delimiter || *p == '\n')
+			boundary(p);
+	}
+
+	if(fieldStart < end)
+	{
+		const char* fieldEnd = end;
+		if(fieldEnd[-1] == '\r')
+			fieldEnd--;
+		f(fieldStart, fieldEnd, true);
+	}
+}
+
+/**
+ * Returns pointer to the first '\n' in [begin, end) or end.
+ */
+inline const char* findNewline(const char* begin, const char* end)
+{
+	auto p = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+	return p ? p : end;
+}
+
+/**
+ * Locale-independent decimal number parser. Accepts optional sign, '.' or ','
+ * as the decimal separator and spaces as thousands separators. Correctly
+ * rounded for up to 15 significant digits; digits past the 18th are dropped.
+ * Returns false if the field is not a number.
+ */
+inline bool parseNumber(const char* begin, const char* end, double& result)
+{
+	static const double powersOf10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+		1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+	while(begin < end && *begin == ' ')
+		begin++;
+	while(end > begin && end[-1] == ' ')
+		end--;
+	if(begin == end)
+		return false;
+
+	bool negative = false;
+	if(*begin == '-' || *begin == '+')
+	{
+		negative = *begin == '-';
+		begin++;
+	}
+
+	uint64_t mantissa = 0;
+	int digits = 0;
+	int fractionDigits = 0;
+	int exponent = 0;
+	bool seenSeparator = false;
+	bool seenDigit = false;
+	for(const char* p = begin; p < end; p++)
+	{
+		char c = *p;
+		if(c >= '0' && c <= '9')
+		{
+			seenDigit = true;
+			if(digits < 18)
+			{
+				mantissa = mantissa * 10 + (c - '0');
+				if(mantissa != 0)
+					digits++;
+				if(seenSeparator)
+					fractionDigits++;
+			}
+			else if(!seenSeparator)
+			{
+				exponent++;
+			}
+		}
+		else if((c == '.' || c == ',') && !seenSeparator)
+		{
+			seenSeparator = true;
+		}
+		else if(c == ' ' && !seenSeparator)
+		{
+			continue;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	if(!seenDigit)
+		return false;
+
+	exponent -= fractionDigits;
+	double value = (double)mantissa;
+	if(exponent < 0)
+	{
+		if(-exponent > 22)
+			return false;
+		value /= powersOf10[-exponent];
+	}
+	else if(exponent > 0)
+	{
+		if(exponent > 22)
+			return false;
+		value *= powersOf10[exponent];
+	}
+
+	result = negative ? -value : value;
+	return true;
+}
+
+#endif /* BINARY_TEXTSCANNER_H_ */
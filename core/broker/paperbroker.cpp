@@ -23,10 +23,11 @@ void PaperBroker::submitOrder(const goldmine::Order::Ptr& order)
 	m_allOrders.push_back(order);
 	LOG_WITH(gs_logger, info) << "VirtualBroker: submitted order: " << order->stringRepresentation();
 
+	auto instrument = InstrumentRegistry::instance().id(order->security());
 	if(order->type() == Order::OrderType::Market)
 	{
-		auto bidTick = m_table->lastQuote(order->security(), goldmine::Datatype::BestBid);
-		auto offerTick = m_table->lastQuote(order->security(), goldmine::Datatype::BestOffer);
+		auto bidTick = m_table->lastQuote(instrument, goldmine::Datatype::BestBid);
+		auto offerTick = m_table->lastQuote(instrument, goldmine::Datatype::BestOffer);
 		auto bid = bidTick.value.toDouble();
 		auto offer = offerTick.value.toDouble();
 
@@ -72,8 +73,10 @@ void PaperBroker::submitOrder(const goldmine::Order::Ptr& order)
 	else if(order->type() == Order::OrderType::Limit)
 	{
 		LOG_WITH(gs_logger, debug) << "Limit order";
-		auto bidTick = m_table->lastQuote(order->security(), goldmine::Datatype::BestBid);
-		auto offerTick = m_table->lastQuote(order->security(), goldmine::Datatype::BestOffer);
+		auto bidQuote = m_table->quote(instrument, goldmine::Datatype::BestBid);
+		auto offerQuote = m_table->quote(instrument, goldmine::Datatype::BestOffer);
+		const auto& bidTick = bidQuote.tick;
+		const auto& offerTick = offerQuote.tick;
 		auto bid = bidTick.value.toDouble();
 		auto offer = offerTick.value.toDouble();
 
@@ -81,7 +84,7 @@ void PaperBroker::submitOrder(const goldmine::Order::Ptr& order)
 
 		if(order->operation() == Order::Operation::Buy)
 		{
-			if((offerTick.value <= order->price()) && (offer != 0))
+			if((offer != 0) && (offerQuote.price <= orderPrice(order, offerQuote.step)))
 			{
 				double volume = offer * order->quantity();
 				if(m_cash < volume)
@@ -97,19 +100,19 @@ void PaperBroker::submitOrder(const goldmine::Order::Ptr& order)
 			}
 			else
 			{
-				addPendingOrder(order);
+				addPendingOrder(order, instrument);
 			}
 		}
 		else if(order->operation() == Order::Operation::Sell)
 		{
-			if((bid != 0) && (bidTick.value >= order->price()))
+			if((bid != 0) && (bidQuote.price >= orderPrice(order, bidQuote.step)))
 			{
 				LOG_WITH(gs_logger, debug) << "Order OK";
 				executeSellAt(order, bidTick.value, bidTick.timestamp, bidTick.useconds);
 			}
 			else
 			{
-				addPendingOrder(order);
+				addPendingOrder(order, instrument);
 			}
 		}
 		orderStateUpdated(order);
@@ -138,13 +141,13 @@ void PaperBroker::unregisterReactor(const std::shared_ptr<Reactor>& reactor)
 
 Order::Ptr PaperBroker::order(int localId)
 {
-	auto it = std::find_if(m_pendingOrders.begin(), m_pendingOrders.end(), [&](const Order::Ptr& order) { return order->localId() == localId; } );
-	if(it == m_pendingOrders.end())
-	{
-		it = std::find_if(m_allOrders.begin(), m_allOrders.end(), [&](const Order::Ptr& order) { return order->localId() == localId; } );
-		if(it == m_allOrders.end())
-			return Order::Ptr();
-	}
+	auto pending = std::find_if(m_pendingOrders.begin(), m_pendingOrders.end(), [&](const PendingOrder& pendingOrder) { return pendingOrder.order->localId() == localId; } );
+	if(pending != m_pendingOrders.end())
+		return pending->order;
+
+	auto it = std::find_if(m_allOrders.begin(), m_allOrders.end(), [&](const Order::Ptr& order) { return order->localId() == localId; } );
+	if(it == m_allOrders.end())
+		return Order::Ptr();
 
 	return *it;
 }
@@ -161,54 +164,73 @@ bool PaperBroker::hasAccount(const std::string& account)
 	return account == "demo";
 }
 
-void PaperBroker::addPendingOrder(const Order::Ptr& order)
+void PaperBroker::addPendingOrder(const Order::Ptr& order, InstrumentId instrument)
 {
 	order->updateState(Order::State::Submitted);
-	m_pendingOrders.push_back(order);
-	m_table->enableTicker(order->security());
+	auto step = InstrumentMetadata::instance().priceStep(instrument);
+	m_pendingOrders.push_back(PendingOrder { order, instrument, orderPrice(order, step), step });
+	m_table->enableTicker(instrument);
 }
 
-void PaperBroker::unsubscribeFromTickerIfNeeded(const std::string& ticker)
+void PaperBroker::unsubscribeFromTickerIfNeeded(InstrumentId instrument)
 {
-	auto it = std::find_if(m_pendingOrders.begin(), m_pendingOrders.end(), [&](const Order::Ptr& order) { return order->security() == ticker; } );
+	auto it = std::find_if(m_pendingOrders.begin(), m_pendingOrders.end(), [&](const PendingOrder& pendingOrder) { return pendingOrder.instrument == instrument; } );
 	if(it == m_pendingOrders.end())
 	{
-		m_table->disableTicker(ticker);
+		m_table->disableTicker(instrument);
 	}
 }
 
-void PaperBroker::incomingTick(const std::string& ticker, const goldmine::Tick& tick)
+TickPrice PaperBroker::orderPrice(const goldmine::Order::Ptr& order, double step)
+{
+	// Off-grid limits are rounded towards the safe side, so an order is never
+	// filled beyond its limit
+	auto price = goldmine::decimal_fixed(order->price()).toDouble();
+	if(order->operation() == goldmine::Order::Operation::Buy)
+		return InstrumentMetadata::toTicksFloor(price, step);
+	return InstrumentMetadata::toTicksCeil(price, step);
+}
+
+void PaperBroker::incomingTick(InstrumentId instrument, const QuoteTable::Quote& quote)
 {
+	const auto& tick = quote.tick;
 	boost::unique_lock<boost::recursive_mutex> lock(m_mutex);
-	LOG_WITH(gs_logger, debug) << "VirtualBroker::incomingTick: " << ticker;
+	LOG_WITH(gs_logger, debug) << "VirtualBroker::incomingTick: " << InstrumentRegistry::instance().name(instrument);
 	auto it = m_pendingOrders.begin();
 	while(it != m_pendingOrders.end())
 	{
 		auto next = it;
 		++next;
 
-		auto order = *it;
+		auto order = it->order;
 		LOG_WITH(gs_logger, debug) << "Order: " << order->stringRepresentation();
 		if(next != m_pendingOrders.end())
 		{
-			LOG_WITH(gs_logger, debug) << "Next Order: " << (*next)->stringRepresentation();
+			LOG_WITH(gs_logger, debug) << "Next Order: " << next->order->stringRepresentation();
 		}
-		if(order->security() == ticker)
+		if(it->instrument == instrument)
 		{
-			if((order->operation() == Order::Operation::Buy) && (tick.value <= order->price()) &&
+			// Price step may become known after the order was placed
+			if(it->step != quote.step)
+			{
+				it->step = quote.step;
+				it->price = orderPrice(order, quote.step);
+			}
+
+			if((order->operation() == Order::Operation::Buy) && (quote.price <= it->price) &&
 					((tick.datatype == (int)goldmine::Datatype::BestOffer) || (tick.datatype == (int)goldmine::Datatype::Price)))
 			{
 				executeBuyAt(order, order->price(), tick.timestamp, tick.useconds);
 				m_pendingOrders.erase(it);
-				unsubscribeFromTickerIfNeeded(order->security());
+				unsubscribeFromTickerIfNeeded(instrument);
 				orderStateUpdated(order);
 			}
-			else if((order->operation() == Order::Operation::Sell) && (tick.value >= order->price()) &&
+			else if((order->operation() == Order::Operation::Sell) && (quote.price >= it->price) &&
 					((tick.datatype == (int)goldmine::Datatype::BestBid) || (tick.datatype == (int)goldmine::Datatype::Price)))
 			{
 				executeSellAt(order, order->price(), tick.timestamp, tick.useconds);
 				m_pendingOrders.erase(it);
-				unsubscribeFromTickerIfNeeded(order->security());
+				unsubscribeFromTickerIfNeeded(instrument);
 				orderStateUpdated(order);
 			}
 		}
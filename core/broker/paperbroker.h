@@ -4,6 +4,7 @@
 #include "broker/broker.h"
 
 #include "core/quotetable.h"
+#include "core/instrumentregistry.h"
 
 #include <boost/thread/recursive_mutex.hpp>
 
@@ -27,9 +28,18 @@ public:
 	virtual std::list<goldmine::Position> positions();
 
 private:
-	void addPendingOrder(const goldmine::Order::Ptr& order);
-	void unsubscribeFromTickerIfNeeded(const std::string& ticker);
-	void incomingTick(const std::string& ticker, const goldmine::Tick& tick);
+	struct PendingOrder
+	{
+		goldmine::Order::Ptr order;
+		InstrumentId instrument;
+		TickPrice price;
+		double step;
+	};
+
+	void addPendingOrder(const goldmine::Order::Ptr& order, InstrumentId instrument);
+	void unsubscribeFromTickerIfNeeded(InstrumentId instrument);
+	void incomingTick(InstrumentId instrument, const QuoteTable::Quote& quote);
+	static TickPrice orderPrice(const goldmine::Order::Ptr& order, double step);
 
 private:
 	void orderStateUpdated(const goldmine::Order::Ptr& order);
@@ -39,7 +49,7 @@ private:
 
 private:
 	std::vector<std::shared_ptr<Reactor>> m_reactors;
-	std::list<goldmine::Order::Ptr> m_pendingOrders;
+	std::list<PendingOrder> m_pendingOrders;
 	std::list<goldmine::Order::Ptr> m_allOrders;
 	std::map<std::string, int> m_portfolio;
 	double m_cash;
@@ -173,10 +173,11 @@ static std::string makeKillOrderString(const Order::Ptr& order, int transactionI
 }
 
 QuikBroker::QuikBroker(const std::string& dllPath, const std::string& quikPath,
-				const std::list<std::string>& accounts) : m_quikPath(quikPath),
+				const std::list<std::string>& accounts, const PositionLedger::Ptr& ledger) : m_quikPath(quikPath),
 	m_run(false),
 	m_connected(false),
-	m_accounts(accounts)
+	m_accounts(accounts),
+	m_ledger(ledger)
 {
 	assert(!m_instance);
 	m_instance = this;
@@ -282,8 +283,9 @@ bool QuikBroker::hasAccount(const std::string& account)
 
 std::list<goldmine::Position> QuikBroker::positions()
 {
-	// TODO
-	return std::list<goldmine::Position>();
+	if(!m_ledger)
+		return std::list<goldmine::Position>();
+	return m_ledger->positions(m_accounts);
 }
 
 void __stdcall QuikBroker::connectionStatusCallback(long event, long errorCode, LPSTR infoMessage)
@@ -3,6 +3,7 @@
 
 #include "broker/broker.h"
 #include "trans2quik/trans2quik.h"
+#include "core/positionledger.h"
 
 #include <boost/thread.hpp>
 
@@ -12,7 +13,7 @@ class QuikBroker : public goldmine::Broker
 {
 public:
 	QuikBroker(const std::string& dllPath, const std::string& quikPath,
-				const std::list<std::string>& accounts);
+				const std::list<std::string>& accounts, const PositionLedger::Ptr& ledger);
 	virtual ~QuikBroker();
 
 	virtual void submitOrder(const goldmine::Order::Ptr& order);
@@ -56,6 +57,7 @@ private:
 	std::atomic_bool m_connected;
 
 	std::list<std::string> m_accounts;
+	PositionLedger::Ptr m_ledger;
 	boost::recursive_mutex m_mutex;
 
 	std::map<int, goldmine::Order::Ptr> m_unsubmittedOrders;
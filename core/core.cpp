@@ -3,9 +3,19 @@
 
 #include "core/tables/parsers/alldealstableparser.h"
 #include "core/tables/parsers/currentparametertableparser.h"
+#include "core/tables/parsers/generictableparser.h"
+#include "core/tables/parsers/depthtableparser.h"
+#include "core/tables/parsers/optionsboardtableparser.h"
+#include "core/tables/parsers/futurespositionstableparser.h"
+#include "core/tables/parsers/futureslimitstableparser.h"
 #include "tables/tableconstructor.h"
+#include "ingest/alldealsimporter.h"
 #include "broker/paperbroker.h"
 #include "broker/quikbroker.h"
+#include "sinks/quotesourcesink.h"
+#include "journal/tickjournal.h"
+
+#include "stats/latencyrecorder.h"
 
 #include "ui/mainwindow.h"
 
@@ -13,6 +23,7 @@
 #include "exceptions.h"
 
 #include <fstream>
+#include <sstream>
 #include <boost/optional.hpp>
 
 Core::Core(const boost::program_options::variables_map& config) :
@@ -23,16 +34,43 @@ Core::Core(const boost::program_options::variables_map& config) :
 	m_quotesourceServer(std::make_shared<goldmine::QuoteSource>(m_io, config["quotesource-endpoint"].as<std::string>())),
 	m_brokerServer(std::make_shared<goldmine::BrokerServer>(m_io, config["brokerserver-endpoint"].as<std::string>())),
 	m_run(false),
-	m_quoteTable(std::make_shared<QuoteTable>())
+	m_quoteTable(std::make_shared<QuoteTable>()),
+	m_positionLedger(std::make_shared<PositionLedger>()),
+	m_ring(std::make_shared<TickRing>(config["tick-ring-size"].as<int>())),
+	m_sinks(std::make_shared<SinkRegistry>(m_ring)),
+	m_importThreads(1)
 {
+	m_sinks->registerSink("quotesource", std::make_shared<QuoteSourceSink>(m_quotesourceServer),
+			SinkRegistry::parsePolicy(config["quotesource-sink-policy"].as<std::string>()));
+	m_sinks->registerSink("quotetable", m_quoteTable, SlowSinkPolicy::Block);
+	if(config.count("journal-dir"))
+	{
+		m_sinks->registerSink("journal", std::make_shared<TickJournal>(config["journal-dir"].as<std::string>()),
+				SinkRegistry::parsePolicy(config["journal-sink-policy"].as<std::string>()));
+	}
+
 	m_registry->registerFactory("current_parameters", std::unique_ptr<TableParserFactory>(new CurrentParameterTableParserFactory));
 	m_registry->registerFactory("all_deals", std::unique_ptr<TableParserFactory>(new AllDealsTableParserFactory));
+	m_registry->registerFactory("generic", std::unique_ptr<TableParserFactory>(new GenericTableParserFactory));
+	m_registry->registerFactory("depth", std::unique_ptr<TableParserFactory>(new DepthTableParserFactory));
+	m_registry->registerFactory("options_board", std::unique_ptr<TableParserFactory>(new OptionsBoardTableParserFactory(m_quoteTable)));
+	m_registry->registerFactory("futures_positions", std::unique_ptr<TableParserFactory>(new FuturesPositionsTableParserFactory(m_positionLedger)));
+	m_registry->registerFactory("futures_limits", std::unique_ptr<TableParserFactory>(new FuturesLimitsTableParserFactory(m_positionLedger)));
 	m_tablesConfig = config["tables-file"].as<std::string>();
+	if(config.count("shm-ring-name"))
+		m_shmRingName = config["shm-ring-name"].as<std::string>();
+	if(config.count("binary-ingest-endpoint"))
+		m_binaryEndpoint = config["binary-ingest-endpoint"].as<std::string>();
+	if(config.count("import-all-deals"))
+	{
+		m_importFile = config["import-all-deals"].as<std::string>();
+		m_importThreads = config["import-threads"].as<int>();
+	}
 
 	std::list<std::string> accounts;
 	accounts.push_back(config["quik.account"].as<std::string>());
 	m_brokerServer->registerBroker(std::make_shared<QuikBroker>(config["quik.dll-path"].as<std::string>(),
-			config["quik.exe-path"].as<std::string>(), accounts));
+			config["quik.exe-path"].as<std::string>(), accounts, m_positionLedger));
 
 	try
 	{
@@ -53,6 +91,9 @@ Core::~Core()
 
 void Core::run()
 {
+	m_run = true;
+	m_sinks->start();
+
 	TableConstructor constructor(m_registry, m_ddeServer, shared_from_this());
 
 	std::fstream tablesConfig(m_tablesConfig, std::ios_base::in);
@@ -60,20 +101,82 @@ void Core::run()
 		BOOST_THROW_EXCEPTION(ParameterError() << errinfo_str("Unable to open file: " + m_tablesConfig));
 	constructor.readConfig(tablesConfig);
 
+	if(!m_shmRingName.empty())
+	{
+		m_shmServer = std::make_shared<SharedMemoryIngestServer>(m_shmRingName, shared_from_this());
+		m_shmServer->start();
+	}
+
+	if(!m_binaryEndpoint.empty())
+	{
+		m_binaryServer = std::make_shared<BinaryUpdateServer>(m_io, m_binaryEndpoint, shared_from_this());
+		m_binaryServer->start();
+	}
+
 	m_quotesourceServer->start();
 	m_brokerServer->start();
+
+	if(!m_importFile.empty())
+		m_importThread = boost::thread(std::bind(&Core::importAllDeals, this));
 	MainWindow wnd;
+	wnd.setDumpStatsCallback(std::bind(&Core::dumpLatencyStats, this));
 	wnd.show();
 	LOG(info) << "Running main loop";
 	auto rc = Fl::run();
+
+	if(m_shmServer)
+		m_shmServer->stop();
+	if(m_binaryServer)
+		m_binaryServer->stop();
+	if(m_importThread.joinable())
+		m_importThread.join();
+
+	m_run = false;
+	m_sinks->stop();
+
+	dumpLatencyStats();
 }
 
 void Core::incomingTick(const std::string& ticker, const goldmine::Tick& tick)
 {
+	incomingTick(InstrumentRegistry::instance().id(ticker), tick);
+}
+
+void Core::incomingTick(InstrumentId instrument, const goldmine::Tick& tick)
+{
+	LatencyRecorder::mark(LatencyStage::Sink);
+	TickUpdate update { instrument, tick };
+	m_ring->publish(&update, 1);
+}
+
+void Core::incomingTicks(const TickUpdate* updates, size_t count)
+{
+	if(count == 0)
+		return;
+
+	LatencyRecorder::mark(LatencyStage::Sink);
+	m_ring->publish(updates, count);
+}
+
+void Core::importAllDeals()
+{
+	try
+	{
+		AllDealsImporter importer(shared_from_this(), m_importThreads);
+		importer.importFile(m_importFile);
+	}
+	catch(const std::exception& e)
 	{
-		boost::unique_lock<boost::mutex> lock(m_mutex);
-		m_quotesourceServer->incomingTick(ticker, tick);
+		LOG(warning) << "Unable to import all deals file: " << e.what();
 	}
-	m_quoteTable->updateQuote(ticker, tick);
+}
+
+void Core::dumpLatencyStats()
+{
+	std::ostringstream out;
+	LatencyRecorder::instance().dump(out);
+	out << std::endl;
+	m_sinks->dumpStats(out);
+	LOG(info) << out.str();
 }
 
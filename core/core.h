@@ -6,12 +6,17 @@
 #include "tables/datasink.h"
 
 #include "dataimportserver.h"
+#include "ingest/sharedmemoryingestserver.h"
+#include "ingest/binaryupdateserver.h"
 
 #include "cppio/iolinemanager.h"
 
 #include "quotesource/quotesource.h"
 #include "broker/brokerserver.h"
 #include "quotetable.h"
+#include "positionledger.h"
+#include "tickring.h"
+#include "sinks/sinkregistry.h"
 
 #include <boost/program_options.hpp>
 #include <boost/program_options/variables_map.hpp>
@@ -28,6 +33,14 @@ public:
 	void run();
 
 	virtual void incomingTick(const std::string& ticker, const goldmine::Tick& tick) override;
+	virtual void incomingTick(InstrumentId instrument, const goldmine::Tick& tick) override;
+	virtual void incomingTicks(const TickUpdate* updates, size_t count) override;
+
+	void dumpLatencyStats();
+
+private:
+	void importAllDeals();
+
 private:
 	DataImportServer::Ptr m_ddeServer;
 	TableParserFactoryRegistry::Ptr m_registry;
@@ -37,7 +50,16 @@ private:
 	std::atomic<bool> m_run;
 	std::string m_tablesConfig;
 	QuoteTable::Ptr m_quoteTable;
-	boost::mutex m_mutex;
+	PositionLedger::Ptr m_positionLedger;
+	TickRing::Ptr m_ring;
+	SinkRegistry::Ptr m_sinks;
+	SharedMemoryIngestServer::Ptr m_shmServer;
+	std::string m_shmRingName;
+	BinaryUpdateServer::Ptr m_binaryServer;
+	std::string m_binaryEndpoint;
+	std::string m_importFile;
+	int m_importThreads;
+	boost::thread m_importThread;
 };
 
 #endif /* ifndef CORE_H */
@@ -5,11 +5,14 @@
 #include "dataimportserver.h"
 #include "log.h"
 #include "xl/xlparser.h"
+#include "xl/texttableparser.h"
+#include "stats/latencyrecorder.h"
 
 #include "exceptions.h"
 #include "log.h"
 
 #include <boost/scope_exit.hpp>
+#include <cstdio>
 #include <iomanip>
 
 using namespace boost;
@@ -18,6 +21,19 @@ static DataImportServer* gs_server;
 
 static logger_t gs_logger(boost::log::keywords::channel = "dde");
 
+/**
+ * Parses top-left corner of DDE item "R<row>C<column>:R<row>C<column>" into
+ * zero-based row and column.
+ */
+static bool parseItemOrigin(const char* item, int& row, int& column)
+{
+	if(std::sscanf(item, "R%dC%d", &row, &column) != 2 || row < 1 || column < 1)
+		return false;
+	row--;
+	column--;
+	return true;
+}
+
 HDDEDATA theDdeCallback(UINT type, UINT fmt, HCONV hConv, HSZ hsz1, HSZ hsz2, HDDEDATA hData, ULONG_PTR dwData1, ULONG_PTR dwData2)
 {
 	return gs_server->ddeCallback(type, fmt, hConv, hsz1, hsz2, hData, dwData1, dwData2);
@@ -25,6 +41,7 @@ HDDEDATA theDdeCallback(UINT type, UINT fmt, HCONV hConv, HSZ hsz1, HSZ hsz2, HD
 
 DataImportServer::DataImportServer(const std::string& serverName, const std::string& topicName) : m_appName(0),
 	m_topicName(0),
+	m_xltableFormat(RegisterClipboardFormat("XlTable")),
 	m_instanceId(0)
 {
 	assert(!gs_server);
@@ -53,15 +70,18 @@ void DataImportServer::registerTableParser(const TableParser::Ptr& parser)
 {
 	if(std::find(m_tableParsers.begin(), m_tableParsers.end(), parser) == m_tableParsers.end())
 		m_tableParsers.push_back(parser);
+	m_routes.clear();
 }
 
 void DataImportServer::stop()
 {
 	m_tableParsers.clear();
+	m_routes.clear();
 }
 
 HDDEDATA DataImportServer::ddeCallback(UINT type, UINT fmt, HCONV hConv, HSZ hsz1, HSZ hsz2, HDDEDATA hData, ULONG_PTR dwData1, ULONG_PTR dwData2)
 {
+	auto arrivalTime = LatencyClock::now();
 	switch(type)
 	{
 	case XTYP_CONNECT:
@@ -80,10 +100,12 @@ HDDEDATA DataImportServer::ddeCallback(UINT type, UINT fmt, HCONV hConv, HSZ hsz
 	case XTYP_POKE:
 		{
 			char topicBuf[256];
+			char itemBuf[256];
 			DdeQueryString(m_instanceId, hsz1, topicBuf, 256, CP_WINANSI);
+			DdeQueryString(m_instanceId, hsz2, itemBuf, 256, CP_WINANSI);
 			std::string topic(topicBuf);
 
-			parseIncomingData(topic, hData);
+			parseIncomingData(topic, itemBuf, hData, fmt, arrivalTime);
 
 			return (HDDEDATA)DDE_FACK;
 		}
@@ -93,8 +115,11 @@ HDDEDATA DataImportServer::ddeCallback(UINT type, UINT fmt, HCONV hConv, HSZ hsz
 	}
 }
 
-bool DataImportServer::parseIncomingData(const std::string& topic, HDDEDATA hData)
+bool DataImportServer::parseIncomingData(const std::string& topic, const char* item, HDDEDATA hData, UINT fmt, uint64_t arrivalTime)
 {
+	auto& topicRoute = route(topic);
+	LatencyPoke poke(topicRoute.latency, arrivalTime);
+
 	DWORD dataSize = 0;
 	BYTE* data = DdeAccessData(hData, &dataSize);
 	if(!data)
@@ -107,21 +132,64 @@ bool DataImportServer::parseIncomingData(const std::string& topic, HDDEDATA hDat
 
 	try
 	{
-		XlParser parser;
-		parser.parse(data, dataSize);
-
-		auto table = parser.getParsedTable();
-
-		for(const auto& tp : m_tableParsers)
+		auto table = decodeTable(data, dataSize, fmt);
+		int originRow, originColumn;
+		if(parseItemOrigin(item, originRow, originColumn))
+			table->setOrigin(originRow, originColumn);
+		table->setArrivalTime(m_clock.microseconds(arrivalTime));
+		LatencyRecorder::mark(LatencyStage::Decode);
+
+		for(const auto& parser : topicRoute.parsers)
 		{
-			if(tp->acceptsTopic(topic))
-				tp->incomingTable(table);
+			parser.first->incomingTable(table);
+			LatencyRecorder::mark(LatencyStage::Parse, parser.second);
 		}
 	}
 	catch(const std::exception& e)
 	{
-		LOG_WITH(gs_logger, warning) << "Unable to parse incoming XlTable: " << e.what();
+		LOG_WITH(gs_logger, warning) << "Unable to parse incoming table: " << e.what();
 	}
 
 	return true;
 }
+
+DataImportServer::TopicRoute& DataImportServer::route(const std::string& topic)
+{
+	auto& topicRoute = m_routes[topic];
+	if(topicRoute.latency)
+		return topicRoute;
+
+	auto& recorder = LatencyRecorder::instance();
+	topicRoute.latency = recorder.topic(topic);
+	std::vector<TableParser::Ptr> parsers;
+	for(const auto& tp : m_tableParsers)
+	{
+		if(tp->acceptsTopic(topic))
+			parsers.push_back(tp);
+	}
+
+	// Parse stage of every parser is recorded separately if there are several
+	for(size_t i = 0; i < parsers.size(); i++)
+	{
+		auto latency = parsers.size() == 1 ? topicRoute.latency : recorder.topic(topic + "/" + std::to_string(i + 1));
+		topicRoute.parsers.push_back(std::make_pair(parsers[i], latency));
+	}
+	return topicRoute;
+}
+
+XlTable::Ptr DataImportServer::decodeTable(const uint8_t* data, int dataSize, UINT fmt)
+{
+	// XlTable data always starts with tdtTable block: 0x0010, size 0x0004
+	bool looksLikeXlTable = (dataSize >= 4) && (data[0] == 0x10) && (data[1] == 0) && (data[2] == 4) && (data[3] == 0);
+	if(fmt == m_xltableFormat || (fmt != CF_TEXT && looksLikeXlTable))
+	{
+		XlParser parser;
+		parser.parse(const_cast<uint8_t*>(data), dataSize);
+		return parser.getParsedTable();
+	}
+	else
+	{
+		m_textParser.parse(data, dataSize);
+		return m_textParser.getParsedTable();
+	}
+}
@@ -13,6 +13,10 @@
 #include <stdexcept>
 #include "tables/tableparser.h"
 #include "tables/datasink.h"
+#include "tables/flatstringmap.h"
+#include "stats/latencyrecorder.h"
+#include "gatewayclock.h"
+#include "xl/texttableparser.h"
 
 class DataImportServer
 {
@@ -31,13 +35,30 @@ public:
 	HDDEDATA ddeCallback(UINT type, UINT fmt, HCONV hConv, HSZ hsz1, HSZ hsz2, HDDEDATA hData, ULONG_PTR dwData1, ULONG_PTR dwData2);
 
 private:
-	bool parseIncomingData(const std::string& topic, HDDEDATA hData);
+	// Parsers accepting a topic and latency histograms to record its pokes to;
+	// resolved on the first poke of the topic
+	struct TopicRoute
+	{
+		TopicRoute() : latency(nullptr) {}
+
+		LatencyRecorder::TopicLatency* latency;
+		std::vector<std::pair<TableParser::Ptr, LatencyRecorder::TopicLatency*>> parsers;
+	};
+
+	bool parseIncomingData(const std::string& topic, const char* item, HDDEDATA hData, UINT fmt, uint64_t arrivalTime);
+	XlTable::Ptr decodeTable(const uint8_t* data, int dataSize, UINT fmt);
+	TopicRoute& route(const std::string& topic);
 
 private:
 	HSZ m_appName;
 	HSZ m_topicName;
+	UINT m_xltableFormat;
 	long unsigned int m_instanceId;
 	std::vector<TableParser::Ptr> m_tableParsers;
+	FlatStringMap<TopicRoute> m_routes;
+	GatewayClock m_clock;
+	// Kept between pokes to reuse its buffers
+	TextTableParser m_textParser;
 };
 
 #endif /* CORE_DATAIMPORTSERVER_H_ */
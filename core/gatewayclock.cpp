@@ -0,0 +1,58 @@
+/*
+ * gatewayclock.cpp
+ */
+
+#include "gatewayclock.h"
+
+#include "log.h"
+
+constexpr uint64_t GatewayClock::MaxStepBackMicroseconds;
+
+GatewayClock::GatewayClock(uint64_t resyncIntervalMs) : m_resyncIntervalNs(resyncIntervalMs * 1000000),
+	m_anchorTicks(0),
+	m_anchorMicroseconds(0),
+	m_last(0)
+{
+	LatencyClock::calibrate();
+	resync();
+}
+
+uint64_t GatewayClock::microseconds(uint64_t ticks)
+{
+	if(ticks > m_anchorTicks && LatencyClock::toNanoseconds(ticks - m_anchorTicks) >= m_resyncIntervalNs)
+		resync();
+
+	uint64_t result;
+	if(ticks >= m_anchorTicks)
+		result = m_anchorMicroseconds + LatencyClock::toNanoseconds(ticks - m_anchorTicks) / 1000;
+	else
+		result = m_anchorMicroseconds - LatencyClock::toNanoseconds(m_anchorTicks - ticks) / 1000;
+
+	// Extrapolated time of the previous anchor may be slightly ahead of the
+	// new one
+	if(result < m_last)
+	{
+		if(m_last - result <= MaxStepBackMicroseconds)
+			result = m_last;
+		else
+			LOG(warning) << "Wall clock stepped back by " << (m_last - result) << " us";
+	}
+	m_last = result;
+	return result;
+}
+
+uint64_t GatewayClock::systemMicroseconds()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void GatewayClock::anchor(uint64_t ticks, uint64_t wallMicroseconds)
+{
+	m_anchorTicks = ticks;
+	m_anchorMicroseconds = wallMicroseconds;
+}
+
+void GatewayClock::resync()
+{
+	anchor(LatencyClock::now(), systemMicroseconds());
+}
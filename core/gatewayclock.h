@@ -0,0 +1,59 @@
+/*
+ * gatewayclock.h
+ */
+
+#ifndef CORE_GATEWAYCLOCK_H_
+#define CORE_GATEWAYCLOCK_H_
+
+#include "core/stats/latencyclock.h"
+
+#include <cstdint>
+
+/**
+ * Maps LatencyClock ticks (TSC or steady clock) to wall time in microseconds
+ * since epoch. Wall clock is read only when anchoring, which happens once per
+ * resync interval; everything in between is extrapolated from ticks, so
+ * stamping a poke costs a TSC read.
+ *
+ * Jitter between anchors (up to MaxStepBackMicroseconds) is hidden, so
+ * returned time does not go backwards. A bigger step back of the wall clock
+ * (NTP step, manual change) is followed as is and logged, instead of freezing
+ * timestamps until the wall clock catches up. Not thread-safe: each thread
+ * that stamps data owns its instance.
+ */
+class GatewayClock
+{
+public:
+	static constexpr uint64_t MaxStepBackMicroseconds = 1000;
+
+	GatewayClock(uint64_t resyncIntervalMs = 1000);
+
+	uint64_t now()
+	{
+		return microseconds(LatencyClock::now());
+	}
+
+	/**
+	 * Wall time of the moment when LatencyClock::now() returned given ticks
+	 */
+	uint64_t microseconds(uint64_t ticks);
+
+	static uint64_t systemMicroseconds();
+
+	/**
+	 * Makes given ticks correspond to given wall time. Done by resync; public
+	 * for tests.
+	 */
+	void anchor(uint64_t ticks, uint64_t wallMicroseconds);
+
+private:
+	void resync();
+
+private:
+	uint64_t m_resyncIntervalNs;
+	uint64_t m_anchorTicks;
+	uint64_t m_anchorMicroseconds;
+	uint64_t m_last;
+};
+
+#endif /* CORE_GATEWAYCLOCK_H_ */
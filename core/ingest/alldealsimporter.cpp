@@ -0,0 +1,261 @@
+/*
+ * alldealsimporter.cpp
+ */
+
+#include "alldealsimporter.h"
+
+#include "binary/textscanner.h"
+#include "exceptions.h"
+#include "log.h"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/thread.hpp>
+
+#include <algorithm>
+
+using namespace boost::interprocess;
+
+static logger_t gs_logger(boost::log::keywords::channel = "import");
+
+static bool parseDigits(const char* p, int count, int& result)
+{
+	result = 0;
+	for(int i = 0; i < count; i++)
+	{
+		if(p[i] < '0' || p[i] > '9')
+			return false;
+		result = result * 10 + (p[i] - '0');
+	}
+	return true;
+}
+
+static bool isSell(const char* begin, const char* end)
+{
+	if(begin == end)
+		return false;
+	unsigned char c = *begin;
+	// "Sell", "S", cp1251 "Продажа" or its UTF-8 form
+	return (c == 'S') || (c == 's') || (c == 0xcf) || ((c == 0xd0) && (end - begin > 1) && ((unsigned char)begin[1] == 0x9f));
+}
+
+AllDealsImporter::AllDealsImporter(const DataSink::Ptr& datasink, int threads, size_t chunkSize) : m_datasink(datasink),
+	m_threads(std::max(threads, 1)),
+	m_chunkSize(chunkSize),
+	m_delimiter(';')
+{
+}
+
+AllDealsImporter::~AllDealsImporter()
+{
+}
+
+size_t AllDealsImporter::importFile(const std::string& path)
+{
+	LOG_WITH(gs_logger, info) << "Importing all deals from: " << path;
+	file_mapping file(path.c_str(), read_only);
+	mapped_region region(file, read_only);
+	region.advise(mapped_region::advice_sequential);
+
+	auto begin = static_cast<const char*>(region.get_address());
+	return importBuffer(begin, begin + region.get_size());
+}
+
+size_t AllDealsImporter::importBuffer(const char* begin, const char* end)
+{
+	if(end - begin >= 3 && !std::memcmp(begin, "\xef\xbb\xbf", 3))
+		begin += 3;
+
+	const char* p = parseHeader(begin, end);
+
+	size_t rows = 0;
+	size_t badRows = 0;
+	std::vector<Chunk> chunks(m_threads);
+	while(p < end)
+	{
+		size_t chunksInRound = 0;
+		for(auto& chunk : chunks)
+		{
+			if(p >= end)
+				break;
+			chunk.begin = p;
+			chunk.end = (size_t)(end - p) > m_chunkSize ? findNewline(p + m_chunkSize, end) : end;
+			if(chunk.end < end)
+				chunk.end++;
+			p = chunk.end;
+			chunksInRound++;
+		}
+
+		if(chunksInRound == 1)
+		{
+			parseChunk(chunks[0]);
+		}
+		else
+		{
+			boost::thread_group workers;
+			for(size_t i = 0; i < chunksInRound; i++)
+				workers.create_thread(std::bind(&AllDealsImporter::parseChunk, this, std::ref(chunks[i])));
+			workers.join_all();
+		}
+
+		for(size_t i = 0; i < chunksInRound; i++)
+		{
+			emitChunk(chunks[i]);
+			rows += chunks[i].ticks.size();
+			badRows += chunks[i].badRows;
+		}
+	}
+
+	LOG_WITH(gs_logger, info) << "Imported " << rows << " trades; skipped rows: " << badRows;
+	return rows;
+}
+
+const char* AllDealsImporter::parseHeader(const char* begin, const char* end)
+{
+	const char* headerEnd = findNewline(begin, end);
+
+	auto semicolons = std::count(begin, headerEnd, ';');
+	auto commas = std::count(begin, headerEnd, ',');
+	auto tabs = std::count(begin, headerEnd, '\t');
+	if(tabs >= semicolons && tabs >= commas)
+		m_delimiter = '\t';
+	else if(commas > semicolons)
+		m_delimiter = ',';
+	else
+		m_delimiter = ';';
+
+	m_fieldMap.clear();
+	scanFields(begin, headerEnd, m_delimiter, [&](const char* fieldBegin, const char* fieldEnd, bool)
+		{
+			std::string header(fieldBegin, fieldEnd);
+			header.erase(std::remove(header.begin(), header.end(), '"'), header.end());
+			m_fieldMap.push_back(AllDealsTableParser::columnId(header));
+		});
+
+	for(int required : { AllDealsTableParser::ClassCode, AllDealsTableParser::Code, AllDealsTableParser::Date,
+			AllDealsTableParser::TradeTime, AllDealsTableParser::Price, AllDealsTableParser::Quantity })
+	{
+		if(std::find(m_fieldMap.begin(), m_fieldMap.end(), required) == m_fieldMap.end())
+			BOOST_THROW_EXCEPTION(FormatError() << errinfo_str("All deals file lacks required column #" + std::to_string(required)));
+	}
+
+	return headerEnd < end ? headerEnd + 1 : end;
+}
+
+void AllDealsImporter::parseChunk(Chunk& chunk) const
+{
+	chunk.instruments.clear();
+	chunk.ticks.clear();
+	chunk.ticks.reserve((chunk.end - chunk.begin) / 48);
+	chunk.badRows = 0;
+
+	std::unordered_map<std::string, uint32_t> instrumentIds;
+	std::string key;
+	std::string lastDate;
+	time_t dayStart = 0;
+
+	RowFields row;
+	std::fill(row.begin, row.begin + AllDealsTableParser::MaxId, nullptr);
+	size_t column = 0;
+	scanFields(chunk.begin, chunk.end, m_delimiter, [&](const char* fieldBegin, const char* fieldEnd, bool endOfLine)
+		{
+			if(column < m_fieldMap.size() && m_fieldMap[column] >= 0)
+			{
+				if(fieldEnd - fieldBegin >= 2 && *fieldBegin == '"' && fieldEnd[-1] == '"')
+				{
+					fieldBegin++;
+					fieldEnd--;
+				}
+				row.begin[m_fieldMap[column]] = fieldBegin;
+				row.end[m_fieldMap[column]] = fieldEnd;
+			}
+			column++;
+
+			if(endOfLine)
+			{
+				bool emptyLine = (column == 1) && (fieldBegin == fieldEnd);
+				if(!emptyLine && !parseRow(row, chunk, instrumentIds, key, lastDate, dayStart))
+					chunk.badRows++;
+				std::fill(row.begin, row.begin + AllDealsTableParser::MaxId, nullptr);
+				column = 0;
+			}
+		});
+}
+
+bool AllDealsImporter::parseRow(const RowFields& row, Chunk& chunk, std::unordered_map<std::string, uint32_t>& instrumentIds,
+		std::string& key, std::string& lastDate, time_t& dayStart) const
+{
+	for(int required : { AllDealsTableParser::ClassCode, AllDealsTableParser::Code, AllDealsTableParser::Date,
+			AllDealsTableParser::TradeTime, AllDealsTableParser::Price, AllDealsTableParser::Quantity })
+	{
+		if(!row.begin[required])
+			return false;
+	}
+
+	TickUpdate imported;
+	key.assign(row.begin[AllDealsTableParser::ClassCode], row.end[AllDealsTableParser::ClassCode]);
+	key.push_back('#');
+	key.append(row.begin[AllDealsTableParser::Code], row.end[AllDealsTableParser::Code]);
+	auto it = instrumentIds.find(key);
+	if(it == instrumentIds.end())
+	{
+		it = instrumentIds.insert(std::make_pair(key, (uint32_t)chunk.instruments.size())).first;
+		chunk.instruments.push_back(key);
+	}
+	imported.instrument = it->second;
+
+	const char* date = row.begin[AllDealsTableParser::Date];
+	size_t dateLength = row.end[AllDealsTableParser::Date] - date;
+	if(dateLength != lastDate.size() || std::memcmp(date, lastDate.data(), dateLength))
+	{
+		struct tm t = {};
+		if(dateLength != 10 || !parseDigits(date, 2, t.tm_mday) || !parseDigits(date + 3, 2, t.tm_mon) ||
+				!parseDigits(date + 6, 4, t.tm_year))
+			return false;
+		t.tm_year -= 1900;
+		t.tm_mon -= 1;
+		t.tm_isdst = -1;
+		dayStart = mktime(&t);
+		lastDate.assign(date, dateLength);
+	}
+
+	const char* time = row.begin[AllDealsTableParser::TradeTime];
+	int hour, minute, second;
+	if(row.end[AllDealsTableParser::TradeTime] - time < 8 || !parseDigits(time, 2, hour) ||
+			!parseDigits(time + 3, 2, minute) || !parseDigits(time + 6, 2, second))
+		return false;
+
+	auto& tick = imported.tick;
+	tick.timestamp = dayStart + hour * 3600 + minute * 60 + second;
+	tick.useconds = 0;
+	double value;
+	if(row.begin[AllDealsTableParser::TradeTimeMsec] &&
+			parseNumber(row.begin[AllDealsTableParser::TradeTimeMsec], row.end[AllDealsTableParser::TradeTimeMsec], value))
+		tick.useconds = value;
+
+	tick.datatype = (int)goldmine::Datatype::Price;
+	if(!parseNumber(row.begin[AllDealsTableParser::Price], row.end[AllDealsTableParser::Price], value))
+		return false;
+	tick.value = value;
+
+	if(!parseNumber(row.begin[AllDealsTableParser::Quantity], row.end[AllDealsTableParser::Quantity], value))
+		return false;
+	tick.volume = value;
+	if(row.begin[AllDealsTableParser::BuySell] && isSell(row.begin[AllDealsTableParser::BuySell], row.end[AllDealsTableParser::BuySell]))
+		tick.volume = -tick.volume;
+
+	chunk.ticks.push_back(imported);
+	return true;
+}
+
+void AllDealsImporter::emitChunk(Chunk& chunk)
+{
+	std::vector<InstrumentId> instruments;
+	instruments.reserve(chunk.instruments.size());
+	for(const auto& name : chunk.instruments)
+		instruments.push_back(InstrumentRegistry::instance().id(name));
+
+	for(auto& imported : chunk.ticks)
+		imported.instrument = instruments[imported.instrument];
+	m_datasink->incomingTicks(chunk.ticks.data(), chunk.ticks.size());
+}
@@ -0,0 +1,63 @@
+/*
+ * alldealsimporter.h
+ */
+
+#ifndef CORE_INGEST_ALLDEALSIMPORTER_H_
+#define CORE_INGEST_ALLDEALSIMPORTER_H_
+
+#include "core/tables/datasink.h"
+#include "core/tables/parsers/alldealstableparser.h"
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Imports QUIK all-deals export files (CSV/TXT with a header line) and
+ * republishes the trades through the DataSink. The file is memory-mapped and
+ * processed in chunks split at line boundaries; each round parses one chunk
+ * per worker thread and then emits the ticks in file order.
+ */
+class AllDealsImporter
+{
+public:
+	AllDealsImporter(const DataSink::Ptr& datasink, int threads = 1, size_t chunkSize = 8 << 20);
+	virtual ~AllDealsImporter();
+
+	size_t importFile(const std::string& path);
+	size_t importBuffer(const char* begin, const char* end);
+
+private:
+	struct Chunk
+	{
+		const char* begin;
+		const char* end;
+		std::vector<std::string> instruments;
+		// Instrument fields hold indices into 'instruments' until emitChunk() resolves them
+		std::vector<TickUpdate> ticks;
+		size_t badRows;
+	};
+
+	struct RowFields
+	{
+		const char* begin[AllDealsTableParser::MaxId];
+		const char* end[AllDealsTableParser::MaxId];
+	};
+
+	const char* parseHeader(const char* begin, const char* end);
+	void parseChunk(Chunk& chunk) const;
+	bool parseRow(const RowFields& row, Chunk& chunk, std::unordered_map<std::string, uint32_t>& instrumentIds,
+			std::string& key, std::string& lastDate, time_t& dayStart) const;
+	void emitChunk(Chunk& chunk);
+
+private:
+	DataSink::Ptr m_datasink;
+	int m_threads;
+	size_t m_chunkSize;
+	char m_delimiter;
+	std::vector<int> m_fieldMap;
+};
+
+#endif /* CORE_INGEST_ALLDEALSIMPORTER_H_ */
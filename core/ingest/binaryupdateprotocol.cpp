@@ -0,0 +1,170 @@
+/*
+ * binaryupdateprotocol.cpp
+ */
+
+#include "binaryupdateprotocol.h"
+
+#include "exceptions.h"
+
+#include <cstring>
+
+template <typename T>
+static inline T readValue(const uint8_t* p)
+{
+	T result;
+	std::memcpy(&result, p, sizeof(T));
+	return result;
+}
+
+template <typename T>
+static inline void appendValue(std::vector<uint8_t>& buffer, T value)
+{
+	auto offset = buffer.size();
+	buffer.resize(offset + sizeof(T));
+	std::memcpy(buffer.data() + offset, &value, sizeof(T));
+}
+
+BinaryUpdateDecoder::BinaryUpdateDecoder(const DataSink::Ptr& datasink) : m_datasink(datasink)
+{
+	m_batch.reserve((BinaryMaxFrameSize - BinaryFrameHeaderSize) / BinaryUpdateSize);
+}
+
+BinaryUpdateDecoder::~BinaryUpdateDecoder()
+{
+}
+
+void BinaryUpdateDecoder::decodeFrame(const uint8_t* data, size_t size, uint64_t arrivalTime)
+{
+	if(size < BinaryFrameHeaderSize)
+		BOOST_THROW_EXCEPTION(ProtocolError() << errinfo_str("Frame is too short"));
+
+	auto type = readValue<uint16_t>(data);
+	int count = readValue<uint16_t>(data + 2);
+	data += BinaryFrameHeaderSize;
+	size -= BinaryFrameHeaderSize;
+
+	switch((BinaryFrameType)type)
+	{
+	case BinaryFrameType::InstrumentDefinitions:
+		decodeInstrumentDefinitions(data, size, count);
+		break;
+	case BinaryFrameType::Updates:
+		decodeUpdates(data, size, count, arrivalTime);
+		break;
+	default:
+		BOOST_THROW_EXCEPTION(ProtocolError() << errinfo_str("Invalid frame type: " + std::to_string(type)));
+	}
+}
+
+void BinaryUpdateDecoder::decodeInstrumentDefinitions(const uint8_t* data, size_t size, int count)
+{
+	const uint8_t* end = data + size;
+	for(int i = 0; i < count; i++)
+	{
+		if(end - data < 5)
+			BOOST_THROW_EXCEPTION(ProtocolError() << errinfo_str("Truncated instrument definition"));
+
+		auto id = readValue<uint32_t>(data);
+		int nameLength = data[4];
+		data += 5;
+		if(end - data < nameLength)
+			BOOST_THROW_EXCEPTION(ProtocolError() << errinfo_str("Truncated instrument definition"));
+		if(id >= BinaryMaxInstrumentId)
+			BOOST_THROW_EXCEPTION(ProtocolError() << errinfo_str("Instrument id is too large: " + std::to_string(id)));
+
+		if(id >= m_instruments.size())
+			m_instruments.resize(id + 1, NoInstrument);
+		m_instruments[id] = InstrumentRegistry::instance().id(std::string(reinterpret_cast<const char*>(data), nameLength));
+		data += nameLength;
+	}
+}
+
+void BinaryUpdateDecoder::decodeUpdates(const uint8_t* data, size_t size, int count, uint64_t arrivalTime)
+{
+	if(size < count * BinaryUpdateSize)
+		BOOST_THROW_EXCEPTION(ProtocolError() << errinfo_str("Truncated updates frame"));
+
+	goldmine::Tick tick;
+	for(int i = 0; i < count; i++, data += BinaryUpdateSize)
+	{
+		auto id = readValue<uint32_t>(data);
+		if(id >= m_instruments.size() || m_instruments[id] == NoInstrument)
+		{
+			m_batch.clear();
+			BOOST_THROW_EXCEPTION(ProtocolError() << errinfo_str("Undefined instrument id: " + std::to_string(id)));
+		}
+
+		auto timestamp = readValue<uint64_t>(data + 24);
+		if(timestamp == 0)
+			timestamp = arrivalTime;
+
+		tick.datatype = readValue<uint16_t>(data + 4);
+		tick.value = readValue<double>(data + 8);
+		tick.volume = readValue<int32_t>(data + 16);
+		tick.timestamp = timestamp / 1000000;
+		tick.useconds = timestamp % 1000000;
+
+		m_batch.push_back(TickUpdate { m_instruments[id], tick });
+	}
+
+	m_datasink->incomingTicks(m_batch.data(), m_batch.size());
+	m_batch.clear();
+}
+
+BinaryUpdateEncoder::BinaryUpdateEncoder() : m_definitionsCount(0), m_updatesCount(0)
+{
+}
+
+BinaryUpdateEncoder::~BinaryUpdateEncoder()
+{
+}
+
+void BinaryUpdateEncoder::defineInstrument(uint32_t id, const std::string& name)
+{
+	if(name.size() > 255)
+		BOOST_THROW_EXCEPTION(ParameterError() << errinfo_str("Instrument name is too long: " + name));
+
+	appendValue<uint32_t>(m_definitions, id);
+	appendValue<uint8_t>(m_definitions, name.size());
+	m_definitions.insert(m_definitions.end(), name.begin(), name.end());
+	if(++m_definitionsCount == 0xffff || m_definitions.size() > BinaryMaxFrameSize - 512)
+		flushFrame(m_definitions, BinaryFrameType::InstrumentDefinitions, m_definitionsCount);
+}
+
+void BinaryUpdateEncoder::addUpdate(uint32_t id, int datatype, double value, int volume, uint64_t timestamp)
+{
+	appendValue<uint32_t>(m_updates, id);
+	appendValue<uint16_t>(m_updates, datatype);
+	appendValue<uint16_t>(m_updates, 0);
+	appendValue<double>(m_updates, value);
+	appendValue<int32_t>(m_updates, volume);
+	appendValue<uint32_t>(m_updates, 0);
+	appendValue<uint64_t>(m_updates, timestamp);
+	if(++m_updatesCount == 0xffff || m_updates.size() > BinaryMaxFrameSize - 2 * BinaryUpdateSize)
+	{
+		flushFrame(m_definitions, BinaryFrameType::InstrumentDefinitions, m_definitionsCount);
+		flushFrame(m_updates, BinaryFrameType::Updates, m_updatesCount);
+	}
+}
+
+std::vector<uint8_t> BinaryUpdateEncoder::finish()
+{
+	flushFrame(m_definitions, BinaryFrameType::InstrumentDefinitions, m_definitionsCount);
+	flushFrame(m_updates, BinaryFrameType::Updates, m_updatesCount);
+	std::vector<uint8_t> result;
+	result.swap(m_output);
+	return result;
+}
+
+void BinaryUpdateEncoder::flushFrame(std::vector<uint8_t>& frame, BinaryFrameType type, int& count)
+{
+	if(count == 0)
+		return;
+
+	appendValue<uint32_t>(m_output, frame.size() + BinaryFrameHeaderSize);
+	appendValue<uint16_t>(m_output, (uint16_t)type);
+	appendValue<uint16_t>(m_output, count);
+	m_output.insert(m_output.end(), frame.begin(), frame.end());
+	frame.clear();
+	count = 0;
+}
@@ -0,0 +1,104 @@
+/*
+ * binaryupdateprotocol.h
+ */
+
+#ifndef CORE_INGEST_BINARYUPDATEPROTOCOL_H_
+#define CORE_INGEST_BINARYUPDATEPROTOCOL_H_
+
+#include "core/tables/datasink.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Length-prefixed binary update protocol (all fields little-endian).
+ *
+ * Frame:
+ *   uint32 length            Number of bytes following this field
+ *   uint16 type              BinaryFrameType
+ *   uint16 count             Number of entries in the frame
+ *   entries...
+ *
+ * InstrumentDefinitions entry:
+ *   uint32 id                Connection-local instrument id
+ *   uint8  nameLength
+ *   char   name[nameLength]  "CLASS#CODE"
+ *
+ * Updates entry (BinaryUpdateSize bytes):
+ *   uint32 id                Previously defined instrument id
+ *   uint16 datatype          goldmine::Datatype
+ *   uint16 reserved
+ *   double value
+ *   int32  volume
+ *   uint32 reserved
+ *   uint64 timestamp         Microseconds since epoch, UTC; 0 means "use arrival time"
+ */
+
+enum class BinaryFrameType : uint16_t
+{
+	InstrumentDefinitions = 1,
+	Updates = 2
+};
+
+static const size_t BinaryFrameHeaderSize = 4;
+static const size_t BinaryUpdateSize = 32;
+static const size_t BinaryMaxFrameSize = 1 << 20;
+static const uint32_t BinaryMaxInstrumentId = 1 << 20;
+
+/**
+ * Decodes frame bodies (everything after the length prefix) and feeds
+ * updates to the DataSink. Instrument names are kept per decoder, so one
+ * decoder should be used per connection. The batch buffer is reserved for
+ * the largest possible frame, so decoding an Updates frame does not allocate.
+ */
+class BinaryUpdateDecoder
+{
+public:
+	BinaryUpdateDecoder(const DataSink::Ptr& datasink);
+	virtual ~BinaryUpdateDecoder();
+
+	/**
+	 * arrivalTime (microseconds since epoch) is given to updates without timestamp
+	 */
+	void decodeFrame(const uint8_t* data, size_t size, uint64_t arrivalTime);
+
+private:
+	void decodeInstrumentDefinitions(const uint8_t* data, size_t size, int count);
+	void decodeUpdates(const uint8_t* data, size_t size, int count, uint64_t arrivalTime);
+
+private:
+	DataSink::Ptr m_datasink;
+	std::vector<InstrumentId> m_instruments;
+	std::vector<TickUpdate> m_batch;
+};
+
+/**
+ * Builds frames of the binary update protocol. Used by clients and load generators.
+ */
+class BinaryUpdateEncoder
+{
+public:
+	BinaryUpdateEncoder();
+	virtual ~BinaryUpdateEncoder();
+
+	void defineInstrument(uint32_t id, const std::string& name);
+	void addUpdate(uint32_t id, int datatype, double value, int volume, uint64_t timestamp);
+
+	/**
+	 * Returns the encoded frames (definitions first, then updates) and resets the encoder.
+	 */
+	std::vector<uint8_t> finish();
+
+private:
+	void flushFrame(std::vector<uint8_t>& frame, BinaryFrameType type, int& count);
+
+private:
+	std::vector<uint8_t> m_output;
+	std::vector<uint8_t> m_definitions;
+	std::vector<uint8_t> m_updates;
+	int m_definitionsCount;
+	int m_updatesCount;
+};
+
+#endif /* CORE_INGEST_BINARYUPDATEPROTOCOL_H_ */
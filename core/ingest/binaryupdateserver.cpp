@@ -0,0 +1,149 @@
+/*
+ * binaryupdateserver.cpp
+ */
+
+#include "binaryupdateserver.h"
+
+#include "core/gatewayclock.h"
+#include "core/stats/latencyrecorder.h"
+#include "exceptions.h"
+#include "log.h"
+
+#include <cstring>
+
+static logger_t gs_logger(boost::log::keywords::channel = "binary_ingest");
+
+// How often blocked connection reads wake up to check for stop()
+static const int gs_receiveTimeoutMs = 100;
+
+BinaryUpdateServer::BinaryUpdateServer(const std::shared_ptr<cppio::IoLineManager>& io, const std::string& endpoint,
+		const DataSink::Ptr& datasink) : m_io(io),
+	m_endpoint(endpoint),
+	m_datasink(datasink),
+	m_run(false)
+{
+}
+
+BinaryUpdateServer::~BinaryUpdateServer()
+{
+	stop();
+}
+
+void BinaryUpdateServer::start()
+{
+	m_acceptor = std::unique_ptr<cppio::IoAcceptor>(m_io->createServer(m_endpoint));
+	if(!m_acceptor)
+		BOOST_THROW_EXCEPTION(ExternalApiError() << errinfo_str("Unable to create binary ingest server at " + m_endpoint));
+
+	LOG_WITH(gs_logger, info) << "Binary ingest server is listening at " << m_endpoint;
+	m_run = true;
+	m_acceptThread = boost::thread(std::bind(&BinaryUpdateServer::acceptLoop, this));
+}
+
+void BinaryUpdateServer::stop()
+{
+	m_run = false;
+	if(m_acceptThread.joinable())
+		m_acceptThread.join();
+
+	// Connection threads own their lines, so lines are closed as they exit
+	for(auto& connection : m_connections)
+		connection->thread.join();
+	m_connections.clear();
+}
+
+void BinaryUpdateServer::acceptLoop()
+{
+	while(m_run)
+	{
+		reapConnections();
+		std::shared_ptr<cppio::IoLine> line(m_acceptor->waitConnection(100));
+		if(!line)
+			continue;
+
+		int timeout = gs_receiveTimeoutMs;
+		line->setOption(cppio::LineOption::ReceiveTimeout, &timeout);
+
+		LOG_WITH(gs_logger, info) << "Binary ingest client connected";
+		std::unique_ptr<Connection> connection(new Connection);
+		connection->finished = false;
+		connection->thread = boost::thread(std::bind(&BinaryUpdateServer::connectionLoop, this, line, std::ref(*connection)));
+		m_connections.push_back(std::move(connection));
+	}
+}
+
+void BinaryUpdateServer::reapConnections()
+{
+	for(auto it = m_connections.begin(); it != m_connections.end();)
+	{
+		if((*it)->finished)
+		{
+			(*it)->thread.join();
+			it = m_connections.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+bool BinaryUpdateServer::readExactly(cppio::IoLine& line, uint8_t* buffer, size_t size)
+{
+	while(size > 0)
+	{
+		auto started = boost::chrono::steady_clock::now();
+		auto rc = line.read(buffer, size);
+		if(rc == 0)
+			return false;
+
+		if(rc < 0)
+		{
+			// A read that failed before the receive timeout is an error, not a timeout
+			auto elapsed = boost::chrono::steady_clock::now() - started;
+			if(!m_run || elapsed < boost::chrono::milliseconds(gs_receiveTimeoutMs / 2))
+				return false;
+			continue;
+		}
+		buffer += rc;
+		size -= rc;
+	}
+	return true;
+}
+
+void BinaryUpdateServer::connectionLoop(const std::shared_ptr<cppio::IoLine>& line, Connection& connection)
+{
+	BinaryUpdateDecoder decoder(m_datasink);
+	std::vector<uint8_t> buffer(BinaryMaxFrameSize);
+	auto latency = LatencyRecorder::instance().topic("binary:" + m_endpoint);
+	GatewayClock clock;
+
+	try
+	{
+		while(m_run)
+		{
+			uint8_t lengthBuf[4];
+			if(!readExactly(*line, lengthBuf, sizeof(lengthBuf)))
+				break;
+
+			uint32_t length;
+			std::memcpy(&length, lengthBuf, sizeof(length));
+			if(length > BinaryMaxFrameSize)
+				BOOST_THROW_EXCEPTION(ProtocolError() << errinfo_str("Frame is too large: " + std::to_string(length)));
+
+			if(!readExactly(*line, buffer.data(), length))
+				break;
+
+			auto start = LatencyClock::now();
+			LatencyPoke poke(latency, start);
+			decoder.decodeFrame(buffer.data(), length, clock.microseconds(start));
+		}
+	}
+	catch(const std::exception& e)
+	{
+		LOG_WITH(gs_logger, warning) << "Binary ingest connection error: " << e.what();
+	}
+
+	LOG_WITH(gs_logger, info) << "Binary ingest client disconnected";
+	connection.finished = true;
+}
@@ -0,0 +1,65 @@
+/*
+ * binaryupdateserver.h
+ */
+
+#ifndef CORE_INGEST_BINARYUPDATESERVER_H_
+#define CORE_INGEST_BINARYUPDATESERVER_H_
+
+#include "binaryupdateprotocol.h"
+#include "core/tables/datasink.h"
+
+#include "cppio/iolinemanager.h"
+
+#include <boost/thread.hpp>
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <string>
+
+/**
+ * Serves the binary update protocol (see binaryupdateprotocol.h) on a cppio
+ * endpoint, so both TCP and local sockets are supported.
+ *
+ * Every connection is served by its own thread, which the accept thread
+ * joins once the connection is closed. cppio lines can't be closed from
+ * another thread, so connection reads time out periodically to notice
+ * stop(); stop() returns after all connection threads have exited and their
+ * lines are closed.
+ */
+class BinaryUpdateServer
+{
+public:
+	typedef std::shared_ptr<BinaryUpdateServer> Ptr;
+
+	BinaryUpdateServer(const std::shared_ptr<cppio::IoLineManager>& io, const std::string& endpoint,
+			const DataSink::Ptr& datasink);
+	virtual ~BinaryUpdateServer();
+
+	void start();
+	void stop();
+
+private:
+	struct Connection
+	{
+		boost::thread thread;
+		std::atomic<bool> finished;
+	};
+
+	void acceptLoop();
+	void reapConnections();
+	void connectionLoop(const std::shared_ptr<cppio::IoLine>& line, Connection& connection);
+	bool readExactly(cppio::IoLine& line, uint8_t* buffer, size_t size);
+
+private:
+	std::shared_ptr<cppio::IoLineManager> m_io;
+	std::string m_endpoint;
+	DataSink::Ptr m_datasink;
+	std::unique_ptr<cppio::IoAcceptor> m_acceptor;
+	std::atomic<bool> m_run;
+	boost::thread m_acceptThread;
+	// Touched only by the accept thread, and by stop() after it has exited
+	std::list<std::unique_ptr<Connection>> m_connections;
+};
+
+#endif /* CORE_INGEST_BINARYUPDATESERVER_H_ */
@@ -0,0 +1,124 @@
+/*
+ * sharedmemoryingestserver.cpp
+ */
+
+#include "sharedmemoryingestserver.h"
+
+#include "core/stats/latencyrecorder.h"
+#include "log.h"
+
+#include <boost/interprocess/exceptions.hpp>
+
+#include <cstring>
+
+using namespace boost::interprocess;
+
+static logger_t gs_logger(boost::log::keywords::channel = "shm");
+
+static const size_t gs_maxBatch = 1024;
+static const int gs_spinIterations = 2000;
+
+SharedMemoryIngestServer::SharedMemoryIngestServer(const std::string& name, const DataSink::Ptr& datasink) :
+	m_name(name),
+	m_datasink(datasink),
+	m_run(false)
+{
+}
+
+SharedMemoryIngestServer::~SharedMemoryIngestServer()
+{
+	stop();
+}
+
+void SharedMemoryIngestServer::start()
+{
+	m_run = true;
+	m_thread = boost::thread(std::bind(&SharedMemoryIngestServer::readerLoop, this));
+}
+
+void SharedMemoryIngestServer::stop()
+{
+	m_run = false;
+	if(m_thread.joinable())
+		m_thread.join();
+}
+
+bool SharedMemoryIngestServer::openRing()
+{
+	try
+	{
+#ifdef _WIN32
+		m_shm = windows_shared_memory(open_only, m_name.c_str(), read_write);
+#else
+		m_shm = shared_memory_object(open_only, m_name.c_str(), read_write);
+#endif
+		m_region = mapped_region(m_shm, read_write);
+	}
+	catch(const interprocess_exception& e)
+	{
+		return false;
+	}
+
+	if(m_region.get_size() < sizeof(ShmRingHeader))
+		return false;
+
+	m_ring = std::unique_ptr<SharedMemoryRing>(new SharedMemoryRing(m_region.get_address()));
+	if(!m_ring->valid() || m_region.get_size() < SharedMemoryRing::bytesRequired(m_ring->capacity()))
+	{
+		LOG_WITH(gs_logger, warning) << "Shared memory ring has invalid header: " << m_name;
+		m_ring.reset();
+		return false;
+	}
+
+	LOG_WITH(gs_logger, info) << "Attached to shared memory ring: " << m_name << "; capacity: " << m_ring->capacity();
+	return true;
+}
+
+void SharedMemoryIngestServer::readerLoop()
+{
+	while(m_run && !openRing())
+		boost::this_thread::sleep_for(boost::chrono::seconds(1));
+	if(!m_run)
+		return;
+
+	auto latency = LatencyRecorder::instance().topic("shm:" + m_name);
+	int idle = 0;
+	while(m_run)
+	{
+		if(m_ring->available() == 0)
+		{
+			if(++idle > gs_spinIterations)
+				boost::this_thread::sleep_for(boost::chrono::microseconds(50));
+			continue;
+		}
+
+		idle = 0;
+		auto start = LatencyClock::now();
+		LatencyPoke poke(latency, start);
+		auto arrivalTime = m_clock.microseconds(start);
+		m_ring->consume(gs_maxBatch, [&](const ShmTickRecord& record)
+			{
+				processRecord(record, arrivalTime);
+			});
+		m_datasink->incomingTicks(m_batch.data(), m_batch.size());
+		m_batch.clear();
+	}
+}
+
+void SharedMemoryIngestServer::processRecord(const ShmTickRecord& record, uint64_t arrivalTime)
+{
+	m_nameBuffer.assign(record.instrument, strnlen(record.instrument, sizeof(record.instrument)));
+	auto& instrument = m_instruments[m_nameBuffer];
+	if(instrument == NoInstrument)
+		instrument = InstrumentRegistry::instance().id(m_nameBuffer);
+
+	goldmine::Tick tick;
+	auto timestamp = record.timestamp != 0 ? record.timestamp : arrivalTime;
+	tick.timestamp = timestamp / 1000000;
+	tick.useconds = timestamp % 1000000;
+	tick.datatype = record.datatype;
+	tick.value = record.value;
+	tick.volume = record.volume;
+
+	m_batch.push_back(TickUpdate { instrument, tick });
+}
@@ -0,0 +1,61 @@
+/*
+ * sharedmemoryingestserver.h
+ */
+
+#ifndef CORE_INGEST_SHAREDMEMORYINGESTSERVER_H_
+#define CORE_INGEST_SHAREDMEMORYINGESTSERVER_H_
+
+#include "sharedmemoryring.h"
+#include "core/tables/datasink.h"
+#include "core/tables/flatstringmap.h"
+#include "core/gatewayclock.h"
+
+#include <boost/thread.hpp>
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+/**
+ * Ingest backend reading fixed-layout tick records from a named shared memory
+ * ring (see sharedmemoryring.h) and feeding them to the DataSink. Records
+ * without timestamp get the arrival time of their batch.
+ */
+class SharedMemoryIngestServer
+{
+public:
+	typedef std::shared_ptr<SharedMemoryIngestServer> Ptr;
+
+	SharedMemoryIngestServer(const std::string& name, const DataSink::Ptr& datasink);
+	virtual ~SharedMemoryIngestServer();
+
+	void start();
+	void stop();
+
+private:
+	void readerLoop();
+	bool openRing();
+	void processRecord(const ShmTickRecord& record, uint64_t arrivalTime);
+
+private:
+	std::string m_name;
+	DataSink::Ptr m_datasink;
+	std::atomic<bool> m_run;
+	boost::thread m_thread;
+
+#ifdef _WIN32
+	boost::interprocess::windows_shared_memory m_shm;
+#else
+	boost::interprocess::shared_memory_object m_shm;
+#endif
+	boost::interprocess::mapped_region m_region;
+	std::unique_ptr<SharedMemoryRing> m_ring;
+	// Used by the reader thread only
+	GatewayClock m_clock;
+
+	FlatStringMap<InstrumentId> m_instruments;
+	std::string m_nameBuffer;
+	std::vector<TickUpdate> m_batch;
+};
+
+#endif /* CORE_INGEST_SHAREDMEMORYINGESTSERVER_H_ */
@@ -0,0 +1,48 @@
+/*
+ * sharedmemoryring.cpp
+ */
+
+#include "sharedmemoryring.h"
+
+#include "exceptions.h"
+
+#include <algorithm>
+
+using namespace boost::interprocess;
+
+SharedMemoryRingWriter::SharedMemoryRingWriter(const std::string& name, uint32_t capacity) : m_name(name)
+{
+	if(capacity == 0 || (capacity & (capacity - 1)) != 0)
+		BOOST_THROW_EXCEPTION(ParameterError() << errinfo_str("Ring capacity should be a power of two"));
+
+	auto size = SharedMemoryRing::bytesRequired(capacity);
+#ifdef _WIN32
+	m_shm = windows_shared_memory(create_only, name.c_str(), read_write, size);
+#else
+	shared_memory_object::remove(name.c_str());
+	m_shm = shared_memory_object(create_only, name.c_str(), read_write);
+	m_shm.truncate(size);
+#endif
+	m_region = mapped_region(m_shm, read_write, 0, size);
+	m_ring = std::unique_ptr<SharedMemoryRing>(new SharedMemoryRing(m_region.get_address()));
+	m_ring->initialize(capacity);
+}
+
+SharedMemoryRingWriter::~SharedMemoryRingWriter()
+{
+#ifndef _WIN32
+	shared_memory_object::remove(m_name.c_str());
+#endif
+}
+
+bool SharedMemoryRingWriter::write(const std::string& instrument, int datatype, double value, int volume, uint64_t timestamp)
+{
+	ShmTickRecord record;
+	std::memset(&record, 0, sizeof(record));
+	std::memcpy(record.instrument, instrument.data(), std::min(instrument.size(), sizeof(record.instrument) - 1));
+	record.datatype = datatype;
+	record.volume = volume;
+	record.value = value;
+	record.timestamp = timestamp;
+	return m_ring->tryWrite(record);
+}
@@ -0,0 +1,170 @@
+/*
+ * sharedmemoryring.h
+ */
+
+#ifndef CORE_INGEST_SHAREDMEMORYRING_H_
+#define CORE_INGEST_SHAREDMEMORYRING_H_
+
+#ifdef _WIN32
+#include <boost/interprocess/windows_shared_memory.hpp>
+#else
+#include <boost/interprocess/shared_memory_object.hpp>
+#endif
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+/*
+ * Shared memory layout (all fields little-endian, offsets in bytes):
+ *
+ *   0    ShmRingHeader (192 bytes)
+ *   192  ShmTickRecord[capacity] (64 bytes each)
+ *
+ * Single producer (QUIK-side exporter) advances writeIndex after filling a
+ * record, single consumer (gateway) advances readIndex after consuming it.
+ * Indices grow monotonically; slot is index & (capacity - 1).
+ */
+
+static const uint32_t ShmRingMagic = 0x47525147; // "GQRG"
+static const uint32_t ShmRingVersion = 1;
+
+struct ShmTickRecord
+{
+	char instrument[32]; // "CLASS#CODE", NUL-padded
+	uint32_t datatype;   // goldmine::Datatype
+	int32_t volume;
+	double value;
+	uint64_t timestamp;  // Microseconds since epoch, UTC; 0 means "use arrival time"
+	uint64_t reserved;
+};
+
+static_assert(sizeof(ShmTickRecord) == 64, "ShmTickRecord layout mismatch");
+
+struct ShmRingHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t capacity;
+	uint32_t recordSize;
+	char pad0[48];
+	std::atomic<uint64_t> writeIndex;
+	char pad1[56];
+	std::atomic<uint64_t> readIndex;
+	char pad2[56];
+};
+
+static_assert(sizeof(ShmRingHeader) == 192, "ShmRingHeader layout mismatch");
+
+/**
+ * View over a mapped ring. Does not own the memory.
+ */
+class SharedMemoryRing
+{
+public:
+	SharedMemoryRing(void* base) : m_header(static_cast<ShmRingHeader*>(base)),
+		m_records(reinterpret_cast<ShmTickRecord*>(static_cast<char*>(base) + sizeof(ShmRingHeader)))
+	{
+	}
+
+	static size_t bytesRequired(uint32_t capacity)
+	{
+		return sizeof(ShmRingHeader) + (size_t)capacity * sizeof(ShmTickRecord);
+	}
+
+	void initialize(uint32_t capacity)
+	{
+		std::memset(static_cast<void*>(m_header), 0, sizeof(ShmRingHeader));
+		m_header->capacity = capacity;
+		m_header->recordSize = sizeof(ShmTickRecord);
+		m_header->version = ShmRingVersion;
+		m_header->writeIndex.store(0, std::memory_order_relaxed);
+		m_header->readIndex.store(0, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		m_header->magic = ShmRingMagic;
+	}
+
+	bool valid() const
+	{
+		return (m_header->magic == ShmRingMagic) && (m_header->version == ShmRingVersion) &&
+			(m_header->recordSize == sizeof(ShmTickRecord)) &&
+			(m_header->capacity > 0) && ((m_header->capacity & (m_header->capacity - 1)) == 0);
+	}
+
+	uint32_t capacity() const
+	{
+		return m_header->capacity;
+	}
+
+	size_t available() const
+	{
+		return m_header->writeIndex.load(std::memory_order_acquire) - m_header->readIndex.load(std::memory_order_relaxed);
+	}
+
+	bool tryWrite(const ShmTickRecord& record)
+	{
+		auto write = m_header->writeIndex.load(std::memory_order_relaxed);
+		auto read = m_header->readIndex.load(std::memory_order_acquire);
+		if(write - read >= m_header->capacity)
+			return false;
+		m_records[write & (m_header->capacity - 1)] = record;
+		m_header->writeIndex.store(write + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * Calls f(const ShmTickRecord&) for up to maxRecords available records and
+	 * then releases their slots to the writer. Returns number of records consumed.
+	 */
+	template <typename F>
+	size_t consume(size_t maxRecords, F f)
+	{
+		auto read = m_header->readIndex.load(std::memory_order_relaxed);
+		auto write = m_header->writeIndex.load(std::memory_order_acquire);
+		size_t available = write - read;
+		if(available > maxRecords)
+			available = maxRecords;
+
+		for(size_t i = 0; i < available; i++)
+			f(m_records[(read + i) & (m_header->capacity - 1)]);
+
+		if(available > 0)
+			m_header->readIndex.store(read + available, std::memory_order_release);
+		return available;
+	}
+
+private:
+	ShmRingHeader* m_header;
+	ShmTickRecord* m_records;
+};
+
+/**
+ * Creates a named ring and writes records into it. This is what the QUIK-side
+ * exporter does; on the gateway side it is used as a stand-in for tests and
+ * load generation.
+ */
+class SharedMemoryRingWriter
+{
+public:
+	typedef std::shared_ptr<SharedMemoryRingWriter> Ptr;
+
+	SharedMemoryRingWriter(const std::string& name, uint32_t capacity);
+	virtual ~SharedMemoryRingWriter();
+
+	bool write(const std::string& instrument, int datatype, double value, int volume, uint64_t timestamp);
+
+private:
+	std::string m_name;
+#ifdef _WIN32
+	boost::interprocess::windows_shared_memory m_shm;
+#else
+	boost::interprocess::shared_memory_object m_shm;
+#endif
+	boost::interprocess::mapped_region m_region;
+	std::unique_ptr<SharedMemoryRing> m_ring;
+};
+
+#endif /* CORE_INGEST_SHAREDMEMORYRING_H_ */
@@ -0,0 +1,59 @@
+/*
+ * instrumentmetadata.cpp
+ */
+
+#include "instrumentmetadata.h"
+
+#include "exceptions.h"
+
+constexpr double InstrumentMetadata::DefaultPriceStep;
+constexpr double InstrumentMetadata::GridTolerance;
+
+InstrumentMetadata::InstrumentMetadata()
+{
+	for(auto& chunk : m_chunks)
+		chunk.store(nullptr, std::memory_order_relaxed);
+}
+
+InstrumentMetadata::~InstrumentMetadata()
+{
+	for(auto& chunk : m_chunks)
+		delete chunk.load(std::memory_order_relaxed);
+}
+
+InstrumentMetadata& InstrumentMetadata::instance()
+{
+	static InstrumentMetadata metadata;
+	return metadata;
+}
+
+void InstrumentMetadata::setPriceStep(InstrumentId instrument, double step, int scale)
+{
+	if(instrument == NoInstrument || !(step > 0))
+		return;
+
+	size_t chunkIndex = instrument >> ChunkBits;
+	if(chunkIndex >= MaxChunks)
+		BOOST_THROW_EXCEPTION(LogicError() << errinfo_str("Too many instruments"));
+
+	auto chunk = m_chunks[chunkIndex].load(std::memory_order_acquire);
+	if(!chunk)
+	{
+		boost::unique_lock<boost::mutex> lock(m_mutex);
+		chunk = m_chunks[chunkIndex].load(std::memory_order_relaxed);
+		if(!chunk)
+		{
+			chunk = new Chunk;
+			for(auto& entry : chunk->entries)
+			{
+				entry.step.store(DefaultPriceStep, std::memory_order_relaxed);
+				entry.scale.store(-1, std::memory_order_relaxed);
+			}
+			m_chunks[chunkIndex].store(chunk, std::memory_order_release);
+		}
+	}
+
+	auto& entry = chunk->entries[instrument & (ChunkSize - 1)];
+	entry.scale.store(scale, std::memory_order_relaxed);
+	entry.step.store(step, std::memory_order_relaxed);
+}
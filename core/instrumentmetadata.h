@@ -0,0 +1,110 @@
+/*
+ * instrumentmetadata.h
+ */
+
+#ifndef CORE_INSTRUMENTMETADATA_H_
+#define CORE_INSTRUMENTMETADATA_H_
+
+#include "core/instrumentregistry.h"
+
+#include <boost/thread/mutex.hpp>
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+/**
+ * Price in units of instrument's price step
+ */
+typedef int64_t TickPrice;
+
+/**
+ * Process-wide cache of instrument properties reported by exchange tables,
+ * indexed by InstrumentId. Readers are lock-free; writers (table parsers)
+ * take a mutex only to allocate storage.
+ *
+ * Instruments with unknown price step use DefaultPriceStep, fine enough to
+ * represent any exchange price exactly.
+ */
+class InstrumentMetadata
+{
+public:
+	static constexpr double DefaultPriceStep = 1e-8;
+
+	static InstrumentMetadata& instance();
+
+	void setPriceStep(InstrumentId instrument, double step, int scale);
+
+	double priceStep(InstrumentId instrument) const
+	{
+		auto entry = find(instrument);
+		return entry ? entry->step.load(std::memory_order_relaxed) : DefaultPriceStep;
+	}
+
+	int scale(InstrumentId instrument) const
+	{
+		auto entry = find(instrument);
+		return entry ? entry->scale.load(std::memory_order_relaxed) : -1;
+	}
+
+	static TickPrice toTicks(double price, double step)
+	{
+		return std::llround(price / step);
+	}
+
+	/**
+	 * Nearest grid price not above (floor) or not below (ceil) the price, e.g.
+	 * for buy and sell limits. Prices within rounding error of a grid price
+	 * are snapped to it.
+	 */
+	static TickPrice toTicksFloor(double price, double step)
+	{
+		return (TickPrice)std::floor(price / step + GridTolerance);
+	}
+
+	static TickPrice toTicksCeil(double price, double step)
+	{
+		return (TickPrice)std::ceil(price / step - GridTolerance);
+	}
+
+	static double fromTicks(TickPrice price, double step)
+	{
+		return price * step;
+	}
+
+private:
+	InstrumentMetadata();
+	~InstrumentMetadata();
+
+	// In price steps
+	static constexpr double GridTolerance = 1e-6;
+
+	static const int ChunkBits = 12;
+	static const size_t ChunkSize = 1 << ChunkBits;
+	static const size_t MaxChunks = 1024;
+
+	struct Entry
+	{
+		std::atomic<double> step;
+		std::atomic<int> scale;
+	};
+
+	struct Chunk
+	{
+		std::array<Entry, ChunkSize> entries;
+	};
+
+	const Entry* find(InstrumentId instrument) const
+	{
+		auto chunk = m_chunks[(instrument >> ChunkBits) & (MaxChunks - 1)].load(std::memory_order_acquire);
+		if(!chunk)
+			return nullptr;
+		return &chunk->entries[instrument & (ChunkSize - 1)];
+	}
+
+	boost::mutex m_mutex;
+	std::array<std::atomic<Chunk*>, MaxChunks> m_chunks;
+};
+
+#endif /* CORE_INSTRUMENTMETADATA_H_ */
@@ -0,0 +1,74 @@
+/*
+ * instrumentregistry.cpp
+ */
+
+#include "instrumentregistry.h"
+
+#include "exceptions.h"
+
+InstrumentRegistry::InstrumentRegistry() : m_lastId(NoInstrument)
+{
+	for(auto& chunk : m_chunks)
+		chunk.store(nullptr, std::memory_order_relaxed);
+}
+
+InstrumentRegistry::~InstrumentRegistry()
+{
+	for(auto& chunk : m_chunks)
+		delete chunk.load(std::memory_order_relaxed);
+}
+
+InstrumentRegistry& InstrumentRegistry::instance()
+{
+	static InstrumentRegistry registry;
+	return registry;
+}
+
+InstrumentId InstrumentRegistry::id(const std::string& name)
+{
+	{
+		boost::shared_lock<boost::shared_mutex> lock(m_mutex);
+		auto it = m_ids.find(name);
+		if(it != m_ids.end())
+			return it->second;
+	}
+
+	boost::unique_lock<boost::shared_mutex> lock(m_mutex);
+	auto it = m_ids.find(name);
+	if(it != m_ids.end())
+		return it->second;
+
+	InstrumentId id = m_lastId.load(std::memory_order_relaxed) + 1;
+	size_t chunkIndex = id >> ChunkBits;
+	if(chunkIndex >= MaxChunks)
+		BOOST_THROW_EXCEPTION(LogicError() << errinfo_str("Too many instruments"));
+
+	auto chunk = m_chunks[chunkIndex].load(std::memory_order_relaxed);
+	if(!chunk)
+	{
+		chunk = new Chunk;
+		chunk->names[id & (ChunkSize - 1)] = name;
+		m_chunks[chunkIndex].store(chunk, std::memory_order_release);
+	}
+	else
+	{
+		chunk->names[id & (ChunkSize - 1)] = name;
+	}
+	m_ids.insert(std::make_pair(name, id));
+	m_lastId.store(id, std::memory_order_release);
+	return id;
+}
+
+InstrumentId InstrumentRegistry::find(const std::string& name) const
+{
+	boost::shared_lock<boost::shared_mutex> lock(m_mutex);
+	auto it = m_ids.find(name);
+	if(it != m_ids.end())
+		return it->second;
+	return NoInstrument;
+}
+
+size_t InstrumentRegistry::size() const
+{
+	return m_lastId.load(std::memory_order_acquire);
+}
@@ -0,0 +1,64 @@
+/*
+ * instrumentregistry.h
+ */
+
+#ifndef CORE_INSTRUMENTREGISTRY_H_
+#define CORE_INSTRUMENTREGISTRY_H_
+
+#include <boost/thread/shared_mutex.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+typedef uint32_t InstrumentId;
+
+static const InstrumentId NoInstrument = 0;
+
+/**
+ * Process-wide registry assigning dense ids (starting from 1) to
+ * "CLASS#CODE" instrument names on first sight. Ids are never reused.
+ * name() is lock-free, so resolving an id at the publishing boundary costs
+ * two loads.
+ */
+class InstrumentRegistry
+{
+public:
+	static InstrumentRegistry& instance();
+
+	InstrumentId id(const std::string& name);
+	InstrumentId find(const std::string& name) const;
+
+	const std::string& name(InstrumentId id) const
+	{
+		auto chunk = m_chunks[(id >> ChunkBits) & (MaxChunks - 1)].load(std::memory_order_acquire);
+		if(!chunk || id == NoInstrument)
+			return m_emptyName;
+		return chunk->names[id & (ChunkSize - 1)];
+	}
+
+	size_t size() const;
+
+private:
+	InstrumentRegistry();
+	~InstrumentRegistry();
+
+	static const int ChunkBits = 12;
+	static const size_t ChunkSize = 1 << ChunkBits;
+	static const size_t MaxChunks = 1024;
+
+	struct Chunk
+	{
+		std::array<std::string, ChunkSize> names;
+	};
+
+	mutable boost::shared_mutex m_mutex;
+	std::unordered_map<std::string, InstrumentId> m_ids;
+	std::array<std::atomic<Chunk*>, MaxChunks> m_chunks;
+	std::atomic<InstrumentId> m_lastId;
+	std::string m_emptyName;
+};
+
+#endif /* CORE_INSTRUMENTREGISTRY_H_ */
@@ -0,0 +1,409 @@
+/*
+ * journalcodec.cpp
+ */
+
+#include "journalcodec.h"
+
+#include "exceptions.h"
+
+#include <cmath>
+#include <cstring>
+
+static const int gs_maxDecimals = 15;
+static const double gs_pow10[gs_maxDecimals + 1] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15 };
+
+// Finest step used when instrument's own step does not fit
+static const int gs_fallbackDecimals = 8;
+
+// Largest integer exactly representable in double
+static const double gs_maxExact = 9007199254740992.;
+
+static inline uint64_t zigzag(int64_t value)
+{
+	return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static inline int64_t unzigzag(uint64_t value)
+{
+	return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static inline uint8_t* putVarint(uint8_t* out, uint64_t value)
+{
+	while(value >= 0x80)
+	{
+		*out++ = (uint8_t)value | 0x80;
+		value >>= 7;
+	}
+	*out++ = (uint8_t)value;
+	return out;
+}
+
+static inline const uint8_t* getVarint(const uint8_t* p, const uint8_t* end, uint64_t& value)
+{
+	value = 0;
+	for(int shift = 0; shift < 64; shift += 7)
+	{
+		if(p == end)
+			break;
+		uint8_t byte = *p++;
+		value |= (uint64_t)(byte & 0x7f) << shift;
+		if(!(byte & 0x80))
+			return p;
+	}
+	BOOST_THROW_EXCEPTION(FormatError() << errinfo_str("Invalid varint in tick journal block"));
+}
+
+static const uint8_t* getVarints(const uint8_t* p, const uint8_t* end, uint64_t* out, size_t count)
+{
+	size_t i = 0;
+	while(i < count)
+	{
+		// Most deltas fit in one byte: take 8 of them at once when no
+		// continuation bit is set in the next word
+		if(count - i >= 8 && end - p >= 8)
+		{
+			uint64_t word;
+			std::memcpy(&word, p, sizeof(word));
+			if((word & 0x8080808080808080ULL) == 0)
+			{
+				for(int j = 0; j < 8; j++)
+					out[i + j] = p[j];
+				p += 8;
+				i += 8;
+				continue;
+			}
+		}
+		p = getVarint(p, end, out[i++]);
+	}
+	return p;
+}
+
+static inline double packedValue(int64_t ticks, const JournalPackedKey& key)
+{
+	return (double)(ticks * key.units) / gs_pow10[key.decimals];
+}
+
+static inline bool toTicks(double value, const JournalPackedKey& key, int64_t& ticks)
+{
+	double scaled = value * gs_pow10[key.decimals] / key.units;
+	if(!(std::fabs(scaled) * key.units < gs_maxExact))
+		return false;
+	ticks = std::llround(scaled);
+
+	// Exact round trip only, including the sign of zero
+	double decoded = packedValue(ticks, key);
+	return std::memcmp(&decoded, &value, sizeof(double)) == 0;
+}
+
+JournalStep journalStep(double step)
+{
+	if(step > 0)
+	{
+		for(int decimals = 0; decimals <= gs_fallbackDecimals; decimals++)
+		{
+			double scaled = step * gs_pow10[decimals];
+			int64_t units = std::llround(scaled);
+			if(units > 0 && std::fabs(scaled - units) < 1e-6 * units)
+				return JournalStep { units, decimals };
+		}
+	}
+	return JournalStep { 1, gs_fallbackDecimals };
+}
+
+JournalEncoder::JournalEncoder()
+{
+}
+
+size_t JournalEncoder::maxSize(size_t count)
+{
+	// Varints of 64-bit timestamps and value deltas take up to 10 bytes, of
+	// 32-bit volumes up to 5
+	return sizeof(JournalPackedHeader) + count * sizeof(JournalPackedKey) + journalAlign(count * sizeof(uint32_t)) +
+			count * (10 + 10 + 5) + 8;
+}
+
+size_t JournalEncoder::encode(const uint32_t* instruments, const int32_t* datatypes, const uint64_t* timestamps,
+		const double* values, const int32_t* volumes, size_t count, const JournalStepLookup& steps, char* out)
+{
+	m_keyIndex.clear();
+	m_keys.clear();
+	m_tickKeys.resize(count);
+
+	uint64_t previousKey = ~(uint64_t)0;
+	uint32_t previousIndex = 0;
+	for(size_t i = 0; i < count; i++)
+	{
+		uint64_t key = ((uint64_t)instruments[i] << 32) | (uint32_t)datatypes[i];
+		if(key != previousKey)
+		{
+			auto result = m_keyIndex.insert(std::make_pair(key, (uint32_t)m_keys.size()));
+			if(result.second)
+			{
+				auto step = steps(instruments[i]);
+				JournalPackedKey packed;
+				std::memset(&packed, 0, sizeof(packed));
+				packed.instrument = instruments[i];
+				packed.datatype = datatypes[i];
+				packed.units = step.units;
+				packed.decimals = step.units > 0 && step.decimals >= 0 && step.decimals <= gs_maxDecimals ?
+						step.decimals : JournalRawValues;
+				m_keys.push_back(packed);
+			}
+			previousKey = key;
+			previousIndex = result.first->second;
+		}
+		m_tickKeys[i] = previousIndex;
+	}
+
+	// Keys whose values don't fit their step fall back to the finest step,
+	// then to raw doubles; repeat until every value of every key fits
+	bool downgraded = true;
+	while(downgraded)
+	{
+		downgraded = false;
+		int64_t ticks;
+		for(size_t i = 0; i < count; i++)
+		{
+			auto& key = m_keys[m_tickKeys[i]];
+			if(key.decimals == JournalRawValues || toTicks(values[i], key, ticks))
+				continue;
+
+			if(key.decimals < gs_fallbackDecimals)
+			{
+				key.units = 1;
+				key.decimals = gs_fallbackDecimals;
+			}
+			else
+			{
+				key.decimals = JournalRawValues;
+			}
+			downgraded = true;
+		}
+	}
+
+	JournalPackedHeader header;
+	std::memset(&header, 0, sizeof(header));
+	header.keys = m_keys.size();
+	header.keyWidth = m_keys.size() <= 0x100 ? 1 : m_keys.size() <= 0x10000 ? 2 : 4;
+
+	char* p = out + sizeof(header);
+	std::memcpy(p, m_keys.data(), m_keys.size() * sizeof(JournalPackedKey));
+	p += m_keys.size() * sizeof(JournalPackedKey);
+
+	for(size_t i = 0; i < count; i++)
+	{
+		uint32_t index = m_tickKeys[i];
+		if(header.keyWidth == 1)
+			p[i] = (uint8_t)index;
+		else if(header.keyWidth == 2)
+			std::memcpy(p + 2 * i, &index, 2);
+		else
+			std::memcpy(p + 4 * i, &index, 4);
+	}
+	size_t keysSize = journalAlign(count * header.keyWidth);
+	std::memset(p + count * header.keyWidth, 0, keysSize - count * header.keyWidth);
+	p += keysSize;
+
+	auto* stream = reinterpret_cast<uint8_t*>(p);
+	auto* start = stream;
+	uint64_t previousDelta = 0;
+	for(size_t i = 1; i < count; i++)
+	{
+		uint64_t delta = timestamps[i] - timestamps[i - 1];
+		stream = putVarint(stream, zigzag((int64_t)(delta - previousDelta)));
+		previousDelta = delta;
+	}
+	header.timestampBytes = stream - start;
+
+	start = stream;
+	m_last.assign(m_keys.size(), 0);
+	for(size_t i = 0; i < count; i++)
+	{
+		uint32_t index = m_tickKeys[i];
+		const auto& key = m_keys[index];
+		if(key.decimals == JournalRawValues)
+		{
+			std::memcpy(stream, &values[i], sizeof(double));
+			stream += sizeof(double);
+			continue;
+		}
+
+		int64_t ticks;
+		toTicks(values[i], key, ticks);
+		stream = putVarint(stream, zigzag(ticks - m_last[index]));
+		m_last[index] = ticks;
+	}
+	header.valueBytes = stream - start;
+
+	start = stream;
+	for(size_t i = 0; i < count; i++)
+		stream = putVarint(stream, zigzag(volumes[i]));
+	header.volumeBytes = stream - start;
+
+	size_t size = reinterpret_cast<char*>(stream) - out;
+	size_t padded = journalAlign(size);
+	std::memset(out + size, 0, padded - size);
+	std::memcpy(out, &header, sizeof(header));
+	return padded;
+}
+
+void journalDecode(const JournalBlockHeader& block, const char* payload, JournalColumns& columns)
+{
+	const char* end = payload + block.size;
+	JournalPackedHeader header;
+	if(block.size < sizeof(header))
+		BOOST_THROW_EXCEPTION(FormatError() << errinfo_str("Truncated packed tick journal block"));
+	std::memcpy(&header, payload, sizeof(header));
+
+	size_t count = block.count;
+	const auto* keys = reinterpret_cast<const JournalPackedKey*>(payload + sizeof(header));
+	const char* indices = payload + sizeof(header) + header.keys * sizeof(JournalPackedKey);
+	const auto* stream = reinterpret_cast<const uint8_t*>(indices + journalAlign(count * header.keyWidth));
+	const auto* timestampEnd = stream + header.timestampBytes;
+	const auto* valueEnd = timestampEnd + header.valueBytes;
+	const auto* volumeEnd = valueEnd + header.volumeBytes;
+	if((header.keyWidth != 1 && header.keyWidth != 2 && header.keyWidth != 4) || (count > 0 && header.keys == 0) ||
+			header.keys > count || reinterpret_cast<const char*>(volumeEnd) > end)
+		BOOST_THROW_EXCEPTION(FormatError() << errinfo_str("Invalid packed tick journal block"));
+
+	for(uint32_t k = 0; k < header.keys; k++)
+	{
+		if(keys[k].decimals != JournalRawValues && (keys[k].decimals < 0 || keys[k].decimals > gs_maxDecimals))
+			BOOST_THROW_EXCEPTION(FormatError() << errinfo_str("Invalid packed tick journal key"));
+	}
+
+	columns.count = count;
+	columns.instrumentStorage.resize(count);
+	columns.datatypeStorage.resize(count);
+	columns.timestampStorage.resize(count);
+	columns.valueStorage.resize(count);
+	columns.volumeStorage.resize(count);
+	columns.keyScratch.resize(count);
+	columns.varintScratch.resize(count);
+	columns.lastScratch.assign(header.keys, 0);
+
+	auto* keyIndex = columns.keyScratch.data();
+	if(header.keyWidth == 1)
+	{
+		const auto* narrow = reinterpret_cast<const uint8_t*>(indices);
+		for(size_t i = 0; i < count; i++)
+			keyIndex[i] = narrow[i];
+	}
+	else
+	{
+		for(size_t i = 0; i < count; i++)
+		{
+			uint32_t index = 0;
+			std::memcpy(&index, indices + i * header.keyWidth, header.keyWidth);
+			keyIndex[i] = index;
+		}
+	}
+	for(size_t i = 0; i < count; i++)
+	{
+		if(keyIndex[i] >= header.keys)
+			BOOST_THROW_EXCEPTION(FormatError() << errinfo_str("Invalid key index in tick journal block"));
+	}
+
+	auto* instruments = columns.instrumentStorage.data();
+	auto* datatypes = columns.datatypeStorage.data();
+	for(size_t i = 0; i < count; i++)
+	{
+		instruments[i] = keys[keyIndex[i]].instrument;
+		datatypes[i] = keys[keyIndex[i]].datatype;
+	}
+
+	auto* varints = columns.varintScratch.data();
+	auto* timestamps = columns.timestampStorage.data();
+	if(count > 0)
+	{
+		if(getVarints(stream, timestampEnd, varints, count - 1) != timestampEnd)
+			BOOST_THROW_EXCEPTION(FormatError() << errinfo_str("Invalid timestamps in tick journal block"));
+		timestamps[0] = block.firstTimestamp;
+		uint64_t delta = 0;
+		for(size_t i = 1; i < count; i++)
+		{
+			delta += (uint64_t)unzigzag(varints[i - 1]);
+			timestamps[i] = timestamps[i - 1] + delta;
+		}
+	}
+
+	auto* values = columns.valueStorage.data();
+	auto* last = columns.lastScratch.data();
+	bool rawValues = false;
+	for(uint32_t k = 0; k < header.keys; k++)
+		rawValues |= keys[k].decimals == JournalRawValues;
+	if(!rawValues)
+	{
+		if(getVarints(timestampEnd, valueEnd, varints, count) != valueEnd)
+			BOOST_THROW_EXCEPTION(FormatError() << errinfo_str("Invalid values in tick journal block"));
+		for(size_t i = 0; i < count; i++)
+		{
+			uint32_t k = keyIndex[i];
+			last[k] += unzigzag(varints[i]);
+			values[i] = packedValue(last[k], keys[k]);
+		}
+	}
+	else
+	{
+		const auto* p = timestampEnd;
+		for(size_t i = 0; i < count; i++)
+		{
+			uint32_t k = keyIndex[i];
+			if(keys[k].decimals == JournalRawValues)
+			{
+				if(valueEnd - p < (ptrdiff_t)sizeof(double))
+					BOOST_THROW_EXCEPTION(FormatError() << errinfo_str("Invalid values in tick journal block"));
+				std::memcpy(&values[i], p, sizeof(double));
+				p += sizeof(double);
+				continue;
+			}
+
+			uint64_t delta;
+			p = getVarint(p, valueEnd, delta);
+			last[k] += unzigzag(delta);
+			values[i] = packedValue(last[k], keys[k]);
+		}
+		if(p != valueEnd)
+			BOOST_THROW_EXCEPTION(FormatError() << errinfo_str("Invalid values in tick journal block"));
+	}
+
+	if(getVarints(valueEnd, volumeEnd, varints, count) != volumeEnd)
+		BOOST_THROW_EXCEPTION(FormatError() << errinfo_str("Invalid volumes in tick journal block"));
+	auto* volumes = columns.volumeStorage.data();
+	for(size_t i = 0; i < count; i++)
+		volumes[i] = (int32_t)unzigzag(varints[i]);
+
+	columns.instruments = instruments;
+	columns.datatypes = datatypes;
+	columns.timestamps = timestamps;
+	columns.values = values;
+	columns.volumes = volumes;
+}
+
+void journalBlockInstruments(const JournalBlockHeader& header, const char* payload, std::vector<uint32_t>& instruments)
+{
+	instruments.clear();
+	if(header.encoding == (uint32_t)JournalEncoding::Packed)
+	{
+		JournalPackedHeader packed;
+		if(header.size < sizeof(packed))
+			BOOST_THROW_EXCEPTION(FormatError() << errinfo_str("Truncated packed tick journal block"));
+		std::memcpy(&packed, payload, sizeof(packed));
+		if(sizeof(packed) + (uint64_t)packed.keys * sizeof(JournalPackedKey) > header.size)
+			BOOST_THROW_EXCEPTION(FormatError() << errinfo_str("Invalid packed tick journal block"));
+
+		const auto* keys = reinterpret_cast<const JournalPackedKey*>(payload + sizeof(packed));
+		for(uint32_t k = 0; k < packed.keys; k++)
+			instruments.push_back(keys[k].instrument);
+	}
+	else
+	{
+		JournalRawLayout layout(header.count);
+		if(layout.size > header.size)
+			BOOST_THROW_EXCEPTION(FormatError() << errinfo_str("Invalid tick journal block size"));
+		const auto* column = reinterpret_cast<const uint32_t*>(payload + layout.instruments);
+		instruments.assign(column, column + header.count);
+	}
+}
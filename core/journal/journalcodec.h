@@ -0,0 +1,102 @@
+/*
+ * journalcodec.h
+ */
+
+#ifndef JOURNAL_JOURNALCODEC_H_
+#define JOURNAL_JOURNALCODEC_H_
+
+#include "core/journal/journalformat.h"
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Columns of one ticks block. Raw blocks point into the journal mapping,
+ * packed blocks into the storage vectors, so pointers stay valid while both
+ * the reader and the columns object are alive and unchanged.
+ */
+struct JournalColumns
+{
+	JournalColumns() : count(0), instruments(nullptr), datatypes(nullptr), timestamps(nullptr),
+		values(nullptr), volumes(nullptr)
+	{
+	}
+
+	size_t count;
+	const uint32_t* instruments;
+	const int32_t* datatypes;
+	const uint64_t* timestamps;
+	const double* values;
+	const int32_t* volumes;
+
+	std::vector<uint32_t> instrumentStorage;
+	std::vector<int32_t> datatypeStorage;
+	std::vector<uint64_t> timestampStorage;
+	std::vector<double> valueStorage;
+	std::vector<int32_t> volumeStorage;
+
+	// Decoder scratch
+	std::vector<uint32_t> keyScratch;
+	std::vector<uint64_t> varintScratch;
+	std::vector<int64_t> lastScratch;
+};
+
+/**
+ * Price step of a packed value: value = ticks * units / 10^decimals
+ */
+struct JournalStep
+{
+	int64_t units;
+	int32_t decimals;
+};
+
+/**
+ * Maps price step (e.g. from InstrumentMetadata) to JournalStep
+ */
+JournalStep journalStep(double step);
+
+typedef std::function<JournalStep(uint32_t instrument)> JournalStepLookup;
+
+/**
+ * Encodes ticks blocks with JournalEncoding::Packed. Keeps scratch buffers
+ * between blocks, so it should be owned by the writer thread.
+ */
+class JournalEncoder
+{
+public:
+	JournalEncoder();
+
+	/**
+	 * Upper bound of encoded size of count ticks
+	 */
+	static size_t maxSize(size_t count);
+
+	/**
+	 * Writes payload to out (at least maxSize(count) bytes) and returns its
+	 * size, multiple of 8. Value step of an instrument is queried once per
+	 * block; values which are not exact multiples of it are stored as is.
+	 */
+	size_t encode(const uint32_t* instruments, const int32_t* datatypes, const uint64_t* timestamps,
+			const double* values, const int32_t* volumes, size_t count, const JournalStepLookup& steps, char* out);
+
+private:
+	std::unordered_map<uint64_t, uint32_t> m_keyIndex;
+	std::vector<JournalPackedKey> m_keys;
+	std::vector<uint32_t> m_tickKeys;
+	std::vector<int64_t> m_last;
+};
+
+/**
+ * Decodes packed block payload into columns storage
+ */
+void journalDecode(const JournalBlockHeader& header, const char* payload, JournalColumns& columns);
+
+/**
+ * Journal instruments referred to by ticks block, possibly with duplicates.
+ * Packed blocks are not decoded: only their keys are read.
+ */
+void journalBlockInstruments(const JournalBlockHeader& header, const char* payload, std::vector<uint32_t>& instruments);
+
+#endif /* JOURNAL_JOURNALCODEC_H_ */
@@ -0,0 +1,34 @@
+/*
+ * journalformat.cpp
+ */
+
+#include "journalformat.h"
+
+#include <cstdio>
+
+uint32_t journalDay(uint64_t timestamp)
+{
+	// Civil date from days since epoch (H. Hinnant's algorithm)
+	int64_t z = (int64_t)(timestamp / 86400000000ULL) + 719468;
+	int64_t era = z / 146097;
+	int64_t dayOfEra = z - era * 146097;
+	int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+	int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+	int64_t mp = (5 * dayOfYear + 2) / 153;
+	int64_t day = dayOfYear - (153 * mp + 2) / 5 + 1;
+	int64_t month = mp < 10 ? mp + 3 : mp - 9;
+	int64_t year = yearOfEra + era * 400 + (month <= 2 ? 1 : 0);
+	return (uint32_t)(year * 10000 + month * 100 + day);
+}
+
+std::string journalFileName(const std::string& directory, uint32_t day)
+{
+	char name[32];
+	std::snprintf(name, sizeof(name), "%08u.ticks", day);
+	return directory + "/" + name;
+}
+
+std::string journalIndexFileName(const std::string& journalFileName)
+{
+	return journalFileName + ".index";
+}
@@ -0,0 +1,192 @@
+/*
+ * journalformat.h
+ */
+
+#ifndef JOURNAL_JOURNALFORMAT_H_
+#define JOURNAL_JOURNALFORMAT_H_
+
+#include <cstdint>
+#include <string>
+
+/*
+ * Tick journal file layout (one file per UTC day, little-endian):
+ *
+ *   0    JournalFileHeader (64 bytes)
+ *   64   blocks, each JournalBlockHeader (64 bytes) followed by payload of
+ *        header.size bytes (multiple of 8)
+ *
+ * The file is preallocated in segments, so it may be longer than
+ * header.dataEnd; everything past dataEnd is garbage.
+ *
+ * Instruments block payload: records { uint32 id; uint32 length; char
+ * name[length] } padded to 4 bytes. Journal instrument ids are dense, local to
+ * the file and defined before the first ticks block that uses them.
+ *
+ * Ticks block payload (Raw encoding): columns of header.count values, each
+ * starting at 8-byte boundary:
+ *   uint32 instrument[], int32 datatype[], uint64 timestamp[] (microseconds
+ *   since epoch), double value[], int32 volume[]
+ *
+ * Ticks block payload (Packed encoding):
+ *   JournalPackedHeader
+ *   JournalPackedKey key[keys]: distinct (instrument, datatype) pairs
+ *   key index of every tick, keyWidth bytes each, padded to 8 bytes
+ *   timestamp stream: zigzag varint delta-of-delta for ticks 1..count-1,
+ *     tick 0 is header.firstTimestamp
+ *   value stream: per tick zigzag varint delta of value in key's step units
+ *     from previous value of the key in the block (from 0 for the first one),
+ *     or 8 raw bytes of double if key's decimals is JournalRawValues
+ *   volume stream: zigzag varint per tick
+ *   padding to 8 bytes
+ *
+ * Index file (journal file name + ".index") is written along with the journal:
+ *
+ *   0    JournalIndexHeader (64 bytes)
+ *   64   JournalIndexEntry of every ticks block, in journal order
+ *   postingsOffset (when the journal is closed):
+ *        uint64 start[instruments + 1]; uint32 block[start[instruments]]
+ *        Blocks of journal instrument i are block[start[i]..start[i + 1]),
+ *        ascending.
+ *
+ * Index of an existing journal is rebuilt when the writer reopens it.
+ */
+
+static const uint32_t JournalMagic = 0x314A5147; // "GQJ1"
+
+static const uint32_t NoJournalInstrument = ~(uint32_t)0;
+static const uint32_t JournalVersion = 1;
+
+enum class JournalBlockType : uint32_t
+{
+	Ticks = 1,
+	Instruments = 2
+};
+
+enum class JournalEncoding : uint32_t
+{
+	Raw = 0,
+	Packed = 1
+};
+
+struct JournalFileHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t day;        // YYYYMMDD
+	uint32_t reserved0;
+	uint64_t dataEnd;    // Offset past the last complete block
+	char reserved[40];
+};
+
+static_assert(sizeof(JournalFileHeader) == 64, "JournalFileHeader layout mismatch");
+
+struct JournalBlockHeader
+{
+	uint32_t type;
+	uint32_t encoding;
+	uint32_t count;
+	uint32_t size;
+	uint64_t firstTimestamp;
+	uint64_t lastTimestamp;
+	// Ticks are not necessarily in time order (e.g. imported trades)
+	uint64_t minTimestamp;
+	uint64_t maxTimestamp;
+	char reserved[16];
+};
+
+static_assert(sizeof(JournalBlockHeader) == 64, "JournalBlockHeader layout mismatch");
+
+struct JournalPackedHeader
+{
+	uint32_t keys;
+	uint32_t keyWidth;
+	uint32_t timestampBytes;
+	uint32_t valueBytes;
+	uint32_t volumeBytes;
+	uint32_t reserved;
+};
+
+static_assert(sizeof(JournalPackedHeader) == 24, "JournalPackedHeader layout mismatch");
+
+static const int32_t JournalRawValues = -1;
+
+struct JournalPackedKey
+{
+	uint32_t instrument;
+	int32_t datatype;
+	int64_t units;     // value = ticks * units / 10^decimals
+	int32_t decimals;  // JournalRawValues if values are stored as doubles
+	uint32_t reserved;
+};
+
+static_assert(sizeof(JournalPackedKey) == 24, "JournalPackedKey layout mismatch");
+
+static const uint32_t JournalIndexMagic = 0x584A5147; // "GQJX"
+static const uint32_t JournalIndexVersion = 1;
+
+// Instrument bitmap of index entries: bit (journal instrument % 256)
+static const uint32_t JournalIndexBitmapBits = 256;
+
+struct JournalIndexHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t day;
+	uint32_t reserved0;
+	uint64_t blocks;
+	uint64_t postingsOffset; // 0 if postings are not written yet
+	uint64_t instruments;
+	char reserved[24];
+};
+
+static_assert(sizeof(JournalIndexHeader) == 64, "JournalIndexHeader layout mismatch");
+
+struct JournalIndexEntry
+{
+	uint64_t offset;         // Of block header in journal file
+	uint64_t minTimestamp;
+	uint64_t maxTimestamp;
+	uint64_t runningMax;     // Max timestamp of this and all preceding blocks
+	uint32_t count;
+	uint32_t reserved;
+	uint64_t instruments[JournalIndexBitmapBits / 64];
+};
+
+static_assert(sizeof(JournalIndexEntry) == 72, "JournalIndexEntry layout mismatch");
+
+static inline size_t journalAlign(size_t size)
+{
+	return (size + 7) & ~(size_t)7;
+}
+
+/**
+ * Column offsets of Raw ticks block payload
+ */
+struct JournalRawLayout
+{
+	JournalRawLayout(size_t count) : instruments(0),
+		datatypes(journalAlign(count * sizeof(uint32_t))),
+		timestamps(datatypes + journalAlign(count * sizeof(int32_t))),
+		values(timestamps + count * sizeof(uint64_t)),
+		volumes(values + count * sizeof(double)),
+		size(volumes + journalAlign(count * sizeof(int32_t)))
+	{
+	}
+
+	size_t instruments;
+	size_t datatypes;
+	size_t timestamps;
+	size_t values;
+	size_t volumes;
+	size_t size;
+};
+
+/**
+ * UTC day (YYYYMMDD) of a timestamp in microseconds since epoch
+ */
+uint32_t journalDay(uint64_t timestamp);
+
+std::string journalFileName(const std::string& directory, uint32_t day);
+std::string journalIndexFileName(const std::string& journalFileName);
+
+#endif /* JOURNAL_JOURNALFORMAT_H_ */
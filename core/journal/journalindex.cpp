@@ -0,0 +1,137 @@
+/*
+ * journalindex.cpp
+ */
+
+#include "journalindex.h"
+
+#include "exceptions.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace boost::interprocess;
+
+JournalIndex::JournalIndex(const std::string& path) : m_path(path),
+	m_entries(nullptr),
+	m_blocks(0),
+	m_starts(nullptr),
+	m_postings(nullptr)
+{
+	m_file = file_mapping(path.c_str(), read_only);
+	m_region = mapped_region(m_file, read_only);
+	const char* base = static_cast<const char*>(m_region.get_address());
+	uint64_t size = m_region.get_size();
+
+	if(size < sizeof(JournalIndexHeader))
+		BOOST_THROW_EXCEPTION(FormatError() << errinfo_str("Tick journal index is too short: " + path));
+	std::memcpy(&m_header, base, sizeof(m_header));
+	if(m_header.magic != JournalIndexMagic || m_header.version != JournalIndexVersion)
+		BOOST_THROW_EXCEPTION(FormatError() << errinfo_str("Invalid tick journal index header: " + path));
+
+	// A live index may have entries past the header's count, never fewer
+	m_blocks = m_header.blocks;
+	if(sizeof(JournalIndexHeader) + m_blocks * sizeof(JournalIndexEntry) > size)
+		BOOST_THROW_EXCEPTION(FormatError() << errinfo_str("Truncated tick journal index: " + path));
+	m_entries = reinterpret_cast<const JournalIndexEntry*>(base + sizeof(JournalIndexHeader));
+
+	if(m_header.postingsOffset != 0)
+	{
+		uint64_t startsSize = (m_header.instruments + 1) * sizeof(uint64_t);
+		if(m_header.postingsOffset + startsSize > size)
+			BOOST_THROW_EXCEPTION(FormatError() << errinfo_str("Truncated tick journal index: " + path));
+		m_starts = reinterpret_cast<const uint64_t*>(base + m_header.postingsOffset);
+		m_postings = reinterpret_cast<const uint32_t*>(base + m_header.postingsOffset + startsSize);
+		if(m_header.postingsOffset + startsSize + m_starts[m_header.instruments] * sizeof(uint32_t) > size)
+			BOOST_THROW_EXCEPTION(FormatError() << errinfo_str("Truncated tick journal index: " + path));
+		validatePostings();
+	}
+
+	m_suffixMin.resize(m_blocks + 1, ~(uint64_t)0);
+	for(size_t i = m_blocks; i > 0; i--)
+		m_suffixMin[i - 1] = std::min(m_suffixMin[i], m_entries[i - 1].minTimestamp);
+}
+
+JournalIndex::~JournalIndex()
+{
+}
+
+void JournalIndex::validatePostings() const
+{
+	// Checked once here, so that find() can index by postings without checks
+	for(uint32_t instrument = 0; instrument < m_header.instruments; instrument++)
+	{
+		if(m_starts[instrument] > m_starts[instrument + 1])
+			BOOST_THROW_EXCEPTION(FormatError() << errinfo_str("Invalid block list offsets in tick journal index: " + m_path));
+
+		for(uint64_t i = m_starts[instrument]; i < m_starts[instrument + 1]; i++)
+		{
+			if(m_postings[i] >= m_blocks || (i > m_starts[instrument] && m_postings[i] <= m_postings[i - 1]))
+				BOOST_THROW_EXCEPTION(FormatError() << errinfo_str("Invalid block list in tick journal index: " + m_path));
+		}
+	}
+}
+
+uint32_t JournalIndex::day() const
+{
+	return m_header.day;
+}
+
+size_t JournalIndex::blocks() const
+{
+	return m_blocks;
+}
+
+const JournalIndexEntry& JournalIndex::entry(size_t block) const
+{
+	if(block >= m_blocks)
+		BOOST_THROW_EXCEPTION(ParameterError() << errinfo_str("Invalid tick journal block number"));
+	return m_entries[block];
+}
+
+bool JournalIndex::complete() const
+{
+	return m_postings != nullptr;
+}
+
+std::vector<uint32_t> JournalIndex::find(uint32_t instrument, uint64_t from, uint64_t to) const
+{
+	std::vector<uint32_t> result;
+	if(from > to)
+		return result;
+
+	// Running max is non-decreasing: blocks before the first one reaching
+	// 'from' can't have matching ticks
+	uint32_t first = std::partition_point(m_entries, m_entries + m_blocks,
+			[from](const JournalIndexEntry& entry) { return entry.runningMax < from; }) - m_entries;
+
+	if(instrument != NoJournalInstrument && complete())
+	{
+		if(instrument >= m_header.instruments)
+			return result;
+
+		const uint32_t* begin = m_postings + m_starts[instrument];
+		const uint32_t* end = m_postings + m_starts[instrument + 1];
+		for(auto it = std::lower_bound(begin, end, first); it != end && m_suffixMin[*it] <= to; ++it)
+		{
+			if(overlaps(*it, from, to))
+				result.push_back(*it);
+		}
+		return result;
+	}
+
+	uint64_t mask = instrument == NoJournalInstrument ? 0 : (uint64_t)1 << (instrument % 64);
+	size_t word = (instrument % JournalIndexBitmapBits) / 64;
+	for(uint32_t block = first; block < m_blocks && m_suffixMin[block] <= to; block++)
+	{
+		if(mask != 0 && !(m_entries[block].instruments[word] & mask))
+			continue;
+		if(overlaps(block, from, to))
+			result.push_back(block);
+	}
+	return result;
+}
+
+bool JournalIndex::overlaps(uint32_t block, uint64_t from, uint64_t to) const
+{
+	return m_entries[block].minTimestamp <= to && m_entries[block].maxTimestamp >= from;
+}
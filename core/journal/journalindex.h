@@ -0,0 +1,66 @@
+/*
+ * journalindex.h
+ */
+
+#ifndef JOURNAL_JOURNALINDEX_H_
+#define JOURNAL_JOURNALINDEX_H_
+
+#include "core/journal/journalformat.h"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Read-only view of a tick journal index. Block numbers are positions of
+ * ticks blocks in the journal, as in JournalReader.
+ */
+class JournalIndex
+{
+public:
+	typedef std::shared_ptr<JournalIndex> Ptr;
+
+	JournalIndex(const std::string& path);
+	virtual ~JournalIndex();
+
+	uint32_t day() const;
+
+	size_t blocks() const;
+	const JournalIndexEntry& entry(size_t block) const;
+
+	/**
+	 * False while the journal is being written: per-instrument block lists
+	 * are not there yet
+	 */
+	bool complete() const;
+
+	/**
+	 * Blocks which may contain ticks of journal instrument within [from, to]
+	 * (microseconds), ascending. NoJournalInstrument matches any instrument.
+	 * Without block lists instruments are matched by entry bitmaps, which may
+	 * give extra blocks.
+	 */
+	std::vector<uint32_t> find(uint32_t instrument, uint64_t from, uint64_t to) const;
+
+private:
+	void validatePostings() const;
+	bool overlaps(uint32_t block, uint64_t from, uint64_t to) const;
+
+private:
+	std::string m_path;
+	boost::interprocess::file_mapping m_file;
+	boost::interprocess::mapped_region m_region;
+	JournalIndexHeader m_header;
+	const JournalIndexEntry* m_entries;
+	size_t m_blocks;
+	const uint64_t* m_starts;
+	const uint32_t* m_postings;
+
+	// Min timestamp of a block and all following ones, to stop scans early
+	std::vector<uint64_t> m_suffixMin;
+};
+
+#endif /* JOURNAL_JOURNALINDEX_H_ */
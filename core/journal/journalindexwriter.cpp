@@ -0,0 +1,117 @@
+/*
+ * journalindexwriter.cpp
+ */
+
+#include "journalindexwriter.h"
+
+#include "log.h"
+#include "exceptions.h"
+
+#include <algorithm>
+#include <cstring>
+
+JournalIndexWriter::JournalIndexWriter() : m_runningMax(0)
+{
+	std::memset(&m_header, 0, sizeof(m_header));
+}
+
+JournalIndexWriter::~JournalIndexWriter()
+{
+	try
+	{
+		close();
+	}
+	catch(const std::exception& e)
+	{
+		LOG(warning) << "Unable to close tick journal index: " << e.what();
+	}
+}
+
+void JournalIndexWriter::open(const std::string& path, uint32_t day)
+{
+	close();
+
+	m_path = path;
+	m_stream.open(path.c_str(), std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+	if(!m_stream)
+		BOOST_THROW_EXCEPTION(ParameterError() << errinfo_str("Unable to open tick journal index: " + path));
+
+	std::memset(&m_header, 0, sizeof(m_header));
+	m_header.magic = JournalIndexMagic;
+	m_header.version = JournalIndexVersion;
+	m_header.day = day;
+	m_runningMax = 0;
+	m_postings.clear();
+	writeHeader();
+}
+
+void JournalIndexWriter::addBlock(uint64_t offset, const JournalBlockHeader& block, const uint32_t* instruments, size_t count)
+{
+	if(!isOpen())
+		return;
+
+	uint32_t number = m_header.blocks;
+	JournalIndexEntry entry;
+	std::memset(&entry, 0, sizeof(entry));
+	entry.offset = offset;
+	entry.minTimestamp = block.minTimestamp;
+	entry.maxTimestamp = block.maxTimestamp;
+	m_runningMax = std::max(m_runningMax, block.maxTimestamp);
+	entry.runningMax = m_runningMax;
+	entry.count = block.count;
+	for(size_t i = 0; i < count; i++)
+	{
+		uint32_t instrument = instruments[i];
+		entry.instruments[(instrument % JournalIndexBitmapBits) / 64] |= (uint64_t)1 << (instrument % 64);
+
+		if(instrument >= m_postings.size())
+			m_postings.resize(instrument + 1);
+		auto& postings = m_postings[instrument];
+		if(postings.empty() || postings.back() != number)
+			postings.push_back(number);
+	}
+
+	m_stream.seekp(sizeof(JournalIndexHeader) + m_header.blocks * sizeof(JournalIndexEntry));
+	m_stream.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+	m_header.blocks++;
+	writeHeader();
+}
+
+void JournalIndexWriter::close()
+{
+	if(!isOpen())
+		return;
+
+	std::vector<uint64_t> starts(1, 0);
+	for(const auto& postings : m_postings)
+		starts.push_back(starts.back() + postings.size());
+
+	m_header.postingsOffset = sizeof(JournalIndexHeader) + m_header.blocks * sizeof(JournalIndexEntry);
+	m_header.instruments = m_postings.size();
+	m_stream.seekp(m_header.postingsOffset);
+	m_stream.write(reinterpret_cast<const char*>(starts.data()), starts.size() * sizeof(uint64_t));
+	for(const auto& postings : m_postings)
+		m_stream.write(reinterpret_cast<const char*>(postings.data()), postings.size() * sizeof(uint32_t));
+	writeHeader();
+	m_stream.close();
+	m_postings.clear();
+}
+
+bool JournalIndexWriter::isOpen() const
+{
+	return m_stream.is_open();
+}
+
+uint64_t JournalIndexWriter::blocks() const
+{
+	return m_header.blocks;
+}
+
+void JournalIndexWriter::writeHeader()
+{
+	m_stream.seekp(0);
+	m_stream.write(reinterpret_cast<const char*>(&m_header), sizeof(m_header));
+	m_stream.flush();
+	if(!m_stream)
+		BOOST_THROW_EXCEPTION(ParameterError() << errinfo_str("Unable to write tick journal index: " + m_path));
+}
@@ -0,0 +1,53 @@
+/*
+ * journalindexwriter.h
+ */
+
+#ifndef JOURNAL_JOURNALINDEXWRITER_H_
+#define JOURNAL_JOURNALINDEXWRITER_H_
+
+#include "core/journal/journalformat.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * Writes index file of a tick journal (see journalformat.h): an entry per
+ * ticks block as it is written, and per-instrument block lists on close.
+ */
+class JournalIndexWriter
+{
+public:
+	JournalIndexWriter();
+	virtual ~JournalIndexWriter();
+
+	/**
+	 * Creates (or truncates) index file
+	 */
+	void open(const std::string& path, uint32_t day);
+
+	/**
+	 * instruments are journal ids of the block's ticks, duplicates allowed
+	 */
+	void addBlock(uint64_t offset, const JournalBlockHeader& block, const uint32_t* instruments, size_t count);
+
+	/**
+	 * Writes per-instrument block lists and closes the file
+	 */
+	void close();
+
+	bool isOpen() const;
+	uint64_t blocks() const;
+
+private:
+	void writeHeader();
+
+private:
+	std::string m_path;
+	std::fstream m_stream;
+	JournalIndexHeader m_header;
+	uint64_t m_runningMax;
+	std::vector<std::vector<uint32_t>> m_postings;
+};
+
+#endif /* JOURNAL_JOURNALINDEXWRITER_H_ */
@@ -0,0 +1,141 @@
+/*
+ * journalreader.cpp
+ */
+
+#include "journalreader.h"
+
+#include "exceptions.h"
+
+#include <cstring>
+
+using namespace boost::interprocess;
+
+JournalReader::JournalReader(const std::string& path) : m_path(path),
+	m_base(nullptr),
+	m_day(0),
+	m_ticks(0)
+{
+	m_file = file_mapping(path.c_str(), read_only);
+	m_region = mapped_region(m_file, read_only);
+	m_base = static_cast<const char*>(m_region.get_address());
+
+	uint64_t size = m_region.get_size();
+	if(size < sizeof(JournalFileHeader))
+		BOOST_THROW_EXCEPTION(FormatError() << errinfo_str("Tick journal is too short: " + path));
+
+	JournalFileHeader header;
+	std::memcpy(&header, m_base, sizeof(header));
+	if(header.magic != JournalMagic || header.version != JournalVersion || header.dataEnd > size)
+		BOOST_THROW_EXCEPTION(FormatError() << errinfo_str("Invalid tick journal header: " + path));
+	m_day = header.day;
+
+	uint64_t offset = sizeof(JournalFileHeader);
+	while(offset + sizeof(JournalBlockHeader) <= header.dataEnd)
+	{
+		const auto* block = reinterpret_cast<const JournalBlockHeader*>(m_base + offset);
+		const char* payload = m_base + offset + sizeof(JournalBlockHeader);
+		offset += sizeof(JournalBlockHeader) + block->size;
+		if(offset > header.dataEnd)
+			BOOST_THROW_EXCEPTION(FormatError() << errinfo_str("Truncated tick journal block: " + path));
+
+		if(block->type == (uint32_t)JournalBlockType::Instruments)
+		{
+			parseInstruments(payload, payload + block->size);
+		}
+		else if(block->type == (uint32_t)JournalBlockType::Ticks)
+		{
+			if(block->encoding == (uint32_t)JournalEncoding::Raw && JournalRawLayout(block->count).size > block->size)
+				BOOST_THROW_EXCEPTION(FormatError() << errinfo_str("Invalid tick journal block size: " + path));
+			m_blocks.push_back(block);
+			m_ticks += block->count;
+		}
+	}
+}
+
+JournalReader::~JournalReader()
+{
+}
+
+uint32_t JournalReader::day() const
+{
+	return m_day;
+}
+
+size_t JournalReader::blocks() const
+{
+	return m_blocks.size();
+}
+
+const JournalBlockHeader& JournalReader::blockHeader(size_t block) const
+{
+	return *m_blocks.at(block);
+}
+
+void JournalReader::readBlock(size_t block, JournalColumns& columns) const
+{
+	const auto* header = m_blocks.at(block);
+	const char* payload = reinterpret_cast<const char*>(header + 1);
+	if(header->encoding == (uint32_t)JournalEncoding::Packed)
+	{
+		journalDecode(*header, payload, columns);
+		return;
+	}
+	if(header->encoding != (uint32_t)JournalEncoding::Raw)
+		BOOST_THROW_EXCEPTION(FormatError() << errinfo_str("Unsupported tick journal block encoding: " + m_path));
+
+	// Raw columns are aligned and contiguous
+	JournalRawLayout layout(header->count);
+	columns.count = header->count;
+	columns.instruments = reinterpret_cast<const uint32_t*>(payload + layout.instruments);
+	columns.datatypes = reinterpret_cast<const int32_t*>(payload + layout.datatypes);
+	columns.timestamps = reinterpret_cast<const uint64_t*>(payload + layout.timestamps);
+	columns.values = reinterpret_cast<const double*>(payload + layout.values);
+	columns.volumes = reinterpret_cast<const int32_t*>(payload + layout.volumes);
+}
+
+uint64_t JournalReader::blockOffset(size_t block) const
+{
+	return reinterpret_cast<const char*>(m_blocks.at(block)) - m_base;
+}
+
+uint64_t JournalReader::ticks() const
+{
+	return m_ticks;
+}
+
+size_t JournalReader::instruments() const
+{
+	return m_names.size();
+}
+
+const std::string& JournalReader::instrumentName(uint32_t instrument) const
+{
+	return m_names.at(instrument);
+}
+
+uint32_t JournalReader::instrument(const std::string& name) const
+{
+	auto it = m_ids.find(name);
+	if(it == m_ids.end())
+		return NoJournalInstrument;
+	return it->second;
+}
+
+void JournalReader::parseInstruments(const char* payload, const char* end)
+{
+	while(payload + 2 * sizeof(uint32_t) <= end)
+	{
+		uint32_t id, length;
+		std::memcpy(&id, payload, sizeof(id));
+		std::memcpy(&length, payload + sizeof(id), sizeof(length));
+		payload += 2 * sizeof(uint32_t);
+		if(length == 0 || payload + length > end)
+			break;
+
+		if(id >= m_names.size())
+			m_names.resize(id + 1);
+		m_names[id].assign(payload, length);
+		m_ids[m_names[id]] = id;
+		payload += (length + 3) & ~(uint32_t)3;
+	}
+}
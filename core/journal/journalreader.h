@@ -0,0 +1,67 @@
+/*
+ * journalreader.h
+ */
+
+#ifndef JOURNAL_JOURNALREADER_H_
+#define JOURNAL_JOURNALREADER_H_
+
+#include "core/journal/journalformat.h"
+#include "core/journal/journalcodec.h"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Read-only view of a tick journal file. May be opened while the file is
+ * being written; blocks written after opening are not visible.
+ */
+class JournalReader
+{
+public:
+	typedef std::shared_ptr<JournalReader> Ptr;
+
+	JournalReader(const std::string& path);
+	virtual ~JournalReader();
+
+	uint32_t day() const;
+
+	size_t blocks() const;
+	const JournalBlockHeader& blockHeader(size_t block) const;
+	uint64_t blockOffset(size_t block) const;
+
+	/**
+	 * Raw blocks are used in place, packed ones are decoded into columns
+	 */
+	void readBlock(size_t block, JournalColumns& columns) const;
+
+	uint64_t ticks() const;
+
+	size_t instruments() const;
+	const std::string& instrumentName(uint32_t instrument) const;
+
+	/**
+	 * Returns NoJournalInstrument if instrument is not in the file
+	 */
+	uint32_t instrument(const std::string& name) const;
+
+private:
+	void parseInstruments(const char* payload, const char* end);
+
+private:
+	std::string m_path;
+	boost::interprocess::file_mapping m_file;
+	boost::interprocess::mapped_region m_region;
+	const char* m_base;
+	uint32_t m_day;
+	uint64_t m_ticks;
+	std::vector<const JournalBlockHeader*> m_blocks;
+	std::vector<std::string> m_names;
+	std::unordered_map<std::string, uint32_t> m_ids;
+};
+
+#endif /* JOURNAL_JOURNALREADER_H_ */
@@ -0,0 +1,396 @@
+/*
+ * tickjournal.cpp
+ */
+
+#include "tickjournal.h"
+
+#include "core/gatewayclock.h"
+#include "core/instrumentmetadata.h"
+
+#include "log.h"
+#include "exceptions.h"
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+using namespace boost::interprocess;
+
+static const uint64_t gs_microsecondsPerDay = 86400ULL * 1000000;
+
+TickJournal::TickJournal(const std::string& directory, size_t blockCapacity, uint64_t segmentSize, int flushIntervalMs,
+		JournalEncoding encoding) :
+	m_directory(directory),
+	m_blockCapacity(blockCapacity),
+	m_segmentSize(segmentSize),
+	m_flushInterval((uint64_t)flushIntervalMs * 1000),
+	m_encoding(encoding),
+	m_day(0),
+	m_dayStart(0),
+	m_dayEnd(0),
+	m_base(nullptr),
+	m_fileSize(0),
+	m_dataEnd(0),
+	m_nextJournalId(0),
+	m_blockStarted(0),
+	m_ticks(0),
+	m_stop(false)
+{
+	if(m_blockCapacity == 0 || m_segmentSize < sizeof(JournalFileHeader) + sizeof(JournalBlockHeader))
+		BOOST_THROW_EXCEPTION(ParameterError() << errinfo_str("Invalid tick journal block capacity or segment size"));
+
+	boost::filesystem::create_directories(m_directory);
+
+	m_steps = [this](uint32_t journalId)
+		{
+			return journalStep(InstrumentMetadata::instance().priceStep(m_instrumentsByJournalId[journalId]));
+		};
+
+	m_instruments.reserve(m_blockCapacity);
+	m_datatypes.reserve(m_blockCapacity);
+	m_timestamps.reserve(m_blockCapacity);
+	m_values.reserve(m_blockCapacity);
+	m_volumes.reserve(m_blockCapacity);
+
+	m_flusher = boost::thread(std::bind(&TickJournal::flusherLoop, this));
+}
+
+TickJournal::~TickJournal()
+{
+	{
+		boost::unique_lock<boost::mutex> lock(m_flusherMutex);
+		m_stop = true;
+	}
+	m_flusherCondition.notify_all();
+	m_flusher.join();
+
+	try
+	{
+		close();
+	}
+	catch(const std::exception& e)
+	{
+		LOG(warning) << "Unable to close tick journal: " << e.what();
+	}
+}
+
+void TickJournal::consume(const TickUpdate* updates, size_t count)
+{
+	for(size_t i = 0; i < count; i++)
+	{
+		const auto& tick = updates[i].tick;
+		uint64_t timestamp = (uint64_t)tick.timestamp * 1000000 + tick.useconds;
+		if(timestamp >= m_dayEnd && startsDay(timestamp))
+			openDay(timestamp);
+
+		if(m_timestamps.empty())
+			m_blockStarted = GatewayClock::systemMicroseconds();
+
+		m_instruments.push_back(journalInstrument(updates[i].instrument));
+		m_datatypes.push_back(tick.datatype);
+		m_timestamps.push_back(timestamp);
+		m_values.push_back(tick.value.toDouble());
+		m_volumes.push_back(tick.volume);
+
+		if(m_timestamps.size() == m_blockCapacity)
+			sealBlock();
+	}
+	m_ticks.fetch_add(count, std::memory_order_relaxed);
+}
+
+void TickJournal::idle()
+{
+	if(!m_timestamps.empty() && GatewayClock::systemMicroseconds() - m_blockStarted >= m_flushInterval)
+		sealBlock();
+}
+
+void TickJournal::sealBlock()
+{
+	if(m_timestamps.empty())
+		return;
+
+	// Instruments should be defined before the block which refers to them
+	if(!m_newInstruments.empty())
+		writeInstruments();
+
+	size_t count = m_timestamps.size();
+	if(m_encoding == JournalEncoding::Packed)
+	{
+		char* payload = reserve(JournalEncoder::maxSize(count));
+		size_t size = m_encoder.encode(m_instruments.data(), m_datatypes.data(), m_timestamps.data(), m_values.data(),
+				m_volumes.data(), count, m_steps, payload);
+		indexBlock(commit(JournalBlockType::Ticks, m_encoding, count, size, m_timestamps.data()));
+	}
+	else
+	{
+		JournalRawLayout layout(count);
+		char* payload = reserve(layout.size);
+		std::memcpy(payload + layout.instruments, m_instruments.data(), count * sizeof(uint32_t));
+		std::memcpy(payload + layout.datatypes, m_datatypes.data(), count * sizeof(int32_t));
+		std::memcpy(payload + layout.timestamps, m_timestamps.data(), count * sizeof(uint64_t));
+		std::memcpy(payload + layout.values, m_values.data(), count * sizeof(double));
+		std::memcpy(payload + layout.volumes, m_volumes.data(), count * sizeof(int32_t));
+		indexBlock(commit(JournalBlockType::Ticks, m_encoding, count, layout.size, m_timestamps.data()));
+	}
+
+	m_instruments.clear();
+	m_datatypes.clear();
+	m_timestamps.clear();
+	m_values.clear();
+	m_volumes.clear();
+}
+
+void TickJournal::flush()
+{
+	boost::unique_lock<boost::mutex> lock(m_mapMutex);
+	if(m_base)
+		m_region.flush(0, 0, false);
+}
+
+void TickJournal::close()
+{
+	if(!m_base)
+		return;
+
+	sealBlock();
+	m_index.close();
+	flush();
+	{
+		boost::unique_lock<boost::mutex> lock(m_mapMutex);
+		m_region = mapped_region();
+		m_file = file_mapping();
+		m_base = nullptr;
+	}
+	boost::filesystem::resize_file(m_path, m_dataEnd);
+	LOG(info) << "Closed tick journal: " << m_path << ", " << m_dataEnd << " bytes";
+
+	m_day = 0;
+	m_dayStart = m_dayEnd = 0;
+	m_journalIds.clear();
+	m_instrumentsByJournalId.clear();
+	m_newInstruments.clear();
+	m_nextJournalId = 0;
+}
+
+uint32_t TickJournal::day() const
+{
+	return m_day;
+}
+
+uint64_t TickJournal::ticks() const
+{
+	return m_ticks.load(std::memory_order_relaxed);
+}
+
+bool TickJournal::startsDay(uint64_t timestamp) const
+{
+	// A tick stamped more than a day ahead of the wall clock is most likely
+	// garbage; don't let it move the journal away from the current day
+	return !m_base || timestamp < GatewayClock::systemMicroseconds() + gs_microsecondsPerDay;
+}
+
+void TickJournal::openDay(uint64_t timestamp)
+{
+	close();
+
+	m_day = journalDay(timestamp);
+	m_dayStart = timestamp - timestamp % gs_microsecondsPerDay;
+	m_dayEnd = m_dayStart + gs_microsecondsPerDay;
+	m_path = journalFileName(m_directory, m_day);
+
+	uint64_t existing = boost::filesystem::exists(m_path) ? boost::filesystem::file_size(m_path) : 0;
+	if(existing >= sizeof(JournalFileHeader))
+	{
+		resize(existing);
+		const auto* h = header();
+		if(h->magic == JournalMagic && h->version == JournalVersion && h->day == m_day &&
+				h->dataEnd >= sizeof(JournalFileHeader) && h->dataEnd <= existing)
+		{
+			m_dataEnd = h->dataEnd;
+			m_index.open(journalIndexFileName(m_path), m_day);
+			loadBlocks();
+			LOG(info) << "Appending to tick journal: " << m_path << ", " << m_dataEnd << " bytes";
+			return;
+		}
+
+		LOG(warning) << "Invalid tick journal, moving aside: " << m_path;
+		{
+			boost::unique_lock<boost::mutex> lock(m_mapMutex);
+			m_region = mapped_region();
+			m_file = file_mapping();
+			m_base = nullptr;
+		}
+		boost::filesystem::rename(m_path, m_path + ".invalid");
+	}
+
+	std::ofstream(m_path.c_str(), std::ios::binary | std::ios::out | std::ios::trunc);
+	m_fileSize = 0;
+	resize(m_segmentSize);
+	auto* h = header();
+	std::memset(h, 0, sizeof(JournalFileHeader));
+	h->magic = JournalMagic;
+	h->version = JournalVersion;
+	h->day = m_day;
+	m_dataEnd = sizeof(JournalFileHeader);
+	h->dataEnd = m_dataEnd;
+	m_index.open(journalIndexFileName(m_path), m_day);
+	LOG(info) << "Created tick journal: " << m_path;
+}
+
+void TickJournal::loadBlocks()
+{
+	auto& registry = InstrumentRegistry::instance();
+	uint64_t offset = sizeof(JournalFileHeader);
+	while(offset + sizeof(JournalBlockHeader) <= m_dataEnd)
+	{
+		const auto* block = reinterpret_cast<const JournalBlockHeader*>(m_base + offset);
+		const char* payload = m_base + offset + sizeof(JournalBlockHeader);
+		const char* end = payload + block->size;
+		if(block->type == (uint32_t)JournalBlockType::Instruments)
+		{
+			while(payload + 2 * sizeof(uint32_t) <= end)
+			{
+				uint32_t id, length;
+				std::memcpy(&id, payload, sizeof(id));
+				std::memcpy(&length, payload + sizeof(id), sizeof(length));
+				payload += 2 * sizeof(uint32_t);
+				if(length == 0 || payload + length > end)
+					break;
+
+				auto instrument = registry.id(std::string(payload, length));
+				if(instrument >= m_journalIds.size())
+					m_journalIds.resize(instrument + 1, 0);
+				m_journalIds[instrument] = id + 1;
+				if(id >= m_instrumentsByJournalId.size())
+					m_instrumentsByJournalId.resize(id + 1, NoInstrument);
+				m_instrumentsByJournalId[id] = instrument;
+				m_nextJournalId = std::max(m_nextJournalId, id + 1);
+				payload += (length + 3) & ~(uint32_t)3;
+			}
+		}
+		else if(block->type == (uint32_t)JournalBlockType::Ticks)
+		{
+			indexBlock(block);
+		}
+		offset += sizeof(JournalBlockHeader) + block->size;
+	}
+}
+
+uint32_t TickJournal::journalInstrument(InstrumentId instrument)
+{
+	if(instrument < m_journalIds.size() && m_journalIds[instrument] != 0)
+		return m_journalIds[instrument] - 1;
+
+	if(instrument >= m_journalIds.size())
+		m_journalIds.resize(instrument + 1, 0);
+	uint32_t id = m_nextJournalId++;
+	m_journalIds[instrument] = id + 1;
+	m_instrumentsByJournalId.resize(m_nextJournalId, NoInstrument);
+	m_instrumentsByJournalId[id] = instrument;
+	m_newInstruments.push_back(std::make_pair(id, instrument));
+	return id;
+}
+
+void TickJournal::writeInstruments()
+{
+	const auto& registry = InstrumentRegistry::instance();
+	size_t size = 0;
+	for(const auto& entry : m_newInstruments)
+		size += 2 * sizeof(uint32_t) + ((registry.name(entry.second).size() + 3) & ~(size_t)3);
+	size = journalAlign(size);
+
+	char* payload = reserve(size);
+	std::memset(payload, 0, size);
+	for(const auto& entry : m_newInstruments)
+	{
+		const auto& name = registry.name(entry.second);
+		uint32_t length = name.size();
+		std::memcpy(payload, &entry.first, sizeof(uint32_t));
+		std::memcpy(payload + sizeof(uint32_t), &length, sizeof(uint32_t));
+		std::memcpy(payload + 2 * sizeof(uint32_t), name.data(), length);
+		payload += 2 * sizeof(uint32_t) + ((length + 3) & ~(uint32_t)3);
+	}
+	commit(JournalBlockType::Instruments, JournalEncoding::Raw, m_newInstruments.size(), size, nullptr);
+	m_newInstruments.clear();
+}
+
+char* TickJournal::reserve(size_t payloadSize)
+{
+	uint64_t end = m_dataEnd + sizeof(JournalBlockHeader) + payloadSize;
+	if(end > m_fileSize)
+		resize((end + m_segmentSize - 1) / m_segmentSize * m_segmentSize);
+	return m_base + m_dataEnd + sizeof(JournalBlockHeader);
+}
+
+const JournalBlockHeader* TickJournal::commit(JournalBlockType type, JournalEncoding encoding, uint32_t count, uint32_t size,
+		const uint64_t* timestamps)
+{
+	auto* block = reinterpret_cast<JournalBlockHeader*>(m_base + m_dataEnd);
+	std::memset(block, 0, sizeof(JournalBlockHeader));
+	block->type = (uint32_t)type;
+	block->encoding = (uint32_t)encoding;
+	block->count = count;
+	block->size = size;
+	if(timestamps && count > 0)
+	{
+		block->firstTimestamp = timestamps[0];
+		block->lastTimestamp = timestamps[count - 1];
+		block->minTimestamp = *std::min_element(timestamps, timestamps + count);
+		block->maxTimestamp = *std::max_element(timestamps, timestamps + count);
+	}
+	m_dataEnd += sizeof(JournalBlockHeader) + size;
+
+	// Readers of a live file trust dataEnd, so the block should land first
+	std::atomic_thread_fence(std::memory_order_release);
+	header()->dataEnd = m_dataEnd;
+	return block;
+}
+
+void TickJournal::indexBlock(const JournalBlockHeader* block)
+{
+	journalBlockInstruments(*block, reinterpret_cast<const char*>(block + 1), m_blockInstruments);
+	m_index.addBlock(reinterpret_cast<const char*>(block) - m_base, *block, m_blockInstruments.data(),
+			m_blockInstruments.size());
+}
+
+void TickJournal::resize(uint64_t size)
+{
+	boost::unique_lock<boost::mutex> lock(m_mapMutex);
+	m_region = mapped_region();
+	m_file = file_mapping();
+	if(boost::filesystem::file_size(m_path) != size)
+		boost::filesystem::resize_file(m_path, size);
+	m_file = file_mapping(m_path.c_str(), read_write);
+	m_region = mapped_region(m_file, read_write, 0, size);
+	m_base = static_cast<char*>(m_region.get_address());
+	m_fileSize = size;
+}
+
+JournalFileHeader* TickJournal::header()
+{
+	return reinterpret_cast<JournalFileHeader*>(m_base);
+}
+
+void TickJournal::flusherLoop()
+{
+	boost::unique_lock<boost::mutex> lock(m_flusherMutex);
+	while(!m_stop)
+	{
+		m_flusherCondition.wait_for(lock, boost::chrono::microseconds(m_flushInterval));
+		if(m_stop)
+			break;
+
+		lock.unlock();
+		try
+		{
+			flush();
+		}
+		catch(const std::exception& e)
+		{
+			LOG(warning) << "Unable to flush tick journal: " << e.what();
+		}
+		lock.lock();
+	}
+}
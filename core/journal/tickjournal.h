@@ -0,0 +1,128 @@
+/*
+ * tickjournal.h
+ */
+
+#ifndef JOURNAL_TICKJOURNAL_H_
+#define JOURNAL_TICKJOURNAL_H_
+
+#include "core/sinks/ticksink.h"
+#include "core/journal/journalformat.h"
+#include "core/journal/journalcodec.h"
+#include "core/journal/journalindexwriter.h"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/thread.hpp>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Records the tick stream to daily columnar files (see journalformat.h).
+ *
+ * Ticks are appended to in-memory columns; a block is encoded and written to
+ * the file when it is full or when it is older than flush interval. Packed
+ * blocks store values in units of instrument's price step (InstrumentMetadata)
+ * as of the moment the block is written. Files are memory-mapped
+ * and preallocated in segments, so writing a block is a plain memcpy; a
+ * background thread syncs written data to disk every flush interval. Day of a
+ * tick is taken from its timestamp (UTC); an existing file of the day is
+ * appended to. The journal only moves forward: ticks of earlier days (late or
+ * replayed trades) go to the current file, so interleaved days don't reopen
+ * files. Index file is written along with the journal and rebuilt from
+ * it when an existing file is reopened.
+ *
+ * All methods except flush() should be called from one thread.
+ */
+class TickJournal : public TickSink
+{
+public:
+	typedef std::shared_ptr<TickJournal> Ptr;
+
+	TickJournal(const std::string& directory, size_t blockCapacity = 4096, uint64_t segmentSize = 64 << 20,
+			int flushIntervalMs = 1000, JournalEncoding encoding = JournalEncoding::Packed);
+	virtual ~TickJournal();
+
+	virtual void consume(const TickUpdate* updates, size_t count) override;
+	virtual void idle() override;
+
+	/**
+	 * Writes pending ticks as a (possibly short) block
+	 */
+	void sealBlock();
+
+	/**
+	 * Syncs written blocks to disk
+	 */
+	void flush();
+
+	/**
+	 * Seals pending block and truncates current file to its data
+	 */
+	void close();
+
+	uint32_t day() const;
+	uint64_t ticks() const;
+
+private:
+	bool startsDay(uint64_t timestamp) const;
+	void openDay(uint64_t timestamp);
+	void loadBlocks();
+	uint32_t journalInstrument(InstrumentId instrument);
+	void writeInstruments();
+	char* reserve(size_t payloadSize);
+	const JournalBlockHeader* commit(JournalBlockType type, JournalEncoding encoding, uint32_t count, uint32_t size,
+			const uint64_t* timestamps);
+	void indexBlock(const JournalBlockHeader* block);
+	void resize(uint64_t size);
+	JournalFileHeader* header();
+
+	void flusherLoop();
+
+private:
+	std::string m_directory;
+	size_t m_blockCapacity;
+	uint64_t m_segmentSize;
+	uint64_t m_flushInterval;
+	JournalEncoding m_encoding;
+	JournalEncoder m_encoder;
+	JournalStepLookup m_steps;
+
+	// Current file; m_mapMutex guards remapping against flusher thread
+	std::string m_path;
+	uint32_t m_day;
+	uint64_t m_dayStart;
+	uint64_t m_dayEnd;
+	boost::interprocess::file_mapping m_file;
+	boost::interprocess::mapped_region m_region;
+	char* m_base;
+	uint64_t m_fileSize;
+	uint64_t m_dataEnd;
+	boost::mutex m_mapMutex;
+	JournalIndexWriter m_index;
+	std::vector<uint32_t> m_blockInstruments;
+
+	// Journal instrument id + 1 by InstrumentId, 0 if not defined in current file
+	std::vector<uint32_t> m_journalIds;
+	uint32_t m_nextJournalId;
+	std::vector<InstrumentId> m_instrumentsByJournalId;
+	std::vector<std::pair<uint32_t, InstrumentId>> m_newInstruments;
+
+	// Pending block
+	uint64_t m_blockStarted;
+	std::vector<uint32_t> m_instruments;
+	std::vector<int32_t> m_datatypes;
+	std::vector<uint64_t> m_timestamps;
+	std::vector<double> m_values;
+	std::vector<int32_t> m_volumes;
+	std::atomic<uint64_t> m_ticks;
+
+	boost::thread m_flusher;
+	boost::mutex m_flusherMutex;
+	boost::condition_variable m_flusherCondition;
+	bool m_stop;
+};
+
+#endif /* JOURNAL_TICKJOURNAL_H_ */
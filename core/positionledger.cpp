@@ -0,0 +1,87 @@
+/*
+ * positionledger.cpp
+ */
+
+#include "positionledger.h"
+
+PositionLedger::PositionLedger()
+{
+}
+
+PositionLedger::~PositionLedger()
+{
+}
+
+AccountId PositionLedger::account(const std::string& name)
+{
+	boost::unique_lock<boost::mutex> lock(m_mutex);
+	auto it = m_accountIds.find(name);
+	if(it != m_accountIds.end())
+		return it->second;
+
+	AccountId id = m_accounts.size();
+	m_accounts.push_back(name);
+	m_accountIds.insert(std::make_pair(name, id));
+	return id;
+}
+
+void PositionLedger::updatePositions(const PositionUpdate* updates, size_t count)
+{
+	boost::unique_lock<boost::mutex> lock(m_mutex);
+	for(size_t i = 0; i < count; i++)
+	{
+		const auto& update = updates[i];
+		auto result = m_index.insert(std::make_pair(makeKey(update.account, update.instrument), m_entries.size()));
+		if(result.second)
+			m_entries.push_back(Entry { update.account, update.instrument, update.amount });
+		else
+			m_entries[result.first->second].amount = update.amount;
+	}
+}
+
+void PositionLedger::updateLimits(AccountId account, const AccountLimits& limits)
+{
+	boost::unique_lock<boost::mutex> lock(m_mutex);
+	m_limits[account] = limits;
+}
+
+int PositionLedger::position(AccountId account, InstrumentId instrument)
+{
+	boost::unique_lock<boost::mutex> lock(m_mutex);
+	auto it = m_index.find(makeKey(account, instrument));
+	if(it == m_index.end())
+		return 0;
+	return m_entries[it->second].amount;
+}
+
+bool PositionLedger::limits(AccountId account, AccountLimits& limits)
+{
+	boost::unique_lock<boost::mutex> lock(m_mutex);
+	auto it = m_limits.find(account);
+	if(it == m_limits.end())
+		return false;
+	limits = it->second;
+	return true;
+}
+
+std::list<goldmine::Position> PositionLedger::positions(const std::list<std::string>& accounts)
+{
+	std::list<goldmine::Position> result;
+	const auto& registry = InstrumentRegistry::instance();
+
+	boost::unique_lock<boost::mutex> lock(m_mutex);
+	std::vector<bool> selected(m_accounts.size(), false);
+	for(const auto& name : accounts)
+	{
+		auto it = m_accountIds.find(name);
+		if(it != m_accountIds.end())
+			selected[it->second] = true;
+	}
+
+	for(const auto& entry : m_entries)
+	{
+		if(entry.amount != 0 && selected[entry.account])
+			result.push_back(goldmine::Position { registry.name(entry.instrument), entry.amount });
+	}
+	return result;
+}
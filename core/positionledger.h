@@ -0,0 +1,86 @@
+/*
+ * positionledger.h
+ */
+
+#ifndef CORE_POSITIONLEDGER_H_
+#define CORE_POSITIONLEDGER_H_
+
+#include "broker/broker.h"
+#include "core/instrumentregistry.h"
+
+#include <boost/thread.hpp>
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+typedef uint32_t AccountId;
+
+struct PositionUpdate
+{
+	AccountId account;
+	InstrumentId instrument;
+	int amount;
+};
+
+struct AccountLimits
+{
+	double limit;
+	double used;
+	double planned;
+	double variationMargin;
+};
+
+/**
+ * Positions and limits of trading accounts as reported by QUIK tables.
+ * Parsers push changed rows, brokers read the whole book; both sides touch
+ * the ledger under one short lock. Accounts are interned to small ids so
+ * the per-row key is a single integer.
+ */
+class PositionLedger
+{
+public:
+	typedef std::shared_ptr<PositionLedger> Ptr;
+
+	PositionLedger();
+	virtual ~PositionLedger();
+
+	AccountId account(const std::string& name);
+
+	void updatePositions(const PositionUpdate* updates, size_t count);
+	void updateLimits(AccountId account, const AccountLimits& limits);
+
+	int position(AccountId account, InstrumentId instrument);
+	bool limits(AccountId account, AccountLimits& limits);
+
+	/**
+	 * Non-zero positions of given accounts
+	 */
+	std::list<goldmine::Position> positions(const std::list<std::string>& accounts);
+
+private:
+	typedef uint64_t Key;
+
+	struct Entry
+	{
+		AccountId account;
+		InstrumentId instrument;
+		int amount;
+	};
+
+	static Key makeKey(AccountId account, InstrumentId instrument)
+	{
+		return ((uint64_t)account << 32) | instrument;
+	}
+
+	std::vector<std::string> m_accounts;
+	std::unordered_map<std::string, AccountId> m_accountIds;
+	std::vector<Entry> m_entries;
+	std::unordered_map<Key, size_t> m_index;
+	std::unordered_map<AccountId, AccountLimits> m_limits;
+	boost::mutex m_mutex;
+};
+
+#endif /* CORE_POSITIONLEDGER_H_ */
@@ -0,0 +1,260 @@
+/*
+ * black76.cpp
+ */
+
+#include "black76.h"
+
+#include <cmath>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+static const double gs_minVolatility = 1e-4;
+static const double gs_maxVolatility = 5.0;
+static const double gs_priceTolerance = 1e-6;
+static const double gs_invSqrt2Pi = 0.39894228040143267794;
+static const double gs_sqrt2Pi = 2.50662827463100050242;
+static const double gs_ln2 = 0.69314718055994530942;
+static const double gs_ln2Hi = 6.93147180369123816490e-01;
+static const double gs_ln2Lo = 1.90821492927058770002e-10;
+static const double gs_log2e = 1.44269504088896340736;
+// Adding 1.5 * 2^52 rounds a double to an integer and leaves that integer
+// in the low mantissa bits
+static const double gs_roundShift = 6755399441055744.0;
+static const double gs_exponentShift = 4503599627370496.0 + 1023;
+
+// libm calls and branches keep GCC from vectorizing the solver loops, so the
+// loops use the inline polynomial approximations below. They are built from
+// arithmetic, bit operations and selects only and are accurate to a few ulp
+// (normCdf to ~1e-8 relative in the far left tail).
+
+static inline double fromBits(uint64_t bits)
+{
+	double result;
+	std::memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+
+static inline uint64_t toBits(double x)
+{
+	uint64_t result;
+	std::memcpy(&result, &x, sizeof(result));
+	return result;
+}
+
+static inline double fastExp(double x)
+{
+	x = x < -708.0 ? -708.0 : x;
+	x = x > 708.0 ? 708.0 : x;
+	// x = k * ln2 + r, |r| <= ln2 / 2; exp(x) = 2^k * exp(r)
+	double shifted = x * gs_log2e + gs_roundShift;
+	double k = shifted - gs_roundShift;
+	double r = x - k * gs_ln2Hi - k * gs_ln2Lo;
+	double p = 1.0 / 479001600;
+	p = p * r + 1.0 / 39916800;
+	p = p * r + 1.0 / 3628800;
+	p = p * r + 1.0 / 362880;
+	p = p * r + 1.0 / 40320;
+	p = p * r + 1.0 / 5040;
+	p = p * r + 1.0 / 720;
+	p = p * r + 1.0 / 120;
+	p = p * r + 1.0 / 24;
+	p = p * r + 1.0 / 6;
+	p = p * r + 0.5;
+	p = p * r + 1.0;
+	p = p * r + 1.0;
+	return p * fromBits((toBits(shifted) + 1023) << 52);
+}
+
+// Positive normal arguments only
+static inline double fastLog(double x)
+{
+	uint64_t bits = toBits(x);
+	double exponent = fromBits((bits >> 52) | 0x4330000000000000ULL) - gs_exponentShift;
+	double m = fromBits((bits & 0x000FFFFFFFFFFFFFULL) | 0x3FF0000000000000ULL);
+	// Keep the mantissa within [sqrt(1/2), sqrt(2)] for the series to converge fast
+	bool high = m > 1.41421356237309504880;
+	m = high ? 0.5 * m : m;
+	exponent = high ? exponent + 1 : exponent;
+	// log(m) = 2 * atanh(s)
+	double s = (m - 1) / (m + 1);
+	double z = s * s;
+	double p = 2.0 / 21;
+	p = p * z + 2.0 / 19;
+	p = p * z + 2.0 / 17;
+	p = p * z + 2.0 / 15;
+	p = p * z + 2.0 / 13;
+	p = p * z + 2.0 / 11;
+	p = p * z + 2.0 / 9;
+	p = p * z + 2.0 / 7;
+	p = p * z + 2.0 / 5;
+	p = p * z + 2.0 / 3;
+	p = p * z + 2.0;
+	return s * p + exponent * gs_ln2;
+}
+
+// Hart's double precision algorithm (as given by West, 2005): a rational
+// approximation near the center and a continued fraction in the tails
+static inline double normCdf(double x)
+{
+	double a = std::fabs(x);
+	double e = fastExp(-0.5 * a * a);
+
+	double num = 3.52624965998911e-02 * a + 0.700383064443688;
+	num = num * a + 6.37396220353165;
+	num = num * a + 33.912866078383;
+	num = num * a + 112.079291497871;
+	num = num * a + 221.213596169931;
+	num = num * a + 220.206867912376;
+	double den = 8.83883476483184e-02 * a + 1.75566716318264;
+	den = den * a + 16.064177579207;
+	den = den * a + 86.7807322029461;
+	den = den * a + 296.564248779674;
+	den = den * a + 637.333633378831;
+	den = den * a + 793.826512519948;
+	den = den * a + 440.413735824752;
+
+	double fraction = a + 0.65;
+	fraction = a + 4 / fraction;
+	fraction = a + 3 / fraction;
+	fraction = a + 2 / fraction;
+	fraction = a + 1 / fraction;
+
+	double tail = a < 7.07106781186547 ? e * num / den : e / (fraction * gs_sqrt2Pi);
+	return x > 0 ? 1 - tail : tail;
+}
+
+static inline double normPdf(double x)
+{
+	return gs_invSqrt2Pi * fastExp(-0.5 * x * x);
+}
+
+static inline double clamp(double x, double low, double high)
+{
+	x = x < low ? low : x;
+	return x > high ? high : x;
+}
+
+void OptionBatch::clear()
+{
+	for(auto v : { &forward, &strike, &time, &premium, &side, &volatility, &delta, &gamma, &vega })
+		v->clear();
+	valid.clear();
+}
+
+void OptionBatch::add(double forward, double strike, double time, double premium, double side)
+{
+	this->forward.push_back(forward);
+	this->strike.push_back(strike);
+	this->time.push_back(time);
+	this->premium.push_back(premium);
+	this->side.push_back(side);
+}
+
+Black76::Black76(double rate, int iterations) : m_rate(rate), m_iterations(iterations)
+{
+}
+
+double Black76::price(double forward, double strike, double time, double volatility, double side, double discount)
+{
+	double stddev = volatility * std::sqrt(time);
+	double d1 = (fastLog(forward / strike) + 0.5 * stddev * stddev) / stddev;
+	double d2 = d1 - stddev;
+	return discount * side * (forward * normCdf(side * d1) - strike * normCdf(side * d2));
+}
+
+void Black76::solve(OptionBatch& batch)
+{
+	const size_t n = batch.size();
+	for(auto v : { &batch.volatility, &batch.delta, &batch.gamma, &batch.vega })
+		v->resize(n);
+	batch.valid.resize(n);
+
+	const double* __restrict forward = batch.forward.data();
+	const double* __restrict strike = batch.strike.data();
+	const double* __restrict time = batch.time.data();
+	const double* __restrict premium = batch.premium.data();
+	const double* __restrict side = batch.side.data();
+	double* __restrict sigma = batch.volatility.data();
+	double* __restrict delta = batch.delta.data();
+	double* __restrict gamma = batch.gamma.data();
+	double* __restrict vega = batch.vega.data();
+	uint8_t* __restrict valid = batch.valid.data();
+
+	const double rate = m_rate;
+	// Intermediate arrays. Batch arrays never overlap, but GCC does not
+	// carry restrict through to the loops below and gives up on runtime
+	// alias checks, so each loop is marked with ivdep
+	m_buffer.resize(4 * n);
+	double* __restrict discount = m_buffer.data();
+	double* __restrict sqrtTime = discount + n;
+	double* __restrict logMoneyness = sqrtTime + n;
+	double* __restrict error = logMoneyness + n;
+#pragma GCC ivdep
+	for(size_t i = 0; i < n; i++)
+	{
+		discount[i] = fastExp(-rate * time[i]);
+		sqrtTime[i] = std::sqrt(time[i]);
+		logMoneyness[i] = fastLog(forward[i] / strike[i]);
+		// Manaster-Koehler start (vega inflection point) makes Newton converge
+		// monotonically; near the money it degenerates, so Brenner-Subrahmanyam
+		// ATM approximation is used as a floor
+		double inflection = std::sqrt(2 * std::fabs(logMoneyness[i]) / time[i]);
+		double atm = gs_sqrt2Pi * premium[i] / (discount[i] * forward[i] * sqrtTime[i]);
+		sigma[i] = clamp(inflection > atm ? inflection : atm, gs_minVolatility, gs_maxVolatility);
+	}
+
+	// Fixed number of Newton steps for all options keeps the loop body
+	// branch-free; converged options just stay in place
+	for(int iteration = 0; iteration < m_iterations; iteration++)
+	{
+#pragma GCC ivdep
+		for(size_t i = 0; i < n; i++)
+		{
+			double stddev = sigma[i] * sqrtTime[i];
+			double d1 = (logMoneyness[i] + 0.5 * stddev * stddev) / stddev;
+			double d2 = d1 - stddev;
+			double model = discount[i] * side[i] * (forward[i] * normCdf(side[i] * d1) - strike[i] * normCdf(side[i] * d2));
+			double v = discount[i] * forward[i] * normPdf(d1) * sqrtTime[i];
+			double step = (model - premium[i]) / (v > 1e-12 ? v : 1e-12);
+			sigma[i] = clamp(sigma[i] - step, gs_minVolatility, gs_maxVolatility);
+		}
+	}
+
+#pragma GCC ivdep
+	for(size_t i = 0; i < n; i++)
+	{
+		double stddev = sigma[i] * sqrtTime[i];
+		double d1 = (logMoneyness[i] + 0.5 * stddev * stddev) / stddev;
+		double d2 = d1 - stddev;
+		double pdf = normPdf(d1);
+		double cdf = normCdf(side[i] * d1);
+		double model = discount[i] * side[i] * (forward[i] * cdf - strike[i] * normCdf(side[i] * d2));
+
+		error[i] = std::fabs(model - premium[i]) - gs_priceTolerance * (premium[i] > 1 ? premium[i] : 1);
+		delta[i] = discount[i] * side[i] * cdf;
+		gamma[i] = discount[i] * pdf / (forward[i] * stddev);
+		// Vega per 1% volatility move, as quoted by QUIK
+		vega[i] = 0.01 * discount[i] * forward[i] * pdf * sqrtTime[i];
+	}
+
+	// 0 * x is 0 for finite x and NaN otherwise, so a single comparison also
+	// rejects non-finite greeks. GCC can't narrow double comparison masks to
+	// bytes with SSE2, so this loop packs them with movemask explicitly
+	size_t i = 0;
+#ifdef __SSE2__
+	const __m128d zero = _mm_setzero_pd();
+	for(; i + 2 <= n; i += 2)
+	{
+		__m128d greeks = _mm_add_pd(_mm_add_pd(_mm_loadu_pd(delta + i), _mm_loadu_pd(gamma + i)), _mm_loadu_pd(vega + i));
+		__m128d checked = _mm_add_pd(_mm_loadu_pd(error + i), _mm_mul_pd(zero, greeks));
+		int mask = _mm_movemask_pd(_mm_cmple_pd(checked, zero));
+		valid[i] = mask & 1;
+		valid[i + 1] = mask >> 1;
+	}
+#endif
+	for(; i < n; i++)
+		valid[i] = error[i] + 0 * (delta[i] + gamma[i] + vega[i]) <= 0;
+}
@@ -0,0 +1,63 @@
+/*
+ * black76.h
+ */
+
+#ifndef PRICING_BLACK76_H_
+#define PRICING_BLACK76_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Options of one board in structure-of-arrays layout. Inputs are forward
+ * (underlying futures price), strike, time to expiry in years, option premium
+ * and side (1 for call, -1 for put). Outputs are filled by solve().
+ */
+struct OptionBatch
+{
+	void clear();
+	void add(double forward, double strike, double time, double premium, double side);
+	size_t size() const
+	{
+		return forward.size();
+	}
+
+	std::vector<double> forward;
+	std::vector<double> strike;
+	std::vector<double> time;
+	std::vector<double> premium;
+	std::vector<double> side;
+
+	std::vector<double> volatility;
+	std::vector<double> delta;
+	std::vector<double> gamma;
+	std::vector<double> vega;
+	std::vector<uint8_t> valid;
+};
+
+/**
+ * Batched Black-76 implied volatility solver. Newton iterations run for the
+ * whole batch at once: every loop is branch-free over contiguous arrays and
+ * uses inline polynomial exp/log/normal CDF instead of libm, so GCC vectorizes
+ * them (black76.cpp is built with -O3 and without errno/trapping semantics).
+ * Options whose premium cannot be matched, including ones where the model
+ * yields NaN, are marked as not valid. Scratch arrays are kept between calls,
+ * so a solver instance must not be shared between threads.
+ */
+class Black76
+{
+public:
+	Black76(double rate = 0, int iterations = 12);
+
+	void solve(OptionBatch& batch);
+
+	static double price(double forward, double strike, double time, double volatility, double side, double discount = 1);
+
+private:
+	double m_rate;
+	int m_iterations;
+	std::vector<double> m_buffer;
+};
+
+#endif /* PRICING_BLACK76_H_ */
@@ -13,39 +13,80 @@ QuoteTable::~QuoteTable()
 {
 }
 
+void QuoteTable::updateQuote(InstrumentId instrument, const goldmine::Tick& tick)
+{
+	boost::unique_lock<boost::mutex> lock(m_mutex);
+	updateQuoteLocked(instrument, tick);
+}
+
 void QuoteTable::updateQuote(const std::string& ticker, const goldmine::Tick& tick)
+{
+	updateQuote(InstrumentRegistry::instance().id(ticker), tick);
+}
+
+void QuoteTable::updateQuotes(const TickUpdate* updates, size_t count)
 {
 	boost::unique_lock<boost::mutex> lock(m_mutex);
-	m_table[std::make_pair(ticker, goldmine::Datatype(tick.datatype))] = tick;
-	if(m_enabledTickers.find(ticker) != m_enabledTickers.end())
-		m_callback(ticker, tick);
+	for(size_t i = 0; i < count; i++)
+		updateQuoteLocked(updates[i].instrument, updates[i].tick);
 }
 
-goldmine::Tick QuoteTable::lastQuote(const std::string& ticker, goldmine::Datatype datatype)
+void QuoteTable::consume(const TickUpdate* updates, size_t count)
+{
+	updateQuotes(updates, count);
+}
+
+goldmine::Tick QuoteTable::lastQuote(InstrumentId instrument, goldmine::Datatype datatype)
 {
 	boost::unique_lock<boost::mutex> lock(m_mutex);
-	auto it = m_table.find(std::make_pair(ticker, datatype));
+	auto it = m_table.find(makeKey(instrument, datatype));
 	if(it != m_table.end())
 	{
-		return it->second;
+		return it->second.tick;
 	}
 	return goldmine::Tick();
 }
 
+goldmine::Tick QuoteTable::lastQuote(const std::string& ticker, goldmine::Datatype datatype)
+{
+	auto instrument = InstrumentRegistry::instance().find(ticker);
+	if(instrument == NoInstrument)
+		return goldmine::Tick();
+	return lastQuote(instrument, datatype);
+}
+
+QuoteTable::Quote QuoteTable::quote(InstrumentId instrument, goldmine::Datatype datatype)
+{
+	boost::unique_lock<boost::mutex> lock(m_mutex);
+	auto it = m_table.find(makeKey(instrument, datatype));
+	if(it != m_table.end())
+		return it->second;
+	return Quote { goldmine::Tick(), 0, InstrumentMetadata::instance().priceStep(instrument) };
+}
+
 void QuoteTable::setTickCallback(const TickCallback& callback)
 {
 	m_callback = callback;
 }
 
-void QuoteTable::enableTicker(const std::string& ticker)
+void QuoteTable::enableTicker(InstrumentId instrument)
 {
-	m_enabledTickers.insert(ticker);
+	m_enabledTickers.insert(instrument);
 }
 
-void QuoteTable::disableTicker(const std::string& ticker)
+void QuoteTable::disableTicker(InstrumentId instrument)
 {
-	auto it = m_enabledTickers.find(ticker);
+	auto it = m_enabledTickers.find(instrument);
 	if(it != m_enabledTickers.end())
 		m_enabledTickers.erase(it);
 }
 
+void QuoteTable::updateQuoteLocked(InstrumentId instrument, const goldmine::Tick& tick)
+{
+	auto& quote = m_table[makeKey(instrument, goldmine::Datatype(tick.datatype))];
+	quote.tick = tick;
+	quote.step = InstrumentMetadata::instance().priceStep(instrument);
+	quote.price = InstrumentMetadata::toTicks(tick.value.toDouble(), quote.step);
+	if(m_enabledTickers.find(instrument) != m_enabledTickers.end())
+		m_callback(instrument, quote);
+}
@@ -6,43 +6,62 @@
 #define CORE_QUOTETABLE_H_
 
 #include "goldmine/data.h"
+#include "core/instrumentregistry.h"
+#include "core/instrumentmetadata.h"
+#include "core/tables/datasink.h"
+#include "core/sinks/ticksink.h"
 #include <utility>
 #include <unordered_set>
 #include <unordered_map>
 #include <memory>
 #include <boost/thread.hpp>
 
-class QuoteTable
+class QuoteTable : public TickSink
 {
 public:
 	typedef std::shared_ptr<QuoteTable> Ptr;
-	typedef std::function<void(const std::string& ticker, const goldmine::Tick& tick)> TickCallback;
+
+	/**
+	 * Tick together with its price in steps of the instrument, converted
+	 * once when the tick enters the table
+	 */
+	struct Quote
+	{
+		goldmine::Tick tick;
+		TickPrice price;
+		double step;
+	};
+
+	typedef std::function<void(InstrumentId instrument, const Quote& quote)> TickCallback;
 
 	QuoteTable();
 	virtual ~QuoteTable();
 
+	void updateQuote(InstrumentId instrument, const goldmine::Tick& tick);
 	void updateQuote(const std::string& ticker, const goldmine::Tick& tick);
+	void updateQuotes(const TickUpdate* updates, size_t count);
+	virtual void consume(const TickUpdate* updates, size_t count) override;
+	goldmine::Tick lastQuote(InstrumentId instrument, goldmine::Datatype datatype);
 	goldmine::Tick lastQuote(const std::string& ticker, goldmine::Datatype datatype);
+	Quote quote(InstrumentId instrument, goldmine::Datatype datatype);
 
 	void setTickCallback(const TickCallback& callback);
-	void enableTicker(const std::string& ticker);
-	void disableTicker(const std::string& ticker);
+	void enableTicker(InstrumentId instrument);
+	void disableTicker(InstrumentId instrument);
 
 private:
-	typedef std::pair<std::string, goldmine::Datatype> Key;
+	typedef uint64_t Key;
+
+	void updateQuoteLocked(InstrumentId instrument, const goldmine::Tick& tick);
 
-	class KeyHasher
+	static Key makeKey(InstrumentId instrument, goldmine::Datatype datatype)
 	{
-	public:
-		std::size_t operator()(const Key& k) const
-		{
-			return std::hash<std::string>()(k.first) ^ (std::hash<int>()((int)k.second) << 1);
-		}
-	};
+		return ((uint64_t)instrument << 32) | (uint32_t)datatype;
+	}
 
-	std::unordered_map<Key, goldmine::Tick, KeyHasher> m_table;
+	std::unordered_map<Key, Quote> m_table;
 	TickCallback m_callback;
-	std::unordered_set<std::string> m_enabledTickers;
+	std::unordered_set<InstrumentId> m_enabledTickers;
 	boost::mutex m_mutex;
 };
 
@@ -0,0 +1,20 @@
+/*
+ * quotesourcesink.cpp
+ */
+
+#include "quotesourcesink.h"
+
+QuoteSourceSink::QuoteSourceSink(const std::shared_ptr<goldmine::QuoteSource>& quoteSource) : m_quoteSource(quoteSource)
+{
+}
+
+QuoteSourceSink::~QuoteSourceSink()
+{
+}
+
+void QuoteSourceSink::consume(const TickUpdate* updates, size_t count)
+{
+	const auto& registry = InstrumentRegistry::instance();
+	for(size_t i = 0; i < count; i++)
+		m_quoteSource->incomingTick(registry.name(updates[i].instrument), updates[i].tick);
+}
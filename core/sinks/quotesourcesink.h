@@ -0,0 +1,32 @@
+/*
+ * quotesourcesink.h
+ */
+
+#ifndef SINKS_QUOTESOURCESINK_H_
+#define SINKS_QUOTESOURCESINK_H_
+
+#include "core/sinks/ticksink.h"
+
+#include "quotesource/quotesource.h"
+
+/**
+ * Publishes ticks to goldmine QuoteSource clients
+ */
+class QuoteSourceSink : public TickSink
+{
+public:
+	QuoteSourceSink(const std::shared_ptr<goldmine::QuoteSource>& quoteSource);
+	virtual ~QuoteSourceSink();
+
+	virtual void consume(const TickUpdate* updates, size_t count) override;
+
+	virtual bool publishes() const override
+	{
+		return true;
+	}
+
+private:
+	std::shared_ptr<goldmine::QuoteSource> m_quoteSource;
+};
+
+#endif /* SINKS_QUOTESOURCESINK_H_ */
@@ -0,0 +1,148 @@
+/*
+ * sinkregistry.cpp
+ */
+
+#include "sinkregistry.h"
+
+#include "core/stats/latencyclock.h"
+
+#include "log.h"
+#include "exceptions.h"
+
+#include <iomanip>
+
+static const size_t gs_batchSize = 1024;
+// Sinks are notified this often while the stream stays idle
+static const boost::chrono::milliseconds gs_idleInterval(100);
+
+SinkRegistry::SinkRegistry(const TickRing::Ptr& ring) : m_ring(ring),
+	m_run(false)
+{
+}
+
+SinkRegistry::~SinkRegistry()
+{
+	stop();
+}
+
+void SinkRegistry::registerSink(const std::string& name, const TickSink::Ptr& sink, SlowSinkPolicy policy)
+{
+	if(m_run)
+		BOOST_THROW_EXCEPTION(LogicError() << errinfo_str("Sinks should be registered before start: " + name));
+
+	std::unique_ptr<Entry> entry(new Entry);
+	entry->name = name;
+	entry->sink = sink;
+	entry->policy = policy;
+	entry->consumer = m_ring->addConsumer(policy == SlowSinkPolicy::Block);
+	entry->consumed = 0;
+	m_sinks.push_back(std::move(entry));
+	LOG(info) << "Registered sink: " << name << (policy == SlowSinkPolicy::Block ? " (block)" : " (drop)");
+}
+
+void SinkRegistry::start()
+{
+	m_run = true;
+	for(auto& entry : m_sinks)
+		entry->thread = boost::thread(std::bind(&SinkRegistry::sinkLoop, this, std::ref(*entry)));
+}
+
+void SinkRegistry::stop()
+{
+	m_run = false;
+	m_ring->wake();
+	for(auto& entry : m_sinks)
+	{
+		if(entry->thread.joinable())
+			entry->thread.join();
+	}
+}
+
+void SinkRegistry::sinkLoop(Entry& entry)
+{
+	std::vector<TickUpdate> batch(gs_batchSize);
+	std::vector<LatencyRecorder::PokeContext> pokes(entry.sink->publishes() ? gs_batchSize : 0);
+	int idle = 0;
+	while(true)
+	{
+		// Producers are stopped before m_run is cleared, so the ring is drained on exit
+		bool running = m_run;
+		uint64_t published = 0;
+		auto lag = m_ring->lag(entry.consumer);
+		auto count = m_ring->poll(entry.consumer, batch.data(), batch.size(), &published,
+			pokes.empty() ? nullptr : pokes.data());
+		if(count == 0)
+		{
+			if(!running)
+				break;
+
+			// Spin, then yield, then block until a producer publishes; sinks
+			// are notified when the stream goes idle and periodically while it
+			// stays idle
+			if(++idle == 100)
+				entry.sink->idle();
+			if(idle >= 1000)
+			{
+				if(!m_ring->waitForTicks(entry.consumer, gs_idleInterval))
+					entry.sink->idle();
+			}
+			else if(idle >= 100)
+			{
+				boost::this_thread::yield();
+			}
+			continue;
+		}
+		idle = 0;
+
+		entry.lag.record(lag);
+		entry.delay.record(LatencyClock::toNanoseconds(LatencyClock::now() - published));
+		try
+		{
+			entry.sink->consume(batch.data(), count);
+		}
+		catch(const std::exception& e)
+		{
+			LOG(warning) << "Sink " << entry.name << " failed to consume ticks: " << e.what();
+		}
+		if(!pokes.empty())
+			markPublished(pokes.data(), count);
+		entry.consumed.fetch_add(count, std::memory_order_relaxed);
+	}
+	entry.sink->idle();
+}
+
+void SinkRegistry::markPublished(const LatencyRecorder::PokeContext* pokes, size_t count)
+{
+	// Ticks of one poke are adjacent in the stream; record each poke once
+	auto now = LatencyClock::now();
+	for(size_t i = 0; i < count; i++)
+	{
+		if(i > 0 && pokes[i].topic == pokes[i - 1].topic && pokes[i].start == pokes[i - 1].start)
+			continue;
+		LatencyRecorder::mark(LatencyStage::Publish, pokes[i], now);
+	}
+}
+
+void SinkRegistry::dumpStats(std::ostream& out)
+{
+	static const double percentiles[] = { 50., 99., 99.9 };
+
+	out << "Sinks (delay in ns from ring publish, lag in ticks)";
+	for(const auto& entry : m_sinks)
+	{
+		out << std::endl << std::setw(16) << entry->name << " consumed=" << entry->consumed
+			<< " dropped=" << m_ring->dropped(entry->consumer) << " lag=" << m_ring->lag(entry->consumer);
+		for(auto p : percentiles)
+			out << " delay_p" << p << "=" << entry->delay.percentile(p);
+		out << " delay_max=" << entry->delay.max() << " lag_max=" << entry->lag.max();
+	}
+}
+
+SlowSinkPolicy SinkRegistry::parsePolicy(const std::string& policy)
+{
+	if(policy == "block")
+		return SlowSinkPolicy::Block;
+	else if(policy == "drop")
+		return SlowSinkPolicy::Drop;
+	BOOST_THROW_EXCEPTION(ParameterError() << errinfo_str("Invalid slow sink policy: " + policy));
+}
@@ -0,0 +1,85 @@
+/*
+ * sinkregistry.h
+ */
+
+#ifndef SINKS_SINKREGISTRY_H_
+#define SINKS_SINKREGISTRY_H_
+
+#include "core/sinks/ticksink.h"
+#include "core/tickring.h"
+#include "core/stats/latencyhistogram.h"
+#include "core/stats/latencyrecorder.h"
+
+#include <boost/thread.hpp>
+
+#include <atomic>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * What happens when a sink can't keep up with the stream
+ */
+enum class SlowSinkPolicy
+{
+	Block, // Producers wait for the sink; no ticks are lost
+	Drop   // Sink skips ticks overwritten in the ring; producers never wait
+};
+
+/**
+ * Fans the tick stream out to independent sinks. Every sink has its own
+ * cursor in TickRing and its own thread, so a slow sink delays nobody but
+ * itself (or, with Block policy, producers once the ring is full).
+ */
+class SinkRegistry
+{
+public:
+	typedef std::shared_ptr<SinkRegistry> Ptr;
+
+	SinkRegistry(const TickRing::Ptr& ring);
+	virtual ~SinkRegistry();
+
+	/**
+	 * Should be called before start()
+	 */
+	void registerSink(const std::string& name, const TickSink::Ptr& sink, SlowSinkPolicy policy);
+
+	void start();
+
+	/**
+	 * Lets sinks consume what is left in the ring and joins their threads.
+	 * Producers should be stopped before.
+	 */
+	void stop();
+
+	void dumpStats(std::ostream& out);
+
+	static SlowSinkPolicy parsePolicy(const std::string& policy);
+
+private:
+	struct Entry
+	{
+		std::string name;
+		TickSink::Ptr sink;
+		SlowSinkPolicy policy;
+		int consumer;
+		boost::thread thread;
+
+		// Delay between publishing a tick into the ring and its consumption, ns
+		LatencyHistogram delay;
+		// Ticks waiting in the ring when the sink polls
+		LatencyHistogram lag;
+		std::atomic<uint64_t> consumed;
+	};
+
+	void sinkLoop(Entry& entry);
+	static void markPublished(const LatencyRecorder::PokeContext* pokes, size_t count);
+
+private:
+	TickRing::Ptr m_ring;
+	std::vector<std::unique_ptr<Entry>> m_sinks;
+	std::atomic<bool> m_run;
+};
+
+#endif /* SINKS_SINKREGISTRY_H_ */
@@ -0,0 +1,41 @@
+/*
+ * ticksink.h
+ */
+
+#ifndef SINKS_TICKSINK_H_
+#define SINKS_TICKSINK_H_
+
+#include "core/tables/datasink.h"
+
+#include <memory>
+
+/**
+ * Consumer of the tick stream. Each registered sink is driven by its own
+ * thread, so consume() may block without affecting other sinks.
+ */
+class TickSink
+{
+public:
+	typedef std::shared_ptr<TickSink> Ptr;
+
+	virtual ~TickSink() {}
+
+	virtual void consume(const TickUpdate* updates, size_t count) = 0;
+
+	/**
+	 * Called when the stream goes idle and periodically while it stays idle,
+	 * e.g. to flush buffers
+	 */
+	virtual void idle() {}
+
+	/**
+	 * True if consume() delivers ticks to clients; the registry then records
+	 * Publish latency stage of the pokes the ticks came from
+	 */
+	virtual bool publishes() const
+	{
+		return false;
+	}
+};
+
+#endif /* SINKS_TICKSINK_H_ */
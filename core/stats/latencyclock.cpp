@@ -0,0 +1,31 @@
+/*
+ * latencyclock.cpp
+ */
+
+#include "latencyclock.h"
+
+#include <mutex>
+#include <thread>
+
+std::atomic<double> LatencyClock::s_nsPerTick(1.0);
+
+void LatencyClock::calibrate()
+{
+	static std::once_flag calibrated;
+	std::call_once(calibrated, &LatencyClock::measure);
+}
+
+void LatencyClock::measure()
+{
+#ifdef GQG_HAVE_TSC
+	auto startTime = std::chrono::steady_clock::now();
+	auto startTicks = now();
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	auto endTicks = now();
+	auto endTime = std::chrono::steady_clock::now();
+
+	auto elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+	if(endTicks > startTicks && elapsedNs > 0)
+		s_nsPerTick.store((double)elapsedNs / (double)(endTicks - startTicks), std::memory_order_relaxed);
+#endif
+}
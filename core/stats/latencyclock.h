@@ -0,0 +1,51 @@
+/*
+ * latencyclock.h
+ */
+
+#ifndef CORE_STATS_LATENCYCLOCK_H_
+#define CORE_STATS_LATENCYCLOCK_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define GQG_HAVE_TSC 1
+#endif
+
+/**
+ * Cheap monotonic timestamp source for latency measurements.
+ * Uses the TSC where available and steady_clock otherwise; raw ticks are
+ * converted to nanoseconds with a factor obtained in calibrate().
+ * Calibration runs once per process, however many times calibrate() is
+ * called; concurrent callers wait for it to finish.
+ */
+class LatencyClock
+{
+public:
+	static inline uint64_t now()
+	{
+#ifdef GQG_HAVE_TSC
+		return __rdtsc();
+#else
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+	}
+
+	static inline uint64_t toNanoseconds(uint64_t ticks)
+	{
+		return (uint64_t)(ticks * s_nsPerTick.load(std::memory_order_relaxed));
+	}
+
+	static void calibrate();
+
+private:
+	static void measure();
+
+private:
+	static std::atomic<double> s_nsPerTick;
+};
+
+#endif /* CORE_STATS_LATENCYCLOCK_H_ */
@@ -0,0 +1,61 @@
+/*
+ * latencyhistogram.cpp
+ */
+
+#include "latencyhistogram.h"
+
+#include <cmath>
+
+LatencyHistogram::LatencyHistogram()
+{
+	reset();
+}
+
+uint64_t LatencyHistogram::count() const
+{
+	uint64_t result = 0;
+	for(const auto& c : m_counts)
+		result += c.load(std::memory_order_relaxed);
+	return result;
+}
+
+uint64_t LatencyHistogram::max() const
+{
+	return m_max.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::percentile(double p) const
+{
+	uint64_t total = count();
+	if(total == 0)
+		return 0;
+
+	uint64_t threshold = (uint64_t)std::ceil(total * p / 100.);
+	if(threshold == 0)
+		threshold = 1;
+
+	uint64_t seen = 0;
+	for(int i = 0; i < BucketsCount; i++)
+	{
+		seen += m_counts[i].load(std::memory_order_relaxed);
+		if(seen >= threshold)
+			return bucketLowerBound(i);
+	}
+	return max();
+}
+
+void LatencyHistogram::reset()
+{
+	for(auto& c : m_counts)
+		c.store(0, std::memory_order_relaxed);
+	m_max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::bucketLowerBound(int index)
+{
+	if(index < SubBuckets)
+		return index;
+	int magnitude = index / SubBuckets + SubBucketBits - 1;
+	uint64_t subBucket = index % SubBuckets;
+	return (SubBuckets + subBucket) << (magnitude - SubBucketBits);
+}
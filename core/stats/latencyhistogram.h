@@ -0,0 +1,59 @@
+/*
+ * latencyhistogram.h
+ */
+
+#ifndef CORE_STATS_LATENCYHISTOGRAM_H_
+#define CORE_STATS_LATENCYHISTOGRAM_H_
+
+#include <atomic>
+#include <array>
+#include <cstdint>
+
+/**
+ * Log-linear (HDR-style) histogram of nanosecond values.
+ * Each power of two is split into 16 linear sub-buckets (~6% precision).
+ * record() is lock-free and safe to call from any number of threads.
+ */
+class LatencyHistogram
+{
+public:
+	static const int SubBucketBits = 4;
+	static const int SubBuckets = 1 << SubBucketBits;
+	static const int MaxMagnitude = 40;
+	static const int BucketsCount = (MaxMagnitude - SubBucketBits + 2) * SubBuckets;
+
+	LatencyHistogram();
+
+	inline void record(uint64_t ns)
+	{
+		m_counts[bucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+		uint64_t max = m_max.load(std::memory_order_relaxed);
+		while(ns > max && !m_max.compare_exchange_weak(max, ns, std::memory_order_relaxed))
+			;
+	}
+
+	uint64_t count() const;
+	uint64_t max() const;
+	uint64_t percentile(double p) const;
+
+	void reset();
+
+	static inline int bucketIndex(uint64_t ns)
+	{
+		if(ns < (uint64_t)SubBuckets)
+			return (int)ns;
+		int magnitude = 63 - __builtin_clzll(ns);
+		if(magnitude > MaxMagnitude)
+			return BucketsCount - 1;
+		int shift = magnitude - SubBucketBits;
+		return (magnitude - SubBucketBits + 1) * SubBuckets + (int)((ns >> shift) & (SubBuckets - 1));
+	}
+
+	static uint64_t bucketLowerBound(int index);
+
+private:
+	std::array<std::atomic<uint64_t>, BucketsCount> m_counts;
+	std::atomic<uint64_t> m_max;
+};
+
+#endif /* CORE_STATS_LATENCYHISTOGRAM_H_ */
@@ -0,0 +1,94 @@
+/*
+ * latencyrecorder.cpp
+ */
+
+#include "latencyrecorder.h"
+
+#include <iomanip>
+
+thread_local LatencyRecorder::PokeContext LatencyRecorder::s_context = { nullptr, 0 };
+
+LatencyRecorder::LatencyRecorder()
+{
+	LatencyClock::calibrate();
+}
+
+LatencyRecorder& LatencyRecorder::instance()
+{
+	static LatencyRecorder recorder;
+	return recorder;
+}
+
+LatencyRecorder::TopicLatency* LatencyRecorder::topic(const std::string& name)
+{
+	boost::unique_lock<boost::mutex> lock(m_mutex);
+	auto& entry = m_topics[name];
+	if(!entry)
+		entry = std::unique_ptr<TopicLatency>(new TopicLatency);
+	return entry.get();
+}
+
+void LatencyRecorder::beginPoke(TopicLatency* topic, uint64_t start)
+{
+	s_context.topic = topic;
+	s_context.start = start;
+}
+
+void LatencyRecorder::endPoke()
+{
+	mark(LatencyStage::Total);
+	s_context.topic = nullptr;
+}
+
+void LatencyRecorder::dump(std::ostream& out)
+{
+	static const double percentiles[] = { 50., 90., 99., 99.9 };
+
+	boost::unique_lock<boost::mutex> lock(m_mutex);
+	out << "Ingest latency, ns (measured from poke arrival)";
+	for(const auto& topic : m_topics)
+	{
+		for(size_t i = 0; i < (size_t)LatencyStage::MaxStage; i++)
+		{
+			const auto& histogram = topic.second->stages[i];
+			auto count = histogram.count();
+			if(count == 0)
+				continue;
+
+			out << std::endl << std::setw(16) << topic.first << " " << std::setw(8) << stageName((LatencyStage)i)
+				<< " n=" << count;
+			for(auto p : percentiles)
+				out << " p" << p << "=" << histogram.percentile(p);
+			out << " max=" << histogram.max();
+		}
+	}
+}
+
+void LatencyRecorder::reset()
+{
+	boost::unique_lock<boost::mutex> lock(m_mutex);
+	for(auto& topic : m_topics)
+	{
+		for(auto& histogram : topic.second->stages)
+			histogram.reset();
+	}
+}
+
+const char* LatencyRecorder::stageName(LatencyStage stage)
+{
+	switch(stage)
+	{
+	case LatencyStage::Decode:
+		return "decode";
+	case LatencyStage::Parse:
+		return "parse";
+	case LatencyStage::Sink:
+		return "sink";
+	case LatencyStage::Publish:
+		return "publish";
+	case LatencyStage::Total:
+		return "total";
+	default:
+		return "unknown";
+	}
+}
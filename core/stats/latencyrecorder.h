@@ -0,0 +1,129 @@
+/*
+ * latencyrecorder.h
+ */
+
+#ifndef CORE_STATS_LATENCYRECORDER_H_
+#define CORE_STATS_LATENCYRECORDER_H_
+
+#include "latencyclock.h"
+#include "latencyhistogram.h"
+
+#include <boost/thread.hpp>
+
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+
+enum class LatencyStage
+{
+	Decode = 0,
+	Parse,
+	Sink,    // Tick reached Core
+	Publish, // Tick was handed to QuoteSource clients (recorded by the sink thread)
+	Total,   // Import thread finished the poke
+	MaxStage
+};
+
+/**
+ * Per-topic, per-stage latency histograms of the ingest pipeline.
+ * Every stage is measured from the moment the poke entered the gateway.
+ * Producers intern their topics once with topic() and pass the returned
+ * pointer to every poke, so starting a poke takes no lock and no lookup.
+ * The poke context is thread-local, so mark() costs one timestamp read and
+ * one relaxed atomic increment; histograms are atomic and may be shared by
+ * threads.
+ */
+class LatencyRecorder
+{
+public:
+	struct TopicLatency
+	{
+		std::array<LatencyHistogram, (size_t)LatencyStage::MaxStage> stages;
+	};
+
+	/**
+	 * Poke being processed by a thread. Copied along with ticks, it lets
+	 * another thread record later stages of the same poke.
+	 */
+	struct PokeContext
+	{
+		TopicLatency* topic;
+		uint64_t start;
+	};
+
+	static LatencyRecorder& instance();
+
+	/**
+	 * Histograms of the topic, created on first call. Returned pointer stays
+	 * valid for the lifetime of the process.
+	 */
+	TopicLatency* topic(const std::string& name);
+
+	static void beginPoke(TopicLatency* topic, uint64_t start);
+	static void endPoke();
+
+	static inline void mark(LatencyStage stage)
+	{
+		mark(stage, s_context.topic);
+	}
+
+	/**
+	 * Records stage of the current poke to another topic's histograms, e.g.
+	 * to measure each parser of a topic separately
+	 */
+	static inline void mark(LatencyStage stage, TopicLatency* topic)
+	{
+		if(!s_context.topic || !topic)
+			return;
+		auto elapsed = LatencyClock::now() - s_context.start;
+		topic->stages[(size_t)stage].record(LatencyClock::toNanoseconds(elapsed));
+	}
+
+	/**
+	 * Records stage of a poke processed by another thread at time now
+	 */
+	static inline void mark(LatencyStage stage, const PokeContext& poke, uint64_t now)
+	{
+		if(!poke.topic)
+			return;
+		poke.topic->stages[(size_t)stage].record(LatencyClock::toNanoseconds(now - poke.start));
+	}
+
+	/**
+	 * Poke of the calling thread; topic is null outside of a poke
+	 */
+	static inline const PokeContext& current()
+	{
+		return s_context;
+	}
+
+	void dump(std::ostream& out);
+	void reset();
+
+	static const char* stageName(LatencyStage stage);
+
+private:
+	LatencyRecorder();
+
+	static thread_local PokeContext s_context;
+
+	boost::mutex m_mutex;
+	std::map<std::string, std::unique_ptr<TopicLatency>> m_topics;
+};
+
+class LatencyPoke
+{
+public:
+	LatencyPoke(LatencyRecorder::TopicLatency* topic, uint64_t start = LatencyClock::now())
+	{
+		LatencyRecorder::beginPoke(topic, start);
+	}
+
+	~LatencyPoke()
+	{
+		LatencyRecorder::endPoke();
+	}
+};
+
+#endif /* CORE_STATS_LATENCYRECORDER_H_ */
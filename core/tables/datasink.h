@@ -3,9 +3,16 @@
 #define DATASINK_H
 
 #include "goldmine/data.h"
+#include "core/instrumentregistry.h"
 
 #include <memory>
 
+struct TickUpdate
+{
+	InstrumentId instrument;
+	goldmine::Tick tick;
+};
+
 class DataSink
 {
 public:
@@ -14,6 +21,21 @@ public:
 	virtual ~DataSink() = 0;
 
 	virtual void incomingTick(const std::string& ticker, const goldmine::Tick& tick) = 0;
+
+	virtual void incomingTick(InstrumentId instrument, const goldmine::Tick& tick)
+	{
+		incomingTick(InstrumentRegistry::instance().name(instrument), tick);
+	}
+
+	/**
+	 * Delivers a batch of ticks, normally everything produced by one poke.
+	 * Sinks should override this to take their locks once per batch.
+	 */
+	virtual void incomingTicks(const TickUpdate* updates, size_t count)
+	{
+		for(size_t i = 0; i < count; i++)
+			incomingTick(updates[i].instrument, updates[i].tick);
+	}
 };
 
 inline DataSink::~DataSink() {}
@@ -0,0 +1,33 @@
+/*
+ * datatypes.cpp
+ */
+
+#include "datatypes.h"
+
+#include "exceptions.h"
+
+#include <map>
+
+static const std::map<std::string, goldmine::Datatype> gs_datatypeMap
+{
+	{ "price", goldmine::Datatype::Price },
+	{ "open_interest", goldmine::Datatype::OpenInterest },
+	{ "best_bid", goldmine::Datatype::BestBid },
+	{ "best_offer", goldmine::Datatype::BestOffer },
+	{ "depth", goldmine::Datatype::Depth },
+	{ "total_supply", goldmine::Datatype::TotalSupply },
+	{ "total_demand", goldmine::Datatype::TotalDemand },
+	{ "implied_volatility", goldmine::Datatype(ExtendedDatatype::ImpliedVolatility) },
+	{ "delta", goldmine::Datatype(ExtendedDatatype::Delta) },
+	{ "gamma", goldmine::Datatype(ExtendedDatatype::Gamma) },
+	{ "vega", goldmine::Datatype(ExtendedDatatype::Vega) },
+	{ "depth_removed", goldmine::Datatype(ExtendedDatatype::DepthRemoved) }
+};
+
+goldmine::Datatype deserializeDatatype(const std::string& str)
+{
+	auto it = gs_datatypeMap.find(str);
+	if(it == gs_datatypeMap.end())
+		BOOST_THROW_EXCEPTION(ParameterError() << errinfo_str("Unknown datatype: " + str));
+	return it->second;
+}
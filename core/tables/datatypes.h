@@ -0,0 +1,36 @@
+/*
+ * datatypes.h
+ */
+
+#ifndef TABLES_DATATYPES_H_
+#define TABLES_DATATYPES_H_
+
+#include "goldmine/data.h"
+
+#include <string>
+
+/**
+ * Gateway-local datatypes which have no counterpart in goldmine::Datatype.
+ * Codes start from 100 to stay clear of upstream ones.
+ */
+namespace ExtendedDatatype
+{
+	const int First = 100;
+
+	const int ImpliedVolatility = First;
+	const int Delta = First + 1;
+	const int Gamma = First + 2;
+	const int Vega = First + 3;
+
+	// Price level removed from the book: value is the price, volume is 1 for
+	// bid side and -1 for offer side (sign as in Depth ticks)
+	const int DepthRemoved = First + 4;
+}
+
+/**
+ * Converts datatype name used in tables config ("price", "best_bid", ...)
+ * to goldmine::Datatype. Throws ParameterError on unknown name.
+ */
+goldmine::Datatype deserializeDatatype(const std::string& str);
+
+#endif /* TABLES_DATATYPES_H_ */
@@ -0,0 +1,58 @@
+/*
+ * depthbook.cpp
+ */
+
+#include "depthbook.h"
+
+#include <algorithm>
+
+DepthBook::DepthBook() : m_bidsCount(0), m_offersCount(0), m_depth(MaxLevels)
+{
+}
+
+void DepthBook::setDepth(int depth)
+{
+	m_depth = std::max(1, std::min(depth, (int)MaxLevels));
+	m_bidsCount = std::min(m_bidsCount, m_depth);
+	m_offersCount = std::min(m_offersCount, m_depth);
+}
+
+void DepthBook::clear()
+{
+	m_bidsCount = 0;
+	m_offersCount = 0;
+}
+
+void DepthBook::addBid(double price, int volume)
+{
+	m_bidsCount = insertLevel(m_bids, m_bidsCount, m_depth, price, volume, 1);
+}
+
+void DepthBook::addOffer(double price, int volume)
+{
+	m_offersCount = insertLevel(m_offers, m_offersCount, m_depth, price, volume, -1);
+}
+
+int DepthBook::insertLevel(DepthLevel* levels, int count, int depth, double price, int volume, int direction)
+{
+	// QUIK sends levels already ordered, so the scan from the back usually stops immediately
+	int position = count;
+	while(position > 0 && direction * (price - levels[position - 1].price) > 0)
+		position--;
+
+	if(position > 0 && levels[position - 1].price == price)
+	{
+		levels[position - 1].volume += volume;
+		return count;
+	}
+
+	if(position >= depth)
+		return count;
+
+	int last = std::min(count, depth - 1);
+	for(int i = last; i > position; i--)
+		levels[i] = levels[i - 1];
+	levels[position].price = price;
+	levels[position].volume = volume;
+	return last + 1;
+}
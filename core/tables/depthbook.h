@@ -0,0 +1,91 @@
+/*
+ * depthbook.h
+ */
+
+#ifndef TABLES_DEPTHBOOK_H_
+#define TABLES_DEPTHBOOK_H_
+
+#include <cstdint>
+
+struct DepthLevel
+{
+	double price;
+	int volume;
+};
+
+/**
+ * Fixed-capacity price level book. Bids are kept in descending and offers in
+ * ascending price order, best level first. Levels beyond configured depth are
+ * dropped, so filling the book never allocates.
+ */
+class alignas(64) DepthBook
+{
+public:
+	static const int MaxLevels = 64;
+
+	DepthBook();
+
+	void setDepth(int depth);
+	void clear();
+
+	void addBid(double price, int volume);
+	void addOffer(double price, int volume);
+
+	int bidsCount() const { return m_bidsCount; }
+	int offersCount() const { return m_offersCount; }
+	const DepthLevel* bids() const { return m_bids; }
+	const DepthLevel* offers() const { return m_offers; }
+
+	/**
+	 * Calls f(price, volume, side) for every level which differs between
+	 * books. side is 1 for bids and -1 for offers; volume is multiplied by
+	 * side, removed level is reported with zero volume.
+	 */
+	template<typename F>
+	static void diff(const DepthBook& previous, const DepthBook& current, F f)
+	{
+		diffSide(previous.m_bids, previous.m_bidsCount, current.m_bids, current.m_bidsCount, 1, f);
+		diffSide(previous.m_offers, previous.m_offersCount, current.m_offers, current.m_offersCount, -1, f);
+	}
+
+private:
+	static int insertLevel(DepthLevel* levels, int count, int depth, double price, int volume, int direction);
+
+	// direction is 1 for bids (better is higher) and -1 for offers
+	template<typename F>
+	static void diffSide(const DepthLevel* previous, int previousCount,
+			const DepthLevel* current, int currentCount, int direction, F& f)
+	{
+		int i = 0;
+		int j = 0;
+		while(i < previousCount || j < currentCount)
+		{
+			if(i < previousCount && j < currentCount && previous[i].price == current[j].price)
+			{
+				if(previous[i].volume != current[j].volume)
+					f(current[j].price, direction * current[j].volume, direction);
+				i++;
+				j++;
+			}
+			else if(j < currentCount && (i == previousCount || direction * (current[j].price - previous[i].price) > 0))
+			{
+				f(current[j].price, direction * current[j].volume, direction);
+				j++;
+			}
+			else
+			{
+				f(previous[i].price, 0, direction);
+				i++;
+			}
+		}
+	}
+
+private:
+	DepthLevel m_bids[MaxLevels];
+	DepthLevel m_offers[MaxLevels];
+	int m_bidsCount;
+	int m_offersCount;
+	int m_depth;
+};
+
+#endif /* TABLES_DEPTHBOOK_H_ */
@@ -0,0 +1,124 @@
+/*
+ * flatstringmap.h
+ */
+
+#ifndef TABLES_FLATSTRINGMAP_H_
+#define TABLES_FLATSTRINGMAP_H_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * Open-addressing (linear probing) hash map from string to T.
+ * Key hash is computed once per lookup and stored in the slot, so a lookup
+ * is one hash and usually one string comparison. References returned by
+ * operator[] and find() are invalidated when the map grows.
+ */
+template <typename T>
+class FlatStringMap
+{
+public:
+	FlatStringMap(size_t initialCapacity = 64) : m_size(0)
+	{
+		size_t capacity = 8;
+		while(capacity < initialCapacity)
+			capacity <<= 1;
+		m_slots.resize(capacity);
+		m_mask = capacity - 1;
+	}
+
+	T& operator[](const std::string& key)
+	{
+		size_t hash = std::hash<std::string>()(key);
+		size_t index = probe(key, hash);
+		auto& slot = m_slots[index];
+		if(slot.used)
+			return slot.value;
+
+		if((m_size + 1) * 2 > m_slots.size())
+		{
+			grow();
+			index = probe(key, hash);
+		}
+
+		auto& newSlot = m_slots[index];
+		newSlot.used = true;
+		newSlot.hash = hash;
+		newSlot.key = key;
+		newSlot.value = T();
+		m_size++;
+		return newSlot.value;
+	}
+
+	T* find(const std::string& key)
+	{
+		auto& slot = m_slots[probe(key, std::hash<std::string>()(key))];
+		return slot.used ? &slot.value : nullptr;
+	}
+
+	size_t size() const
+	{
+		return m_size;
+	}
+
+	void clear()
+	{
+		for(auto& slot : m_slots)
+			slot = Slot();
+		m_size = 0;
+	}
+
+	template <typename F>
+	void forEach(F f)
+	{
+		for(auto& slot : m_slots)
+		{
+			if(slot.used)
+				f(slot.key, slot.value);
+		}
+	}
+
+private:
+	struct Slot
+	{
+		Slot() : used(false), hash(0), value() {}
+
+		bool used;
+		size_t hash;
+		std::string key;
+		T value;
+	};
+
+	size_t probe(const std::string& key, size_t hash) const
+	{
+		size_t index = hash & m_mask;
+		while(m_slots[index].used && (m_slots[index].hash != hash || m_slots[index].key != key))
+			index = (index + 1) & m_mask;
+		return index;
+	}
+
+	void grow()
+	{
+		std::vector<Slot> old;
+		old.swap(m_slots);
+		m_slots.resize(old.size() * 2);
+		m_mask = m_slots.size() - 1;
+		for(auto& slot : old)
+		{
+			if(!slot.used)
+				continue;
+			size_t index = slot.hash & m_mask;
+			while(m_slots[index].used)
+				index = (index + 1) & m_mask;
+			m_slots[index] = std::move(slot);
+		}
+	}
+
+private:
+	std::vector<Slot> m_slots;
+	size_t m_mask;
+	size_t m_size;
+};
+
+#endif /* TABLES_FLATSTRINGMAP_H_ */
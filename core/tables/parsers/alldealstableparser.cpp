@@ -6,18 +6,6 @@
 #include "alldealstableparser.h"
 #include "log.h"
 
-enum ColumnId
-{
-	ClassCode = 0,
-	Code,
-	Date,
-	TradeTime,
-	TradeTimeMsec,
-	Price,
-	Quantity,
-	BuySell,
-	MaxId
-};
 static std::vector<std::string> gs_columnNames = {
 		"CLASSCODE",
 		"SECCODE",
@@ -26,7 +14,8 @@ static std::vector<std::string> gs_columnNames = {
 		"TRADETIME_MSEC",
 		"PRICE",
 		"QTY",
-		"BUYSELL" };
+		"BUYSELL",
+		"TRADENUM" };
 
 static int indexOf(const std::string& code)
 {
@@ -65,7 +54,7 @@ static time_t _mkgmtime(const struct tm *tm)
 }
 
 AllDealsTableParser::AllDealsTableParser(const std::string& topic, const DataSink::Ptr& datasink) :
-	m_topic(topic), m_datasink(datasink)
+	m_topic(topic), m_datasink(datasink), m_lastRow(-1), m_dedupCapacity(0)
 {
 }
 
@@ -73,6 +62,11 @@ AllDealsTableParser::~AllDealsTableParser()
 {
 }
 
+int AllDealsTableParser::columnId(const std::string& header)
+{
+	return indexOf(header);
+}
+
 bool AllDealsTableParser::acceptsTopic(const std::string& topic)
 {
 	return m_topic == topic;
@@ -80,88 +74,148 @@ bool AllDealsTableParser::acceptsTopic(const std::string& topic)
 
 void AllDealsTableParser::incomingTable(const XlTable::Ptr& table)
 {
-	if(!schemaObtained())
-		obtainSchema(table);
+	if(!m_decoder.compiled())
+		m_decoder.compile(*table, gs_columnNames);
+
+	if(table->originRow() == 0)
+		detectReset(*table);
 
+	bool byTradeNum = m_decoder.hasColumn(TradeNum);
 	for(int i = 0; i < table->height(); i++)
 	{
-		parseRow(i, table);
+		auto row = m_decoder.row(*table, i);
+		if(byTradeNum)
+		{
+			auto tradeNum = row.number(TradeNum);
+			auto classCode = row.string(ClassCode);
+			if(!tradeNum || !classCode)
+				continue;
+			auto& state = m_classes[*classCode];
+			if(*tradeNum <= state.lastTradeNum)
+				continue;
+			state.lastTradeNum = *tradeNum;
+		}
+		else
+		{
+			int absoluteRow = table->originRow() + i;
+			if(absoluteRow <= m_lastRow)
+				continue;
+			m_lastRow = absoluteRow;
+		}
+		parseRow(row);
+	}
+
+	if(!m_batch.empty())
+	{
+		m_datasink->incomingTicks(m_batch.data(), m_batch.size());
+		m_batch.clear();
 	}
 }
 
-void AllDealsTableParser::parseRow(int i, const XlTable::Ptr& table)
+void AllDealsTableParser::detectReset(const XlTable& table)
 {
-	std::string code;
-	try
+	// Poke starting at the top of the table is either a re-sent table or a
+	// new one (e.g. after QUIK restart). Tell them apart by the first trade.
+	for(int i = 0; i < table.height(); i++)
 	{
-		auto contractClassCode = boost::get<std::string>(table->get(i, m_schema[ClassCode]));
-		auto contractCode = boost::get<std::string>(table->get(i, m_schema[Code]));
-		code = contractClassCode + "#" + contractCode;
+		auto row = m_decoder.row(table, i);
+		if(!row.number(Price))
+			continue;
+
+		std::string key;
+		auto tradeNum = row.number(TradeNum);
+		if(tradeNum)
+		{
+			auto classCode = row.string(ClassCode);
+			key = (classCode ? *classCode : std::string()) + "|" + std::to_string((uint64_t)*tradeNum);
+		}
+		else
+		{
+			for(int column : { ClassCode, Code, Date, TradeTime })
+			{
+				auto str = row.string(column);
+				key += str ? *str : std::string();
+				key.push_back('|');
+			}
+			key += std::to_string(*row.number(Price)) + "|" + std::to_string(row.number(Quantity).get_value_or(0));
+		}
+
+		if(!m_firstRowKey.empty() && key != m_firstRowKey)
+		{
+			LOG(info) << "All deals table reset detected: " << m_topic;
+			m_classes.forEach([](const std::string&, ClassState& state) { state.lastTradeNum = -1; });
+			m_lastRow = -1;
+		}
+		m_firstRowKey = key;
+		return;
 	}
-	catch(const boost::bad_get& e)
+}
+
+void AllDealsTableParser::parseRow(const RowDecoder::Row& row)
+{
+	auto contractClassCode = row.string(ClassCode);
+	auto contractCode = row.string(Code);
+	if(!contractClassCode || !contractCode)
 	{
 		LOG(warning) << "Unable to parse contract code from table";
 		return;
 	}
-
-	std::string date = boost::get<std::string>(table->get(i, m_schema[Date]));
-	std::string time = boost::get<std::string>(table->get(i, m_schema[TradeTime]));
-	double timeMsec = boost::get<double>(table->get(i, m_schema[TradeTimeMsec]));
+	auto date = row.string(Date);
+	auto time = row.string(TradeTime);
+	auto timeMsec = row.number(TradeTimeMsec);
+	auto price = row.number(Price);
+	auto quantity = row.number(Quantity);
+	auto buysell = row.string(BuySell);
+	if(!date || !time || (time->size() < 8) || !timeMsec || !price || !quantity || !buysell)
+		return;
 
 	struct tm t;
-	std::sscanf(date.c_str(), "%d.%d.%d", &t.tm_mday, &t.tm_mon, &t.tm_year);
+	std::sscanf(date->c_str(), "%d.%d.%d", &t.tm_mday, &t.tm_mon, &t.tm_year);
+
+	if(!m_dedupFile.empty())
+	{
+		auto tradeNum = row.number(TradeNum);
+		if(tradeNum)
+		{
+			auto& dedup = m_classes[*contractClassCode].dedup;
+			if(!dedup)
+				dedup = std::make_shared<TradeDedupIndex>(m_dedupFile + "." + *contractClassCode, m_dedupCapacity);
+			dedup->setSession(t.tm_year * 10000 + t.tm_mon * 100 + t.tm_mday);
+			if(!dedup->insert((uint64_t)*tradeNum))
+				return;
+		}
+	}
+
 	t.tm_year -= 1900;
 	t.tm_mon -= 1;
 
+	std::string code = *contractClassCode + "#" + *contractCode;
+	auto& instrument = m_instruments[code];
+	if(instrument == NoInstrument)
+		instrument = InstrumentRegistry::instance().id(code);
 
-	const char* tstr = time.c_str();
-	t.tm_hour = tstr[0] * 10 + tstr[1];
-	t.tm_min = tstr[3] * 10 + tstr[4];
-	t.tm_sec = tstr[6] * 10 + tstr[7];
+	const char* tstr = time->c_str();
+	t.tm_hour = (tstr[0] - '0') * 10 + (tstr[1] - '0');
+	t.tm_min = (tstr[3] - '0') * 10 + (tstr[4] - '0');
+	t.tm_sec = (tstr[6] - '0') * 10 + (tstr[7] - '0');
+	t.tm_isdst = -1;
 
 	goldmine::Tick tick;
 	tick.timestamp = mktime(&t);
-	tick.useconds = timeMsec;
+	tick.useconds = *timeMsec;
 	tick.datatype = (int)goldmine::Datatype::Price;
-	tick.value = boost::get<double>(table->get(i, m_schema[Price]));
-	std::string buysell = boost::get<std::string>(table->get(i, m_schema[BuySell]));
-	tick.volume = boost::get<double>(table->get(i, m_schema[Quantity]));
-	if(buysell.size() > 3) // If "Sell"
+	tick.value = *price;
+	tick.volume = *quantity;
+	if(buysell->size() > 3) // If "Sell"
 		tick.volume = -tick.volume;
 
-	m_datasink->incomingTick(code, tick);
+	m_batch.push_back(TickUpdate { instrument, tick });
 }
 
 void AllDealsTableParser::parseConfig(const Json::Value& root)
 {
-
-}
-
-bool AllDealsTableParser::schemaObtained() const
-{
-	return !m_schema.empty();
-}
-
-void AllDealsTableParser::obtainSchema(const XlTable::Ptr& table)
-{
-	m_schema.resize(MaxId, -1);
-	for(int i = 0; i < table->width(); i++)
-	{
-		std::string header;
-
-		try
-		{
-			header = boost::get<std::string>(table->get(0, i));
-		}
-		catch(const boost::bad_get& e)
-		{
-			// Skip silently
-		}
-		int index = indexOf(header);
-		m_schema[index] = i;
-
-		LOG(debug) << "[" << header << "] -> " << index;
-	}
+	m_dedupFile = root.get("dedup_file", "").asString();
+	m_dedupCapacity = root.get("dedup_capacity", 1 << 25).asUInt64();
 }
 
 TableParser::Ptr AllDealsTableParserFactory::create(const std::string& topic, const DataSink::Ptr& datasink)
@@ -9,12 +9,31 @@
 #include "core/tables/tableparserfactoryregistry.h"
 #include "core/tables/tableparser.h"
 #include "core/tables/datasink.h"
+#include "core/tables/rowdecoder.h"
+#include "core/tables/flatstringmap.h"
+#include "core/tables/tradededupindex.h"
 
 class AllDealsTableParser : public TableParser
 {
 public:
 	typedef std::shared_ptr<AllDealsTableParser> Ptr;
 
+	enum ColumnId
+	{
+		ClassCode = 0,
+		Code,
+		Date,
+		TradeTime,
+		TradeTimeMsec,
+		Price,
+		Quantity,
+		BuySell,
+		TradeNum,
+		MaxId
+	};
+
+	static int columnId(const std::string& header);
+
 	AllDealsTableParser(const std::string& topic, const DataSink::Ptr& datasink);
 	virtual ~AllDealsTableParser();
 
@@ -25,15 +44,36 @@ public:
 	virtual void parseConfig(const Json::Value& root);
 
 private:
-	bool schemaObtained() const;
-	void obtainSchema(const XlTable::Ptr& table);
-
-	void parseRow(int i, const XlTable::Ptr& table);
+	void detectReset(const XlTable& table);
+	void parseRow(const RowDecoder::Row& row);
 
 private:
 	std::string m_topic;
 	DataSink::Ptr m_datasink;
-	std::vector<int> m_schema;
+	RowDecoder m_decoder;
+	FlatStringMap<InstrumentId> m_instruments;
+	std::vector<TickUpdate> m_batch;
+
+	struct ClassState
+	{
+		ClassState() : lastTradeNum(-1) {}
+
+		double lastTradeNum;
+
+		// Trade numbers emitted in this session, also before reconnect or
+		// restart. Stored in <dedup_file>.<class code>
+		TradeDedupIndex::Ptr dedup;
+	};
+
+	// Rows already processed: by trade number if the table has TRADENUM
+	// column, by absolute row index otherwise. Trade numbers are assigned
+	// by each class independently, so they are tracked per class code.
+	FlatStringMap<ClassState> m_classes;
+	int m_lastRow;
+	std::string m_firstRowKey;
+
+	std::string m_dedupFile;
+	uint64_t m_dedupCapacity;
 };
 
 class AllDealsTableParserFactory : public TableParserFactory
@@ -3,9 +3,11 @@
  */
 
 #include "currentparametertableparser.h"
+#include "core/instrumentmetadata.h"
 #include "log.h"
+#include <algorithm>
 #include <cstdlib>
-#include <chrono>
+#include <limits>
 
 enum ColumnId
 {
@@ -18,6 +20,8 @@ enum ColumnId
 	TotalBid,
 	TotalAsk,
 	Volume,
+	PriceStep,
+	Scale,
 	MaxId
 };
 static std::vector<std::string> gs_columnNames = {
@@ -29,34 +33,30 @@ static std::vector<std::string> gs_columnNames = {
 		"numcontracts",
 		"biddeptht",
 		"offerdeptht",
-		"voltoday" };
-
-static int indexOf(const std::string& code)
-{
-	auto it = std::find(gs_columnNames.begin(), gs_columnNames.end(), code);
-	if(it != gs_columnNames.end())
-		return std::distance(gs_columnNames.begin(), it);
-	return -1;
-}
-
-static std::map<std::string, goldmine::Datatype> gs_datatypeMap
-{
-	{ "price", goldmine::Datatype::Price },
-	{ "open_interest", goldmine::Datatype::OpenInterest },
-	{ "best_bid", goldmine::Datatype::BestBid },
-	{ "best_offer", goldmine::Datatype::BestOffer },
-	{ "depth", goldmine::Datatype::Depth },
-	{ "total_supply", goldmine::Datatype::TotalSupply },
-	{ "total_demand", goldmine::Datatype::TotalDemand }
-};
-static goldmine::Datatype deserializeDatatype(const std::string& str)
+		"voltoday",
+		"SEC_PRICE_STEP",
+		"SEC_SCALE" };
+
+CurrentParameterTableParser::InstrumentState::InstrumentState() : instrument(NoInstrument),
+	suppressed(0),
+	volume(0),
+	last(0),
+	bid(0),
+	ask(0),
+	priceStep(0),
+	lastRefresh(0)
 {
-	return gs_datatypeMap[str];
+	std::fill(emitted, emitted + QuoteFieldsCount, std::numeric_limits<double>::quiet_NaN());
 }
 
 CurrentParameterTableParser::CurrentParameterTableParser(const std::string& topic,
 		const DataSink::Ptr& datasink) : m_topic(topic),
-	m_datasink(datasink)
+	m_partitions(1),
+	m_originRow(0),
+	m_datasink(datasink),
+	m_filterChecked(false),
+	m_parallelThreshold(512),
+	m_refreshInterval(0)
 {
 	LOG(trace) << "CurrentParameterTableParser: " << topic;
 }
@@ -72,240 +72,333 @@ bool CurrentParameterTableParser::acceptsTopic(const std::string& topic)
 
 void CurrentParameterTableParser::incomingTable(const XlTable::Ptr& table)
 {
-	if(!schemaObtained())
-		obtainSchema(table);
+	if(!m_decoder.compiled())
+		m_decoder.compile(*table, gs_columnNames);
+
+	// Every poke starting at the origin carries the header row
+	int rows = table->height();
+	m_originRow = table->originRow();
+	int firstRow = m_originRow == 0 ? 1 : 0;
+	m_rowInstruments.assign(rows, NoInstrument);
+	if(m_rowBindings.size() < (size_t)(m_originRow + rows))
+		m_rowBindings.resize(m_originRow + rows, RowBinding { std::string(), NoInstrument });
+
+	auto timestamp = arrivalTime(*table);
 
 	try
 	{
-		for(int row = 0; row < table->height(); row++)
+		if(!m_pool || rows - firstRow < m_parallelThreshold)
+		{
+			resolveRows(*table, firstRow, rows);
+			for(int row = firstRow; row < rows; row++)
+			{
+				auto instrument = m_rowInstruments[row];
+				if(instrument != NoInstrument)
+					parseRow(m_decoder.row(*table, row), state(instrument, m_rowBindings[m_originRow + row].key), timestamp, m_batch);
+			}
+		}
+		else
 		{
-			auto firstCell = table->get(row, 0);
-			if(!boost::get<XlTable::XlEmpty>(&firstCell))
-				parseRow(row, table);
+			int chunks = m_pool->size() * 4;
+			int chunkSize = (rows - firstRow + chunks - 1) / chunks;
+			m_pool->run(chunks, [&](int chunk)
+				{
+					int begin = firstRow + chunk * chunkSize;
+					resolveRows(*table, begin, std::min(begin + chunkSize, rows));
+				});
+			m_pool->run(m_partitions.size(), [&](int partition)
+				{
+					parsePartition(*table, partition, firstRow, timestamp);
+				});
+			mergePartitions(firstRow, rows);
 		}
 	}
 	catch(const std::exception& e)
 	{
 		LOG(warning) << "Unable to parse incoming table, exception thrown: " << e.what();
 	}
+	flush();
+
+	if(!m_filterChecked && m_originRow == 0)
+		checkFilter();
 }
 
 void CurrentParameterTableParser::parseConfig(const Json::Value& root)
 {
-	auto ignoreList = root["ignore"];
-	if(!ignoreList.isNull())
+	for(const auto& key : { "ignore", "exclude" })
 	{
-		auto it = ignoreList.begin();
-		while(it != ignoreList.end())
-		{
-            auto ignoreItem = it->asString();
-            auto slash = ignoreItem.find('/');
-            if(slash == std::string::npos)
-			{
-				m_filters.push_back([&](const std::string& ticker, goldmine::Datatype type)
-				{
-					return ticker == ignoreItem;
-				});
-			}
-			else
-			{
-				auto ignoreTicker = ignoreItem.substr(0, slash);
-				auto datatype = deserializeDatatype(ignoreItem.substr(slash + 1));
-				m_filters.push_back([&](const std::string& ticker, goldmine::Datatype type)
-				{
-					return (ticker == ignoreTicker) && (datatype == type);
-				});
-			}
-		}
+		for(const auto& rule : root[key])
+			m_filter.addRule(rule.asString());
 	}
-}
 
-bool CurrentParameterTableParser::schemaObtained() const
-{
-	return !m_schema.empty();
+	int threads = root.get("threads", 1).asInt();
+	if(threads > 1)
+	{
+		m_pool = std::make_shared<WorkerPool>(threads);
+		m_partitions.resize(threads);
+	}
+	m_parallelThreshold = root.get("parallel_threshold", m_parallelThreshold).asInt();
+	m_refreshInterval = root.get("refresh_interval", m_refreshInterval).asInt();
 }
 
-void CurrentParameterTableParser::obtainSchema(const XlTable::Ptr& table)
+void CurrentParameterTableParser::resolveRows(const XlTable& table, int begin, int end)
 {
-	m_schema.resize(MaxId, -1);
-	for(int i = 0; i < table->width(); i++)
+	for(int row = begin; row < end; row++)
 	{
-		std::string header;
+		if(boost::get<XlTable::XlEmpty>(&table.cell(row, 0)))
+			continue;
 
-		try
+		auto r = m_decoder.row(table, row);
+		auto contractClassCode = r.string(ClassCode);
+		auto contractCode = r.string(Code);
+		if(!contractClassCode || !contractCode)
 		{
-			header = boost::get<std::string>(table->get(0, i));
+			LOG(warning) << "Unable to parse contract code from table";
+			continue;
 		}
-		catch(const boost::bad_get& e)
+
+		// Rows of current parameters table rarely move, so the instrument
+		// bound to the row last time is checked first
+		auto& binding = m_rowBindings[m_originRow + row];
+		const auto& key = binding.key;
+		bool bound = (binding.instrument != NoInstrument) &&
+			(key.size() == contractClassCode->size() + 1 + contractCode->size()) &&
+			(key.compare(0, contractClassCode->size(), *contractClassCode) == 0) &&
+			(key[contractClassCode->size()] == '#') &&
+			(key.compare(contractClassCode->size() + 1, std::string::npos, *contractCode) == 0);
+		if(!bound)
 		{
-			// Skip silently
+			binding.key = *contractClassCode + "#" + *contractCode;
+			binding.instrument = InstrumentRegistry::instance().id(binding.key);
 		}
-		int index = indexOf(header);
-		m_schema[index] = i;
+		m_rowInstruments[row] = binding.instrument;
 	}
 }
 
-void CurrentParameterTableParser::parseRow(int row, const XlTable::Ptr& table)
+void CurrentParameterTableParser::checkFilter()
 {
-	std::string code;
-	try
+	// Done once, on the first poke of the whole table
+	m_filterChecked = true;
+	if(m_filter.empty())
+		return;
+
+	std::vector<std::string> tickers;
+	for(const auto& binding : m_rowBindings)
 	{
-		auto contractClassCode = boost::get<std::string>(table->get(row, m_schema[ClassCode]));
-		auto contractCode = boost::get<std::string>(table->get(row, m_schema[Code]));
-		code = contractClassCode + "#" + contractCode;
+		if(binding.instrument != NoInstrument)
+			tickers.push_back(binding.key);
 	}
-	catch(const boost::bad_get& e)
+	for(const auto& rule : m_filter.unmatchedRules(tickers))
+		LOG(warning) << "Ignore rule matches no instrument in " << m_topic << ": " << rule;
+}
+
+CurrentParameterTableParser::InstrumentState& CurrentParameterTableParser::state(InstrumentId instrument, const std::string& name)
+{
+	auto& partition = m_partitions[instrument % m_partitions.size()];
+	size_t index = instrument / m_partitions.size();
+	if(index >= partition.states.size())
+		partition.states.resize(index + 1);
+
+	auto& state = partition.states[index];
+	if(state.instrument == NoInstrument)
 	{
-		LOG(warning) << "Unable to parse contract code from table";
-		return;
+		state.instrument = instrument;
+		state.suppressed = m_filter.mask(name);
 	}
+	return state;
+}
 
-	long volume = 1;
-	try
+void CurrentParameterTableParser::parsePartition(const XlTable& table, int partition, int firstRow, uint64_t timestamp)
+{
+	auto& p = m_partitions[partition];
+	for(int row = firstRow; row < (int)m_rowInstruments.size(); row++)
+	{
+		auto instrument = m_rowInstruments[row];
+		if(instrument == NoInstrument || (int)(instrument % m_partitions.size()) != partition)
+			continue;
+
+		parseRow(m_decoder.row(table, row), state(instrument, m_rowBindings[m_originRow + row].key), timestamp, p.ticks);
+		p.rowEnds.push_back(std::make_pair(row, p.ticks.size()));
+	}
+}
+
+void CurrentParameterTableParser::mergePartitions(int firstRow, int rows)
+{
+	std::vector<size_t> cursors(m_partitions.size(), 0);
+	std::vector<size_t> tickCursors(m_partitions.size(), 0);
+	for(int row = firstRow; row < rows; row++)
+	{
+		auto instrument = m_rowInstruments[row];
+		if(instrument == NoInstrument)
+			continue;
+
+		int partition = instrument % m_partitions.size();
+		auto& p = m_partitions[partition];
+		if(cursors[partition] >= p.rowEnds.size() || p.rowEnds[cursors[partition]].first != row)
+			continue;
+
+		size_t end = p.rowEnds[cursors[partition]++].second;
+		m_batch.insert(m_batch.end(), p.ticks.begin() + tickCursors[partition], p.ticks.begin() + end);
+		tickCursors[partition] = end;
+	}
+
+	for(auto& p : m_partitions)
+	{
+		p.ticks.clear();
+		p.rowEnds.clear();
+	}
+}
+
+void CurrentParameterTableParser::parseRow(const RowDecoder::Row& row, InstrumentState& state, uint64_t timestamp, std::vector<TickUpdate>& out)
+{
+	auto priceStep = row.number(PriceStep);
+	if(priceStep && *priceStep != state.priceStep)
+	{
+		state.priceStep = *priceStep;
+		auto scale = row.number(Scale);
+		InstrumentMetadata::instance().setPriceStep(state.instrument, *priceStep, scale ? (int)*scale : -1);
+	}
+
+	long volume = 0;
+	auto cumulativeVolume = row.number(Volume);
+	if(cumulativeVolume)
 	{
-		auto cumulativeVolume = boost::get<double>(table->get(row, m_schema[Volume]));
-		long lastVolume = m_volumes[code];
-		if(cumulativeVolume < lastVolume)
+		long lastVolume = state.volume;
+		if(*cumulativeVolume < lastVolume)
 		{
 			lastVolume = 0;
 		}
 		if(lastVolume == 0)
 		{
-			lastVolume = cumulativeVolume;
+			lastVolume = *cumulativeVolume;
 			volume = 0;
 		}
 		else
 		{
-			volume = cumulativeVolume - lastVolume;
+			volume = *cumulativeVolume - lastVolume;
 		}
-		m_volumes[code] = cumulativeVolume;
-	}
-	catch(const boost::bad_get& e)
-	{
-		volume = 0;
+		state.volume = *cumulativeVolume;
 	}
 
-	auto currentTime = std::chrono::system_clock::now();
-
 	goldmine::Tick tick;
-	tick.timestamp = std::chrono::system_clock::to_time_t(currentTime);
-	tick.useconds = 0;
+	tick.timestamp = timestamp / 1000000;
+	tick.useconds = timestamp % 1000000;
 
-	try
+	// Unchanged quotes are not re-emitted, except once per refresh interval
+	bool refresh = (m_refreshInterval > 0) && ((time_t)tick.timestamp - state.lastRefresh >= m_refreshInterval);
+	if(refresh)
+		state.lastRefresh = tick.timestamp;
+
+	auto lastPrice = row.number(LastPrice);
+	if(lastPrice)
 	{
 		double delta = 1;
-		auto lastPrice = boost::get<double>(table->get(row, m_schema[LastPrice]));
-		try
-		{
-			auto bidPrice = boost::get<double>(table->get(row, m_schema[Bid]));
-			auto askPrice = boost::get<double>(table->get(row, m_schema[Ask]));
+		auto bidPrice = row.number(Bid);
+		auto askPrice = row.number(Ask);
 
-			if(lastPrice == bidPrice)
+		// If we don't have best bid/ask data we should do nothing
+		if(bidPrice && askPrice)
+		{
+			if(*lastPrice == *bidPrice)
 			{
 				delta = -1;
 			}
-			else if(lastPrice == askPrice)
+			else if(*lastPrice == *askPrice)
 			{
 				delta = 1;
 			}
-			else if(lastPrice <= m_bids[code])
+			else if(*lastPrice <= state.bid)
 			{
 				delta = -1;
 			}
-			else if(lastPrice >= m_asks[code])
+			else if(*lastPrice >= state.ask)
 			{
 				delta = 1;
 			}
-			else if(lastPrice == m_prices[code])
+			else if(*lastPrice == state.last)
 			{
 				// Make a random guess
 				delta = (rand() % 2) == 0 ? 1 : -1;
 			}
 			else
 			{
-				delta = lastPrice - m_prices[code];
+				delta = *lastPrice - state.last;
 			}
 
-			m_prices[code] = lastPrice;
-			m_bids[code] = bidPrice;
-			m_asks[code] = askPrice;
+			state.last = *lastPrice;
+			state.bid = *bidPrice;
+			state.ask = *askPrice;
 
 			tick.datatype = (int)goldmine::Datatype::BestBid;
-			tick.value = bidPrice;
+			tick.value = *bidPrice;
 			tick.volume = 0;
-			emitTick(code, tick);
+			emitQuote(state, BestBidField, *bidPrice, refresh, tick, out);
 
 			tick.datatype = (int)goldmine::Datatype::BestOffer;
-			tick.value = askPrice;
+			tick.value = *askPrice;
 			tick.volume = 0;
-			emitTick(code, tick);
-
-		}
-		catch(const boost::bad_get& e)
-		{
-			// If we don't have best bid/ask data we should do nothing
+			emitQuote(state, BestOfferField, *askPrice, refresh, tick, out);
 		}
 
 		if(std::abs(volume) > 0)
 		{
 			tick.datatype = (int)goldmine::Datatype::Price;
-			tick.value = lastPrice;
+			tick.value = *lastPrice;
 			tick.volume = delta >= 0 ? volume : -volume;
-			emitTick(code, tick);
+			emitTick(state, tick, out);
 		}
 	}
-	catch(const boost::bad_get& e)
-	{
-		// Whatever
-	}
-
 
-	try
+	auto openInterest = row.number(OpenInterest);
+	if(openInterest)
 	{
-		auto openInterest = boost::get<double>(table->get(row, m_schema[OpenInterest]));
 		tick.datatype = (int)goldmine::Datatype::OpenInterest;
-		tick.value = openInterest;
+		tick.value = *openInterest;
 		tick.volume = 0;
-		emitTick(code, tick);
-	}
-	catch(const boost::bad_get& e)
-	{
+		emitQuote(state, OpenInterestField, *openInterest, refresh, tick, out);
 	}
 
-	try
+	auto totalBid = row.number(TotalBid);
+	if(totalBid)
 	{
-		auto totalBid = boost::get<double>(table->get(row, m_schema[TotalBid]));
-
 		tick.datatype = (int)goldmine::Datatype::TotalDemand;
-		tick.value = totalBid;
+		tick.value = *totalBid;
 		tick.volume = 0;
-		emitTick(code, tick);
-	}
-	catch(const boost::bad_get& e)
-	{
+		emitQuote(state, TotalDemandField, *totalBid, refresh, tick, out);
 	}
 
-	try
+	auto totalAsk = row.number(TotalAsk);
+	if(totalAsk)
 	{
-		auto totalAsk = boost::get<double>(table->get(row, m_schema[TotalAsk]));
 		tick.datatype = (int)goldmine::Datatype::TotalSupply;
-		tick.value = totalAsk;
+		tick.value = *totalAsk;
 		tick.volume = 0;
-		emitTick(code, tick);
-	}
-	catch(const boost::bad_get& e)
-	{
+		emitQuote(state, TotalSupplyField, *totalAsk, refresh, tick, out);
 	}
 }
 
-void CurrentParameterTableParser::emitTick(const std::string& ticker, goldmine::Tick& tick)
+void CurrentParameterTableParser::emitQuote(InstrumentState& state, QuoteField field, double value, bool refresh,
+		goldmine::Tick& tick, std::vector<TickUpdate>& out)
 {
-	for(const auto& filter : m_filters)
-	{
-		if(filter(ticker, (goldmine::Datatype)tick.datatype))
-			return;
-	}
-	m_datasink->incomingTick(ticker, tick);
+	if(!refresh && state.emitted[field] == value)
+		return;
+	state.emitted[field] = value;
+	emitTick(state, tick, out);
+}
+
+void CurrentParameterTableParser::emitTick(const InstrumentState& state, goldmine::Tick& tick, std::vector<TickUpdate>& out)
+{
+	if(TickFilter::suppressed(state.suppressed, tick.datatype))
+		return;
+	out.push_back(TickUpdate { state.instrument, tick });
+}
+
+void CurrentParameterTableParser::flush()
+{
+	if(m_batch.empty())
+		return;
+	m_datasink->incomingTicks(m_batch.data(), m_batch.size());
+	m_batch.clear();
 }
 
 TableParser::Ptr CurrentParameterTableParserFactory::create(const std::string& topic, const DataSink::Ptr& datasink)
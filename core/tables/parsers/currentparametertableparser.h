@@ -8,8 +8,10 @@
 #include "core/tables/datasink.h"
 #include "core/tables/tableparser.h"
 #include "core/tables/tableparserfactoryregistry.h"
+#include "core/tables/rowdecoder.h"
+#include "core/tables/tickfilter.h"
+#include "core/workerpool.h"
 
-#include <unordered_map>
 #include <memory>
 
 class CurrentParameterTableParser : public TableParser
@@ -26,24 +28,76 @@ public:
 	virtual void parseConfig(const Json::Value& root);
 
 private:
-	bool schemaObtained() const;
-	void obtainSchema(const XlTable::Ptr& table);
+	struct RowBinding
+	{
+		std::string key;
+		InstrumentId instrument;
+	};
 
-	void parseRow(int row, const XlTable::Ptr& table);
-	void emitTick(const std::string& ticker, goldmine::Tick& tick);
+	// Quote fields whose last emitted value is remembered
+	enum QuoteField
+	{
+		BestBidField = 0,
+		BestOfferField,
+		OpenInterestField,
+		TotalDemandField,
+		TotalSupplyField,
+		QuoteFieldsCount
+	};
+
+	struct InstrumentState
+	{
+		InstrumentState();
+
+		InstrumentId instrument;
+		TickFilter::Mask suppressed;
+		unsigned long volume;
+		double last;
+		double bid;
+		double ask;
+		double priceStep;
+		double emitted[QuoteFieldsCount];
+		time_t lastRefresh;
+	};
+
+	// Per-instrument state is partitioned by instrument id, so each worker
+	// owns its partition and parses without locking
+	struct Partition
+	{
+		std::vector<InstrumentState> states;
+		std::vector<TickUpdate> ticks;
+		std::vector<std::pair<int, size_t>> rowEnds;
+	};
+
+	void resolveRows(const XlTable& table, int begin, int end);
+	InstrumentState& state(InstrumentId instrument, const std::string& name);
+	void parsePartition(const XlTable& table, int partition, int firstRow, uint64_t timestamp);
+	void mergePartitions(int firstRow, int rows);
+	void checkFilter();
+
+	void parseRow(const RowDecoder::Row& row, InstrumentState& state, uint64_t timestamp, std::vector<TickUpdate>& out);
+	void emitTick(const InstrumentState& state, goldmine::Tick& tick, std::vector<TickUpdate>& out);
+	void emitQuote(InstrumentState& state, QuoteField field, double value, bool refresh,
+			goldmine::Tick& tick, std::vector<TickUpdate>& out);
+	void flush();
 
 private:
 	std::string m_topic;
-	std::unordered_map<std::string, unsigned long> m_volumes;
-	std::unordered_map<std::string, double> m_prices;
-	std::unordered_map<std::string, double> m_bids;
-	std::unordered_map<std::string, double> m_asks;
+	std::vector<RowBinding> m_rowBindings;
+	std::vector<InstrumentId> m_rowInstruments;
+	std::vector<Partition> m_partitions;
+	int m_originRow;
 
-	std::vector<int> m_schema;
+	RowDecoder m_decoder;
 
 	DataSink::Ptr m_datasink;
+	std::vector<TickUpdate> m_batch;
+	TickFilter m_filter;
+	bool m_filterChecked;
 
-	std::vector<std::function<bool(const std::string& ticker, goldmine::Datatype type)>> m_filters;
+	WorkerPool::Ptr m_pool;
+	int m_parallelThreshold;
+	int m_refreshInterval;
 };
 
 class CurrentParameterTableParserFactory : public TableParserFactory
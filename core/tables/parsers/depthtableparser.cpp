@@ -0,0 +1,161 @@
+/*
+ * depthtableparser.cpp
+ */
+
+#include "depthtableparser.h"
+
+#include "log.h"
+#include "exceptions.h"
+#include "core/tables/datatypes.h"
+
+#include <boost/align/aligned_alloc.hpp>
+
+#include <new>
+
+enum ColumnId
+{
+	BidVolume = 0,
+	Price,
+	OfferVolume,
+	MaxId
+};
+
+DepthTableParser::DepthTableParser(const std::string& topic, const DataSink::Ptr& datasink) : m_topic(topic),
+	m_datasink(datasink),
+	m_instrument(NoInstrument),
+	m_columnNames({ "BID_VOLUME", "PRICE", "OFFER_VOLUME" }),
+	m_books(nullptr),
+	m_current(0)
+{
+	LOG(trace) << "DepthTableParser: " << topic;
+
+	void* memory = boost::alignment::aligned_alloc(alignof(DepthBook), 2 * sizeof(DepthBook));
+	if(!memory)
+		throw std::bad_alloc();
+	m_books = static_cast<DepthBook*>(memory);
+	new (&m_books[0]) DepthBook();
+	new (&m_books[1]) DepthBook();
+
+	m_batch.reserve(4 * DepthBook::MaxLevels + 2);
+	m_rows.reserve(2 * DepthBook::MaxLevels + 1);
+}
+
+DepthTableParser::~DepthTableParser()
+{
+	m_books[0].~DepthBook();
+	m_books[1].~DepthBook();
+	boost::alignment::aligned_free(m_books);
+}
+
+bool DepthTableParser::acceptsTopic(const std::string& topic)
+{
+	return topic == m_topic;
+}
+
+void DepthTableParser::parseConfig(const Json::Value& root)
+{
+	auto instrument = root["instrument"].asString();
+	if(instrument.empty())
+		BOOST_THROW_EXCEPTION(ParameterError() << errinfo_str("Depth parser requires 'instrument': " + m_topic));
+	m_instrument = InstrumentRegistry::instance().id(instrument);
+
+	int levels = root.get("levels", (int)DepthBook::MaxLevels).asInt();
+	m_books[0].setDepth(levels);
+	m_books[1].setDepth(levels);
+
+	const auto& columns = root["columns"];
+	m_columnNames[BidVolume] = columns.get("bid_volume", m_columnNames[BidVolume]).asString();
+	m_columnNames[Price] = columns.get("price", m_columnNames[Price]).asString();
+	m_columnNames[OfferVolume] = columns.get("offer_volume", m_columnNames[OfferVolume]).asString();
+}
+
+void DepthTableParser::incomingTable(const XlTable::Ptr& table)
+{
+	if(m_instrument == NoInstrument)
+		return;
+
+	if(!m_decoder.compiled())
+		m_decoder.compile(*table, m_columnNames);
+
+	// A poke at the origin, with the header row, is a full snapshot and
+	// replaces the mirror; later pokes update the rows they cover
+	int originRow = table->originRow();
+	if(originRow == 0)
+		m_rows.clear();
+	if(m_rows.size() < (size_t)(originRow + table->height()))
+		m_rows.resize(originRow + table->height(), RowState { 0, 0, 0 });
+
+	for(int i = 0; i < table->height(); i++)
+	{
+		auto row = m_decoder.row(*table, i);
+		auto& state = m_rows[originRow + i];
+		// Rows without price (header, empty levels) are kept with zero
+		// volumes, so that they don't contribute to the book
+		auto price = row.number(Price);
+		state.price = price.get_value_or(0);
+		state.bidVolume = price ? row.number(BidVolume).get_value_or(0) : 0;
+		state.offerVolume = price ? row.number(OfferVolume).get_value_or(0) : 0;
+	}
+
+	const auto& previous = m_books[m_current];
+	auto& current = m_books[m_current ^ 1];
+	current.clear();
+	for(const auto& state : m_rows)
+	{
+		if(state.bidVolume > 0)
+			current.addBid(state.price, state.bidVolume);
+		if(state.offerVolume > 0)
+			current.addOffer(state.price, state.offerVolume);
+	}
+
+	auto arrival = arrivalTime(*table);
+	m_tick.timestamp = arrival / 1000000;
+	m_tick.useconds = arrival % 1000000;
+
+	DepthBook::diff(previous, current, [this](double price, int volume, int side)
+		{
+			if(volume != 0)
+				emitTick((int)goldmine::Datatype::Depth, price, volume);
+			else
+				emitTick(ExtendedDatatype::DepthRemoved, price, side);
+		});
+
+	emitTop((int)goldmine::Datatype::BestBid, previous.bids(), previous.bidsCount(), current.bids(), current.bidsCount());
+	emitTop((int)goldmine::Datatype::BestOffer, previous.offers(), previous.offersCount(), current.offers(), current.offersCount());
+
+	m_current ^= 1;
+
+	if(!m_batch.empty())
+	{
+		m_datasink->incomingTicks(m_batch.data(), m_batch.size());
+		m_batch.clear();
+	}
+}
+
+void DepthTableParser::emitTick(int datatype, double value, int volume)
+{
+	m_tick.datatype = datatype;
+	m_tick.value = value;
+	m_tick.volume = volume;
+	m_batch.push_back(TickUpdate { m_instrument, m_tick });
+}
+
+void DepthTableParser::emitTop(int datatype, const DepthLevel* previous, int previousCount, const DepthLevel* current,
+		int currentCount)
+{
+	if(currentCount > 0)
+	{
+		if(previousCount == 0 || previous[0].price != current[0].price || previous[0].volume != current[0].volume)
+			emitTick(datatype, current[0].price, current[0].volume);
+	}
+	else if(previousCount > 0)
+	{
+		// Side became empty
+		emitTick(datatype, 0, 0);
+	}
+}
+
+TableParser::Ptr DepthTableParserFactory::create(const std::string& topic, const DataSink::Ptr& datasink)
+{
+	return std::make_shared<DepthTableParser>(topic, datasink);
+}
@@ -0,0 +1,83 @@
+/*
+ * depthtableparser.h
+ */
+
+#ifndef TABLES_DEPTHTABLEPARSER_H_
+#define TABLES_DEPTHTABLEPARSER_H_
+
+#include "core/tables/datasink.h"
+#include "core/tables/tableparser.h"
+#include "core/tables/tableparserfactoryregistry.h"
+#include "core/tables/rowdecoder.h"
+#include "core/tables/depthbook.h"
+
+#include <memory>
+
+/**
+ * Parser for QUIK quotes (market depth) table. Each DDE topic carries the
+ * book of one instrument, so the instrument is taken from config:
+ *
+ * {
+ *   "type" : "depth",
+ *   "topic" : "glass-riz6",
+ *   "instrument" : "SPBFUT#RIZ6",
+ *   "levels" : 20,
+ *   "columns" : { "bid_volume" : "BID_VOLUME", "price" : "PRICE", "offer_volume" : "OFFER_VOLUME" }
+ * }
+ *
+ * Rows are kept in a per-row mirror of the table and the book is rebuilt
+ * from it. A poke starting at row 0 (with the header) is a full snapshot and
+ * replaces the mirror; a poke starting further down updates only the rows it
+ * covers. Only changed levels are emitted as Depth ticks (bids with positive, offers with negative volume), removed levels as
+ * DepthRemoved ticks (volume 1 for bid, -1 for offer), followed by
+ * BestBid/BestOffer when top of book changes. When a side of the book becomes
+ * empty, its BestBid/BestOffer is emitted with zero price and volume.
+ */
+class DepthTableParser : public TableParser
+{
+public:
+	typedef std::shared_ptr<DepthTableParser> Ptr;
+
+	DepthTableParser(const std::string& topic, const DataSink::Ptr& datasink);
+	virtual ~DepthTableParser();
+
+	virtual bool acceptsTopic(const std::string& topic);
+	virtual void incomingTable(const XlTable::Ptr& table);
+
+	virtual void parseConfig(const Json::Value& root);
+
+private:
+	struct RowState
+	{
+		double price;
+		double bidVolume;
+		double offerVolume;
+	};
+
+	void emitTick(int datatype, double value, int volume);
+	void emitTop(int datatype, const DepthLevel* previous, int previousCount, const DepthLevel* current, int currentCount);
+
+private:
+	std::string m_topic;
+	DataSink::Ptr m_datasink;
+	InstrumentId m_instrument;
+	std::vector<std::string> m_columnNames;
+
+	RowDecoder m_decoder;
+	std::vector<RowState> m_rows;
+
+	// Two books in one aligned block: previous and current snapshot
+	DepthBook* m_books;
+	int m_current;
+
+	goldmine::Tick m_tick;
+	std::vector<TickUpdate> m_batch;
+};
+
+class DepthTableParserFactory : public TableParserFactory
+{
+public:
+	virtual TableParser::Ptr create(const std::string& topic, const DataSink::Ptr& datasink) override;
+};
+
+#endif /* TABLES_DEPTHTABLEPARSER_H_ */
@@ -0,0 +1,110 @@
+/*
+ * futureslimitstableparser.cpp
+ */
+
+#include "futureslimitstableparser.h"
+
+#include "log.h"
+#include "exceptions.h"
+
+enum ColumnId
+{
+	Account = 0,
+	LimitType,
+	Limit,
+	Used,
+	Planned,
+	VariationMargin,
+	MaxId
+};
+
+static const char* gs_configKeys[] = {
+		"account",
+		"limit_type",
+		"limit",
+		"used",
+		"planned",
+		"variation_margin" };
+
+FuturesLimitsTableParser::FuturesLimitsTableParser(const std::string& topic, const PositionLedger::Ptr& ledger) : m_topic(topic),
+	m_ledger(ledger),
+	m_columnNames({ "TRDACCID", "LIMIT_TYPE", "CBPLIMIT", "CBPLUSED", "CBPLPLANNED", "VARMARGIN" })
+{
+	LOG(trace) << "FuturesLimitsTableParser: " << topic;
+}
+
+FuturesLimitsTableParser::~FuturesLimitsTableParser()
+{
+}
+
+bool FuturesLimitsTableParser::acceptsTopic(const std::string& topic)
+{
+	return topic == m_topic;
+}
+
+void FuturesLimitsTableParser::parseConfig(const Json::Value& root)
+{
+	const auto& columns = root["columns"];
+	for(int id = 0; id < MaxId; id++)
+		m_columnNames[id] = columns.get(gs_configKeys[id], m_columnNames[id]).asString();
+
+	m_limitType = root.get("limit_type", m_limitType).asString();
+	if(m_limitType.empty() && !m_columnNames[LimitType].empty())
+		BOOST_THROW_EXCEPTION(ParameterError() << errinfo_str("Futures limits parser requires 'limit_type': " + m_topic));
+}
+
+void FuturesLimitsTableParser::incomingTable(const XlTable::Ptr& table)
+{
+	if(!m_decoder.compiled())
+		m_decoder.compile(*table, m_columnNames);
+
+	// Every poke starting at the origin carries the header row
+	int originRow = table->originRow();
+	int firstRow = originRow == 0 ? 1 : 0;
+	if(m_rows.size() < (size_t)(originRow + table->height()))
+		m_rows.resize(originRow + table->height(), RowState { std::string(), 0, false, AccountLimits { 0, 0, 0, 0 } });
+
+	for(int row = firstRow; row < table->height(); row++)
+		parseRow(m_decoder.row(*table, row), m_rows[originRow + row]);
+}
+
+void FuturesLimitsTableParser::parseRow(const RowDecoder::Row& row, RowState& state)
+{
+	auto account = row.string(Account);
+	auto limit = row.number(Limit);
+	if(!account || !limit)
+		return;
+
+	if(!m_limitType.empty())
+	{
+		auto type = row.string(LimitType);
+		if(!type || *type != m_limitType)
+			return;
+	}
+
+	AccountLimits limits { *limit, row.number(Used).get_value_or(0), row.number(Planned).get_value_or(0),
+		row.number(VariationMargin).get_value_or(0) };
+
+	bool bound = state.bound && (*account == state.account);
+	if(bound && limits.limit == state.limits.limit && limits.used == state.limits.used &&
+			limits.planned == state.limits.planned && limits.variationMargin == state.limits.variationMargin)
+		return;
+
+	if(!bound)
+	{
+		state.account = *account;
+		state.accountId = m_ledger->account(*account);
+		state.bound = true;
+	}
+	state.limits = limits;
+	m_ledger->updateLimits(state.accountId, limits);
+}
+
+FuturesLimitsTableParserFactory::FuturesLimitsTableParserFactory(const PositionLedger::Ptr& ledger) : m_ledger(ledger)
+{
+}
+
+TableParser::Ptr FuturesLimitsTableParserFactory::create(const std::string& topic, const DataSink::Ptr& datasink)
+{
+	return std::make_shared<FuturesLimitsTableParser>(topic, m_ledger);
+}
@@ -0,0 +1,78 @@
+/*
+ * futureslimitstableparser.h
+ */
+
+#ifndef TABLES_FUTURESLIMITSTABLEPARSER_H_
+#define TABLES_FUTURESLIMITSTABLEPARSER_H_
+
+#include "core/tables/datasink.h"
+#include "core/tables/tableparser.h"
+#include "core/tables/tableparserfactoryregistry.h"
+#include "core/tables/rowdecoder.h"
+#include "core/positionledger.h"
+
+#include <memory>
+
+/**
+ * Parser for QUIK futures client limits table. Updates account limits in
+ * PositionLedger for rows that changed since the previous poke.
+ *
+ * {
+ *   "type" : "futures_limits",
+ *   "topic" : "limits",
+ *   "limit_type" : "Ден.средства",
+ *   "columns" : { "account" : "TRDACCID", "limit" : "CBPLIMIT", "used" : "CBPLUSED",
+ *     "planned" : "CBPLPLANNED", "variation_margin" : "VARMARGIN" }
+ * }
+ *
+ * Only rows with "limit_type" value in LIMIT_TYPE column are taken; ledger
+ * keeps one set of limits per account, so rows of different types would
+ * overwrite each other. "limit_type" may be omitted only if the table has
+ * no such column ("columns" : { "limit_type" : "" }).
+ */
+class FuturesLimitsTableParser : public TableParser
+{
+public:
+	typedef std::shared_ptr<FuturesLimitsTableParser> Ptr;
+
+	FuturesLimitsTableParser(const std::string& topic, const PositionLedger::Ptr& ledger);
+	virtual ~FuturesLimitsTableParser();
+
+	virtual bool acceptsTopic(const std::string& topic);
+	virtual void incomingTable(const XlTable::Ptr& table);
+
+	virtual void parseConfig(const Json::Value& root);
+
+private:
+	struct RowState
+	{
+		std::string account;
+		AccountId accountId;
+		bool bound;
+		AccountLimits limits;
+	};
+
+	void parseRow(const RowDecoder::Row& row, RowState& state);
+
+private:
+	std::string m_topic;
+	PositionLedger::Ptr m_ledger;
+	std::vector<std::string> m_columnNames;
+	std::string m_limitType;
+
+	RowDecoder m_decoder;
+	std::vector<RowState> m_rows;
+};
+
+class FuturesLimitsTableParserFactory : public TableParserFactory
+{
+public:
+	FuturesLimitsTableParserFactory(const PositionLedger::Ptr& ledger);
+
+	virtual TableParser::Ptr create(const std::string& topic, const DataSink::Ptr& datasink) override;
+
+private:
+	PositionLedger::Ptr m_ledger;
+};
+
+#endif /* TABLES_FUTURESLIMITSTABLEPARSER_H_ */
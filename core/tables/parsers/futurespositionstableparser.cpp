@@ -0,0 +1,139 @@
+/*
+ * futurespositionstableparser.cpp
+ */
+
+#include "futurespositionstableparser.h"
+
+#include "log.h"
+
+#include <algorithm>
+#include <cmath>
+
+enum ColumnId
+{
+	Account = 0,
+	ClassCode,
+	Code,
+	Position,
+	MaxId
+};
+
+static const char* gs_configKeys[] = {
+		"account",
+		"class_code",
+		"code",
+		"position" };
+
+FuturesPositionsTableParser::FuturesPositionsTableParser(const std::string& topic, const PositionLedger::Ptr& ledger) : m_topic(topic),
+	m_ledger(ledger),
+	m_columnNames({ "TRDACCID", "", "SEC_CODE", "TOTAL_NET" }),
+	m_classCode("SPBFUT")
+{
+	LOG(trace) << "FuturesPositionsTableParser: " << topic;
+}
+
+FuturesPositionsTableParser::~FuturesPositionsTableParser()
+{
+}
+
+bool FuturesPositionsTableParser::acceptsTopic(const std::string& topic)
+{
+	return topic == m_topic;
+}
+
+void FuturesPositionsTableParser::parseConfig(const Json::Value& root)
+{
+	const auto& columns = root["columns"];
+	for(int id = 0; id < MaxId; id++)
+		m_columnNames[id] = columns.get(gs_configKeys[id], m_columnNames[id]).asString();
+
+	m_classCode = root.get("class_code", m_classCode).asString();
+}
+
+void FuturesPositionsTableParser::incomingTable(const XlTable::Ptr& table)
+{
+	if(!m_decoder.compiled())
+		m_decoder.compile(*table, m_columnNames);
+
+	// Every poke starting at the origin carries the header row
+	int originRow = table->originRow();
+	int firstRow = originRow == 0 ? 1 : 0;
+	if(m_rows.size() < (size_t)(originRow + table->height()))
+		m_rows.resize(originRow + table->height(), RowState { std::string(), std::string(), 0, NoInstrument, 0 });
+
+	for(int row = firstRow; row < table->height(); row++)
+		parseRow(m_decoder.row(*table, row), m_rows[originRow + row]);
+
+	if(!m_released.empty())
+		closeReleased();
+
+	if(!m_updates.empty())
+	{
+		m_ledger->updatePositions(m_updates.data(), m_updates.size());
+		m_updates.clear();
+	}
+}
+
+void FuturesPositionsTableParser::parseRow(const RowDecoder::Row& row, RowState& state)
+{
+	auto account = row.string(Account);
+	auto code = row.string(Code);
+	auto position = row.number(Position);
+	if(!account || !code || account->empty() || code->empty())
+	{
+		// Row removed from the table
+		if(state.instrument != NoInstrument)
+			release(state);
+		return;
+	}
+	if(!position)
+		return;
+
+	int amount = (int)std::lround(*position);
+	bool bound = (state.instrument != NoInstrument) && (*account == state.account) && (*code == state.code);
+	if(bound && amount == state.amount)
+		return;
+
+	if(!bound)
+	{
+		if(state.instrument != NoInstrument)
+			release(state);
+
+		auto classCode = row.string(ClassCode);
+		state.account = *account;
+		state.code = *code;
+		state.accountId = m_ledger->account(*account);
+		state.instrument = InstrumentRegistry::instance().id((classCode ? *classCode : m_classCode) + "#" + *code);
+	}
+	state.amount = amount;
+	m_updates.push_back(PositionUpdate { state.accountId, state.instrument, amount });
+}
+
+void FuturesPositionsTableParser::release(RowState& state)
+{
+	m_released.push_back(PositionUpdate { state.accountId, state.instrument, 0 });
+	state = RowState { std::string(), std::string(), 0, NoInstrument, 0 };
+}
+
+void FuturesPositionsTableParser::closeReleased()
+{
+	// Rows may just have moved (QUIK keeps the table sorted), so position is
+	// closed only if no row shows it anymore
+	for(const auto& released : m_released)
+	{
+		bool shown = std::any_of(m_rows.begin(), m_rows.end(), [&](const RowState& state)
+				{ return state.instrument == released.instrument && state.accountId == released.account; });
+		if(!shown)
+			m_updates.push_back(released);
+	}
+	m_released.clear();
+}
+
+FuturesPositionsTableParserFactory::FuturesPositionsTableParserFactory(const PositionLedger::Ptr& ledger) : m_ledger(ledger)
+{
+}
+
+TableParser::Ptr FuturesPositionsTableParserFactory::create(const std::string& topic, const DataSink::Ptr& datasink)
+{
+	return std::make_shared<FuturesPositionsTableParser>(topic, m_ledger);
+}
@@ -0,0 +1,83 @@
+/*
+ * futurespositionstableparser.h
+ */
+
+#ifndef TABLES_FUTURESPOSITIONSTABLEPARSER_H_
+#define TABLES_FUTURESPOSITIONSTABLEPARSER_H_
+
+#include "core/tables/datasink.h"
+#include "core/tables/tableparser.h"
+#include "core/tables/tableparserfactoryregistry.h"
+#include "core/tables/rowdecoder.h"
+#include "core/positionledger.h"
+
+#include <memory>
+
+/**
+ * Parser for QUIK futures client positions table. Keeps PositionLedger in
+ * sync; rows whose account, contract and net position did not change since
+ * the previous poke are skipped. When a row is blanked or starts showing
+ * another account/contract, the position it showed before is zeroed unless
+ * some other row still shows it.
+ *
+ * {
+ *   "type" : "futures_positions",
+ *   "topic" : "positions",
+ *   "class_code" : "SPBFUT",
+ *   "columns" : { "account" : "TRDACCID", "code" : "SEC_CODE", "position" : "TOTAL_NET" }
+ * }
+ *
+ * If "class_code" column is configured, it takes precedence over
+ * "class_code" value.
+ */
+class FuturesPositionsTableParser : public TableParser
+{
+public:
+	typedef std::shared_ptr<FuturesPositionsTableParser> Ptr;
+
+	FuturesPositionsTableParser(const std::string& topic, const PositionLedger::Ptr& ledger);
+	virtual ~FuturesPositionsTableParser();
+
+	virtual bool acceptsTopic(const std::string& topic);
+	virtual void incomingTable(const XlTable::Ptr& table);
+
+	virtual void parseConfig(const Json::Value& root);
+
+private:
+	struct RowState
+	{
+		std::string account;
+		std::string code;
+		AccountId accountId;
+		InstrumentId instrument;
+		int amount;
+	};
+
+	void parseRow(const RowDecoder::Row& row, RowState& state);
+	void release(RowState& state);
+	void closeReleased();
+
+private:
+	std::string m_topic;
+	PositionLedger::Ptr m_ledger;
+	std::vector<std::string> m_columnNames;
+	std::string m_classCode;
+
+	RowDecoder m_decoder;
+	std::vector<RowState> m_rows;
+	std::vector<PositionUpdate> m_updates;
+	std::vector<PositionUpdate> m_released;
+};
+
+class FuturesPositionsTableParserFactory : public TableParserFactory
+{
+public:
+	FuturesPositionsTableParserFactory(const PositionLedger::Ptr& ledger);
+
+	virtual TableParser::Ptr create(const std::string& topic, const DataSink::Ptr& datasink) override;
+
+private:
+	PositionLedger::Ptr m_ledger;
+};
+
+#endif /* TABLES_FUTURESPOSITIONSTABLEPARSER_H_ */
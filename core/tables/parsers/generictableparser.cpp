@@ -0,0 +1,234 @@
+/*
+ * generictableparser.cpp
+ */
+
+#include "generictableparser.h"
+#include "core/tables/datatypes.h"
+
+#include "log.h"
+#include "exceptions.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+static const int gs_noColumn = -1;
+
+static bool parseDigits(const char* p, int count, int& result)
+{
+	result = 0;
+	for(int i = 0; i < count; i++)
+	{
+		if(p[i] < '0' || p[i] > '9')
+			return false;
+		result = result * 10 + (p[i] - '0');
+	}
+	return true;
+}
+
+GenericTableParser::GenericTableParser(const std::string& topic, const DataSink::Ptr& datasink) : m_topic(topic),
+	m_datasink(datasink),
+	m_dateColumn(gs_noColumn),
+	m_timeColumn(gs_noColumn),
+	m_usecColumn(gs_noColumn),
+	m_headerRow(0),
+	m_dayStart(0)
+{
+	LOG(trace) << "GenericTableParser: " << topic;
+}
+
+GenericTableParser::~GenericTableParser()
+{
+}
+
+bool GenericTableParser::acceptsTopic(const std::string& topic)
+{
+	return topic == m_topic;
+}
+
+int GenericTableParser::addColumn(const std::string& name)
+{
+	if(name.empty())
+		return gs_noColumn;
+
+	auto it = std::find(m_columnNames.begin(), m_columnNames.end(), name);
+	if(it != m_columnNames.end())
+		return std::distance(m_columnNames.begin(), it);
+
+	m_columnNames.push_back(name);
+	return m_columnNames.size() - 1;
+}
+
+void GenericTableParser::parseConfig(const Json::Value& root)
+{
+	const auto& instrument = root["instrument"];
+	if(instrument.isString())
+	{
+		m_instrumentColumns.push_back(addColumn(instrument.asString()));
+	}
+	else if(instrument.isArray())
+	{
+		for(const auto& column : instrument)
+			m_instrumentColumns.push_back(addColumn(column.asString()));
+	}
+	if(m_instrumentColumns.empty())
+		BOOST_THROW_EXCEPTION(ParameterError() << errinfo_str("Generic parser requires 'instrument' columns: " + m_topic));
+
+	m_dateColumn = addColumn(root["date"].asString());
+	m_timeColumn = addColumn(root["time"].asString());
+	m_usecColumn = addColumn(root["usec"].asString());
+	if((m_dateColumn == gs_noColumn) != (m_timeColumn == gs_noColumn))
+		BOOST_THROW_EXCEPTION(ParameterError() << errinfo_str("Generic parser requires both 'date' and 'time' columns: " + m_topic));
+
+	m_headerRow = root.get("header_row", 0).asInt();
+
+	for(const auto& fieldConfig : root["fields"])
+	{
+		Field field;
+		field.column = addColumn(fieldConfig["column"].asString());
+		if(field.column == gs_noColumn)
+			BOOST_THROW_EXCEPTION(ParameterError() << errinfo_str("Generic parser field without column: " + m_topic));
+		field.datatype = (int)deserializeDatatype(fieldConfig["datatype"].asString());
+		field.volumeColumn = addColumn(fieldConfig["volume"].asString());
+		field.cumulativeVolume = fieldConfig.get("cumulative_volume", false).asBool();
+
+		auto emit = fieldConfig.get("emit", "always").asString();
+		if(emit != "always" && emit != "on_change")
+			BOOST_THROW_EXCEPTION(ParameterError() << errinfo_str("Invalid emit rule: " + emit));
+		field.onChange = emit == "on_change";
+
+		m_fields.push_back(field);
+	}
+	if(m_fields.empty())
+		BOOST_THROW_EXCEPTION(ParameterError() << errinfo_str("Generic parser requires at least one field: " + m_topic));
+}
+
+void GenericTableParser::incomingTable(const XlTable::Ptr& table)
+{
+	if(!m_decoder.compiled())
+		m_decoder.compile(*table, m_columnNames, m_headerRow);
+
+	// Every poke covering the header row carries it and the rows above it
+	int firstRow = std::max(m_headerRow + 1 - table->originRow(), 0);
+
+	auto arrival = arrivalTime(*table);
+	for(int row = firstRow; row < table->height(); row++)
+		parseRow(m_decoder.row(*table, row), arrival);
+
+	if(!m_batch.empty())
+	{
+		m_datasink->incomingTicks(m_batch.data(), m_batch.size());
+		m_batch.clear();
+	}
+}
+
+void GenericTableParser::parseRow(const RowDecoder::Row& row, uint64_t arrival)
+{
+	m_key.clear();
+	for(auto column : m_instrumentColumns)
+	{
+		auto part = row.string(column);
+		if(!part)
+			return;
+		if(!m_key.empty())
+			m_key.push_back('#');
+		m_key.append(*part);
+	}
+
+	auto& state = m_instruments[m_key];
+	if(state.instrument == NoInstrument)
+	{
+		state.instrument = InstrumentRegistry::instance().id(m_key);
+		state.slot = m_fieldStates.size();
+		m_fieldStates.resize(m_fieldStates.size() + m_fields.size(), FieldState { 0, 0, false });
+	}
+
+	goldmine::Tick tick;
+	if(m_dateColumn != gs_noColumn)
+	{
+		if(!rowTimestamp(row, tick))
+			return;
+	}
+	else
+	{
+		tick.timestamp = arrival / 1000000;
+		tick.useconds = arrival % 1000000;
+	}
+
+	for(size_t i = 0; i < m_fields.size(); i++)
+	{
+		const auto& field = m_fields[i];
+		auto& fieldState = m_fieldStates[state.slot + i];
+
+		auto value = row.number(field.column);
+		if(!value)
+			continue;
+
+		long volume = 0;
+		if(field.volumeColumn != gs_noColumn)
+		{
+			auto rowVolume = row.number(field.volumeColumn);
+			if(rowVolume)
+			{
+				volume = *rowVolume;
+				if(field.cumulativeVolume)
+				{
+					// Counter reset (new session) or first sight: nothing traded since last update
+					volume = (*rowVolume < fieldState.lastVolume || !fieldState.seen) ? 0 : *rowVolume - fieldState.lastVolume;
+					fieldState.lastVolume = *rowVolume;
+				}
+			}
+		}
+
+		if(field.onChange && fieldState.seen && fieldState.lastValue == *value && volume == 0)
+			continue;
+
+		fieldState.lastValue = *value;
+		fieldState.seen = true;
+
+		tick.datatype = field.datatype;
+		tick.value = *value;
+		tick.volume = volume;
+		m_batch.push_back(TickUpdate { state.instrument, tick });
+	}
+}
+
+bool GenericTableParser::rowTimestamp(const RowDecoder::Row& row, goldmine::Tick& tick)
+{
+	auto date = row.string(m_dateColumn);
+	auto time = row.string(m_timeColumn);
+	if(!date || !time || date->size() != 10 || time->size() < 8)
+		return false;
+
+	if(*date != m_lastDate)
+	{
+		struct tm t = {};
+		if(!parseDigits(date->c_str(), 2, t.tm_mday) || !parseDigits(date->c_str() + 3, 2, t.tm_mon) ||
+				!parseDigits(date->c_str() + 6, 4, t.tm_year))
+			return false;
+		t.tm_year -= 1900;
+		t.tm_mon -= 1;
+		t.tm_isdst = -1;
+		m_dayStart = mktime(&t);
+		m_lastDate = *date;
+	}
+
+	int hour, minute, second;
+	const char* tstr = time->c_str();
+	if(!parseDigits(tstr, 2, hour) || !parseDigits(tstr + 3, 2, minute) || !parseDigits(tstr + 6, 2, second))
+		return false;
+
+	tick.timestamp = m_dayStart + hour * 3600 + minute * 60 + second;
+	tick.useconds = 0;
+	if(m_usecColumn != gs_noColumn)
+	{
+		auto usec = row.number(m_usecColumn);
+		if(usec)
+			tick.useconds = *usec;
+	}
+	return true;
+}
+
+TableParser::Ptr GenericTableParserFactory::create(const std::string& topic, const DataSink::Ptr& datasink)
+{
+	return std::make_shared<GenericTableParser>(topic, datasink);
+}
@@ -0,0 +1,104 @@
+/*
+ * generictableparser.h
+ */
+
+#ifndef TABLES_GENERICTABLEPARSER_H_
+#define TABLES_GENERICTABLEPARSER_H_
+
+#include "core/tables/datasink.h"
+#include "core/tables/tableparser.h"
+#include "core/tables/tableparserfactoryregistry.h"
+#include "core/tables/flatstringmap.h"
+#include "core/tables/rowdecoder.h"
+
+#include <ctime>
+#include <memory>
+
+/**
+ * Parser for tables described entirely in the tables config:
+ *
+ * {
+ *   "type" : "generic",
+ *   "topic" : "indices",
+ *   "instrument" : ["CLASS_CODE", "CODE"],
+ *   "date" : "TRADEDATE", "time" : "TIME", "usec" : "TRADETIME_MSEC",
+ *   "fields" : [
+ *     { "column" : "last", "datatype" : "price", "volume" : "voltoday", "cumulative_volume" : true },
+ *     { "column" : "bid", "datatype" : "best_bid", "emit" : "on_change" }
+ *   ]
+ * }
+ *
+ * Instrument columns are joined with '#'. Timestamp columns are optional; if
+ * absent, arrival time is used. "emit" is either "always" (default) or
+ * "on_change". "header_row" (default 0) selects the header row of the first
+ * table. The config is compiled into a RowDecoder on the first table.
+ */
+class GenericTableParser : public TableParser
+{
+public:
+	typedef std::shared_ptr<GenericTableParser> Ptr;
+
+	GenericTableParser(const std::string& topic, const DataSink::Ptr& datasink);
+	virtual ~GenericTableParser();
+
+	virtual bool acceptsTopic(const std::string& topic);
+	virtual void incomingTable(const XlTable::Ptr& table);
+
+	virtual void parseConfig(const Json::Value& root);
+
+private:
+	struct Field
+	{
+		int column;
+		int volumeColumn;
+		int datatype;
+		bool cumulativeVolume;
+		bool onChange;
+	};
+
+	struct FieldState
+	{
+		double lastValue;
+		double lastVolume;
+		bool seen;
+	};
+
+	struct InstrumentState
+	{
+		InstrumentId instrument;
+		size_t slot;
+	};
+
+	int addColumn(const std::string& name);
+	void parseRow(const RowDecoder::Row& row, uint64_t arrival);
+	bool rowTimestamp(const RowDecoder::Row& row, goldmine::Tick& tick);
+
+private:
+	std::string m_topic;
+	DataSink::Ptr m_datasink;
+
+	std::vector<std::string> m_columnNames;
+	std::vector<int> m_instrumentColumns;
+	int m_dateColumn;
+	int m_timeColumn;
+	int m_usecColumn;
+	std::vector<Field> m_fields;
+	int m_headerRow;
+
+	RowDecoder m_decoder;
+	FlatStringMap<InstrumentState> m_instruments;
+	std::vector<FieldState> m_fieldStates;
+	std::vector<TickUpdate> m_batch;
+	std::string m_key;
+
+	std::string m_lastDate;
+	time_t m_dayStart;
+};
+
+class GenericTableParserFactory : public TableParserFactory
+{
+public:
+	virtual TableParser::Ptr create(const std::string& topic, const DataSink::Ptr& datasink) override;
+};
+
+#endif /* TABLES_GENERICTABLEPARSER_H_ */
@@ -0,0 +1,216 @@
+/*
+ * optionsboardtableparser.cpp
+ */
+
+#include "optionsboardtableparser.h"
+#include "core/tables/datatypes.h"
+
+#include "log.h"
+#include "exceptions.h"
+
+#include <cmath>
+
+enum ColumnId
+{
+	ClassCode = 0,
+	Code,
+	Strike,
+	OptionType,
+	Underlying,
+	DaysToExpiry,
+	Bid,
+	Offer,
+	LastPrice,
+	UnderlyingPrice,
+	MaxId
+};
+
+static const char* gs_configKeys[] = {
+		"class_code",
+		"code",
+		"strike",
+		"option_type",
+		"underlying",
+		"days_to_expiry",
+		"bid",
+		"offer",
+		"last",
+		"underlying_price" };
+
+// Options expiring today still have some hours left
+static const double gs_minDaysToExpiry = 0.25;
+
+static double optionSide(const std::string& type)
+{
+	if(type.empty())
+		return 0;
+	unsigned char c = type[0];
+	// UTF-8 Cyrillic letters start with 0xD0
+	if(c == 0xD0 && type.size() > 1)
+		c = (unsigned char)type[1] == 0x9A ? 0xCA : (unsigned char)type[1] == 0x9F ? 0xCF : 0;
+	// Latin or cp1251 "Колл"/"Пут"
+	if(c == 'C' || c == 'c' || c == 0xCA || c == 0xEA)
+		return 1;
+	if(c == 'P' || c == 'p' || c == 0xCF || c == 0xEF)
+		return -1;
+	return 0;
+}
+
+OptionsBoardTableParser::OptionsBoardTableParser(const std::string& topic, const DataSink::Ptr& datasink,
+		const QuoteTable::Ptr& quoteTable) : m_topic(topic),
+	m_datasink(datasink),
+	m_quoteTable(quoteTable),
+	m_columnNames({ "CLASS_CODE", "CODE", "STRIKE", "OPTIONTYPE", "OPTIONBASE", "DAYS_TO_MAT_DATE",
+			"bid", "offer", "last", "" }),
+	m_underlyingClass("SPBFUT")
+{
+	LOG(trace) << "OptionsBoardTableParser: " << topic;
+}
+
+OptionsBoardTableParser::~OptionsBoardTableParser()
+{
+}
+
+bool OptionsBoardTableParser::acceptsTopic(const std::string& topic)
+{
+	return topic == m_topic;
+}
+
+void OptionsBoardTableParser::parseConfig(const Json::Value& root)
+{
+	const auto& columns = root["columns"];
+	for(int id = 0; id < MaxId; id++)
+		m_columnNames[id] = columns.get(gs_configKeys[id], m_columnNames[id]).asString();
+
+	m_underlyingClass = root.get("underlying_class", m_underlyingClass).asString();
+	m_model = Black76(root.get("rate", 0.0).asDouble(), root.get("iterations", 12).asInt());
+}
+
+void OptionsBoardTableParser::incomingTable(const XlTable::Ptr& table)
+{
+	if(!m_decoder.compiled())
+		m_decoder.compile(*table, m_columnNames);
+
+	m_batch.clear();
+	m_batchInstruments.clear();
+	m_underlyingPrices.clear();
+
+	for(int row = 0; row < table->height(); row++)
+		parseRow(m_decoder.row(*table, row));
+
+	if(m_batchInstruments.empty())
+		return;
+
+	m_model.solve(m_batch);
+
+	auto arrival = arrivalTime(*table);
+	m_tick.timestamp = arrival / 1000000;
+	m_tick.useconds = arrival % 1000000;
+	m_tick.volume = 0;
+	for(size_t i = 0; i < m_batchInstruments.size(); i++)
+	{
+		if(!m_batch.valid[i])
+			continue;
+		auto instrument = m_batchInstruments[i];
+		emitTick(instrument, ExtendedDatatype::ImpliedVolatility, 100 * m_batch.volatility[i]);
+		emitTick(instrument, ExtendedDatatype::Delta, m_batch.delta[i]);
+		emitTick(instrument, ExtendedDatatype::Gamma, m_batch.gamma[i]);
+		emitTick(instrument, ExtendedDatatype::Vega, m_batch.vega[i]);
+	}
+
+	if(!m_ticks.empty())
+	{
+		m_datasink->incomingTicks(m_ticks.data(), m_ticks.size());
+		m_ticks.clear();
+	}
+}
+
+void OptionsBoardTableParser::parseRow(const RowDecoder::Row& row)
+{
+	auto classCode = row.string(ClassCode);
+	auto code = row.string(Code);
+	auto strike = row.number(Strike);
+	auto type = row.string(OptionType);
+	auto days = row.number(DaysToExpiry);
+	if(!classCode || !code || !strike || !type || !days || *strike <= 0 || *days < 0)
+		return;
+
+	double side = optionSide(*type);
+	if(side == 0)
+		return;
+
+	m_key = *classCode + "#" + *code;
+	auto& state = m_options[m_key];
+	if(state.instrument == NoInstrument)
+	{
+		state.instrument = InstrumentRegistry::instance().id(m_key);
+		auto underlying = row.string(Underlying);
+		if(underlying)
+			state.underlying = InstrumentRegistry::instance().id(m_underlyingClass + "#" + *underlying);
+	}
+
+	auto bid = row.number(Bid);
+	auto offer = row.number(Offer);
+	auto last = row.number(LastPrice);
+	double premium = 0;
+	if(bid && offer && *bid > 0 && *offer > 0)
+		premium = 0.5 * (*bid + *offer);
+	else if(last)
+		premium = *last;
+	if(premium <= 0)
+		return;
+
+	double forward = 0;
+	auto rowForward = row.number(UnderlyingPrice);
+	if(rowForward)
+		forward = *rowForward;
+	else if(state.underlying != NoInstrument)
+		forward = underlyingPrice(state.underlying);
+	if(forward <= 0)
+		return;
+
+	double time = std::max(*days, gs_minDaysToExpiry) / 365.;
+	if(forward == state.forward && *strike == state.strike && time == state.time && premium == state.premium && side == state.side)
+		return;
+
+	state.forward = forward;
+	state.strike = *strike;
+	state.time = time;
+	state.premium = premium;
+	state.side = side;
+
+	m_batch.add(forward, *strike, time, premium, side);
+	m_batchInstruments.push_back(state.instrument);
+}
+
+double OptionsBoardTableParser::underlyingPrice(InstrumentId underlying)
+{
+	// Boards have few underlyings; avoid taking QuoteTable lock for every row
+	for(const auto& cached : m_underlyingPrices)
+	{
+		if(cached.first == underlying)
+			return cached.second;
+	}
+
+	double price = 0;
+	if(m_quoteTable)
+		price = m_quoteTable->lastQuote(underlying, goldmine::Datatype::Price).value.toDouble();
+	m_underlyingPrices.push_back(std::make_pair(underlying, price));
+	return price;
+}
+
+void OptionsBoardTableParser::emitTick(InstrumentId instrument, int datatype, double value)
+{
+	m_tick.datatype = datatype;
+	m_tick.value = value;
+	m_ticks.push_back(TickUpdate { instrument, m_tick });
+}
+
+OptionsBoardTableParserFactory::OptionsBoardTableParserFactory(const QuoteTable::Ptr& quoteTable) : m_quoteTable(quoteTable)
+{
+}
+
+TableParser::Ptr OptionsBoardTableParserFactory::create(const std::string& topic, const DataSink::Ptr& datasink)
+{
+	return std::make_shared<OptionsBoardTableParser>(topic, datasink, m_quoteTable);
+}
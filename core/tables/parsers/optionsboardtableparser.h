@@ -0,0 +1,90 @@
+/*
+ * optionsboardtableparser.h
+ */
+
+#ifndef TABLES_OPTIONSBOARDTABLEPARSER_H_
+#define TABLES_OPTIONSBOARDTABLEPARSER_H_
+
+#include "core/tables/datasink.h"
+#include "core/tables/tableparser.h"
+#include "core/tables/tableparserfactoryregistry.h"
+#include "core/tables/flatstringmap.h"
+#include "core/tables/rowdecoder.h"
+#include "core/pricing/black76.h"
+#include "core/quotetable.h"
+
+#include <memory>
+
+/**
+ * Parser for options board (current parameters of options). For every row
+ * whose inputs changed since the previous poke it computes implied
+ * volatility (in percent), delta, gamma and vega with Black-76 and emits them
+ * as ExtendedDatatype ticks of the option.
+ *
+ * Underlying price is taken from "underlying_price" column if configured,
+ * otherwise from the last Price in QuoteTable for
+ * "<underlying_class>#<underlying column>". Premium is the bid/offer mid when
+ * both are present, otherwise last price.
+ */
+class OptionsBoardTableParser : public TableParser
+{
+public:
+	typedef std::shared_ptr<OptionsBoardTableParser> Ptr;
+
+	OptionsBoardTableParser(const std::string& topic, const DataSink::Ptr& datasink, const QuoteTable::Ptr& quoteTable);
+	virtual ~OptionsBoardTableParser();
+
+	virtual bool acceptsTopic(const std::string& topic);
+	virtual void incomingTable(const XlTable::Ptr& table);
+
+	virtual void parseConfig(const Json::Value& root);
+
+private:
+	struct OptionState
+	{
+		InstrumentId instrument;
+		InstrumentId underlying;
+		double forward;
+		double strike;
+		double time;
+		double premium;
+		double side;
+	};
+
+	void parseRow(const RowDecoder::Row& row);
+	double underlyingPrice(InstrumentId underlying);
+	void emitTick(InstrumentId instrument, int datatype, double value);
+
+private:
+	std::string m_topic;
+	DataSink::Ptr m_datasink;
+	QuoteTable::Ptr m_quoteTable;
+	std::vector<std::string> m_columnNames;
+	std::string m_underlyingClass;
+	Black76 m_model;
+
+	RowDecoder m_decoder;
+	FlatStringMap<OptionState> m_options;
+	std::string m_key;
+
+	// Options to be solved in this poke, in batch order
+	OptionBatch m_batch;
+	std::vector<InstrumentId> m_batchInstruments;
+	std::vector<std::pair<InstrumentId, double>> m_underlyingPrices;
+
+	goldmine::Tick m_tick;
+	std::vector<TickUpdate> m_ticks;
+};
+
+class OptionsBoardTableParserFactory : public TableParserFactory
+{
+public:
+	OptionsBoardTableParserFactory(const QuoteTable::Ptr& quoteTable);
+
+	virtual TableParser::Ptr create(const std::string& topic, const DataSink::Ptr& datasink) override;
+
+private:
+	QuoteTable::Ptr m_quoteTable;
+};
+
+#endif /* TABLES_OPTIONSBOARDTABLEPARSER_H_ */
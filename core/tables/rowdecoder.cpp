@@ -0,0 +1,37 @@
+/*
+ * rowdecoder.cpp
+ */
+
+#include "rowdecoder.h"
+
+#include "log.h"
+
+#include <algorithm>
+
+RowDecoder::RowDecoder()
+{
+}
+
+RowDecoder::~RowDecoder()
+{
+}
+
+void RowDecoder::compile(const XlTable& table, const std::vector<std::string>& columnNames, int headerRow)
+{
+	m_columns.assign(columnNames.size(), -1);
+	if(table.height() <= headerRow)
+		return;
+
+	for(int i = 0; i < table.width(); i++)
+	{
+		auto header = boost::get<std::string>(&table.cell(headerRow, i));
+		if(!header || header->empty())
+			continue;
+
+		auto it = std::find(columnNames.begin(), columnNames.end(), *header);
+		if(it != columnNames.end())
+			m_columns[std::distance(columnNames.begin(), it)] = i;
+
+		LOG(debug) << "[" << *header << "] -> " << (it != columnNames.end() ? std::distance(columnNames.begin(), it) : -1);
+	}
+}
@@ -0,0 +1,99 @@
+/*
+ * rowdecoder.h
+ */
+
+#ifndef TABLES_ROWDECODER_H_
+#define TABLES_ROWDECODER_H_
+
+#include "xl/xltable.h"
+
+#include <boost/optional.hpp>
+
+#include <string>
+#include <vector>
+
+/**
+ * Maps parser column ids to table columns and gives non-throwing typed
+ * access to cells. Compiled once from the table header; columns that are
+ * absent in the table are known up front, so accessing them costs nothing.
+ */
+class RowDecoder
+{
+public:
+	class Row
+	{
+	public:
+		Row(const RowDecoder& decoder, const XlTable& table, int row) : m_decoder(decoder),
+			m_table(table),
+			m_row(row)
+		{
+		}
+
+		const XlTable::XlCell* cell(int id) const
+		{
+			int column = m_decoder.m_columns[id];
+			if(column < 0)
+				return nullptr;
+			return &m_table.cell(m_row, column);
+		}
+
+		boost::optional<double> number(int id) const
+		{
+			auto c = cell(id);
+			if(!c)
+				return boost::none;
+			if(auto d = boost::get<double>(c))
+				return *d;
+			if(auto i = boost::get<int>(c))
+				return (double)*i;
+			return boost::none;
+		}
+
+		const std::string* string(int id) const
+		{
+			auto c = cell(id);
+			if(!c)
+				return nullptr;
+			return boost::get<std::string>(c);
+		}
+
+		int index() const
+		{
+			return m_row;
+		}
+
+	private:
+		const RowDecoder& m_decoder;
+		const XlTable& m_table;
+		int m_row;
+	};
+
+	RowDecoder();
+	virtual ~RowDecoder();
+
+	/**
+	 * Builds mapping from header row of the table. columnNames[id] is the
+	 * header of the column with the given id.
+	 */
+	void compile(const XlTable& table, const std::vector<std::string>& columnNames, int headerRow = 0);
+
+	bool compiled() const
+	{
+		return !m_columns.empty();
+	}
+
+	bool hasColumn(int id) const
+	{
+		return m_columns[id] >= 0;
+	}
+
+	Row row(const XlTable& table, int row) const
+	{
+		return Row(*this, table, row);
+	}
+
+private:
+	std::vector<int> m_columns;
+};
+
+#endif /* TABLES_ROWDECODER_H_ */
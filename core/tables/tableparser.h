@@ -6,6 +6,7 @@
 #define TABLES_TABLEPARSER_H_
 
 #include "xl/xltable.h"
+#include "core/gatewayclock.h"
 #include "json.h"
 #include <memory>
 
@@ -21,6 +22,17 @@ public:
 	virtual void incomingTable(const XlTable::Ptr& table) = 0;
 
 	virtual void parseConfig(const Json::Value& root) = 0;
+
+protected:
+	/**
+	 * Timestamp for ticks of the table: its arrival time, or current time
+	 * if the table wasn't stamped, in microseconds since epoch
+	 */
+	static uint64_t arrivalTime(const XlTable& table)
+	{
+		auto arrival = table.arrivalTime();
+		return arrival != 0 ? arrival : GatewayClock::systemMicroseconds();
+	}
 };
 
 #endif /* TABLES_TABLEPARSER_H_ */
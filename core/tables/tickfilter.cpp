@@ -0,0 +1,131 @@
+/*
+ * tickfilter.cpp
+ */
+
+#include "tickfilter.h"
+
+#include "exceptions.h"
+
+#include <algorithm>
+
+TickFilter::TickFilter() : m_empty(true)
+{
+	m_nodes.push_back(Node { {}, 0, 0 });
+}
+
+TickFilter::~TickFilter()
+{
+}
+
+void TickFilter::addRule(const std::string& rule)
+{
+	auto slash = rule.find('/');
+	auto pattern = rule.substr(0, slash);
+	Mask datatypes = AllDatatypes;
+	if(slash != std::string::npos)
+	{
+		datatypes = datatypeBit((int)deserializeDatatype(rule.substr(slash + 1)));
+		if(datatypes == datatypeBit(-1))
+			BOOST_THROW_EXCEPTION(ParameterError() << errinfo_str("Datatype can't be filtered separately: " + rule));
+	}
+
+	bool wildcard = !pattern.empty() && pattern.back() == '*';
+	if(wildcard)
+		pattern.pop_back();
+	if(pattern.find('*') != std::string::npos || (pattern.empty() && !wildcard))
+		BOOST_THROW_EXCEPTION(ParameterError() << errinfo_str("Invalid filter rule: " + rule));
+
+	int node = 0;
+	for(char c : pattern)
+		node = addChild(node, c);
+
+	if(wildcard)
+		m_nodes[node].prefixMask |= datatypes;
+	else
+		m_nodes[node].exactMask |= datatypes;
+	m_rules.push_back(Rule { rule, node, wildcard });
+	m_empty = false;
+}
+
+TickFilter::Mask TickFilter::mask(const std::string& ticker) const
+{
+	const char* begin = ticker.data();
+	const char* end = begin + ticker.size();
+	Mask result = match(begin, end);
+	const char* code = std::find(begin, end, '#');
+	if(code != end)
+		result |= match(code + 1, end);
+	return result;
+}
+
+std::vector<std::string> TickFilter::unmatchedRules(const std::vector<std::string>& tickers) const
+{
+	// Nodes reached by some ticker (prefix rules match) and nodes where some
+	// ticker ends (exact rules match)
+	std::vector<char> reached(m_nodes.size(), 0);
+	std::vector<char> ended(m_nodes.size(), 0);
+	reached[0] = 1;
+	for(const auto& ticker : tickers)
+	{
+		const char* end = ticker.data() + ticker.size();
+		const char* code = std::find(ticker.data(), end, '#');
+		for(const char* begin : { ticker.data(), code != end ? code + 1 : nullptr })
+		{
+			if(!begin)
+				continue;
+			int node = 0;
+			for(const char* p = begin; p != end && node >= 0; p++)
+			{
+				node = child(node, *p);
+				if(node >= 0)
+					reached[node] = 1;
+			}
+			if(node >= 0)
+				ended[node] = 1;
+		}
+	}
+
+	std::vector<std::string> result;
+	for(const auto& rule : m_rules)
+	{
+		if(!(rule.wildcard ? reached : ended)[rule.node])
+			result.push_back(rule.text);
+	}
+	return result;
+}
+
+TickFilter::Mask TickFilter::match(const char* begin, const char* end) const
+{
+	Mask result = m_nodes[0].prefixMask;
+	int node = 0;
+	for(const char* p = begin; p != end; p++)
+	{
+		node = child(node, *p);
+		if(node < 0)
+			return result;
+		result |= m_nodes[node].prefixMask;
+	}
+	return result | m_nodes[node].exactMask;
+}
+
+int TickFilter::child(int node, char c) const
+{
+	const auto& children = m_nodes[node].children;
+	auto it = std::lower_bound(children.begin(), children.end(), std::make_pair(c, 0));
+	if(it != children.end() && it->first == c)
+		return it->second;
+	return -1;
+}
+
+int TickFilter::addChild(int node, char c)
+{
+	int existing = child(node, c);
+	if(existing >= 0)
+		return existing;
+
+	int created = m_nodes.size();
+	m_nodes.push_back(Node { {}, 0, 0 });
+	auto& children = m_nodes[node].children;
+	children.insert(std::lower_bound(children.begin(), children.end(), std::make_pair(c, 0)), std::make_pair(c, created));
+	return created;
+}
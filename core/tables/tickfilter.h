@@ -0,0 +1,97 @@
+/*
+ * tickfilter.h
+ */
+
+#ifndef TABLES_TICKFILTER_H_
+#define TABLES_TICKFILTER_H_
+
+#include "core/tables/datatypes.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Compiled list of ignore rules of form "<pattern>[/<datatype>]", e.g.
+ * "SPBFUT#RIZ6" or "SPBFUT#RIZ6/price". Trailing '*' in the pattern matches
+ * any suffix. Pattern is matched against both the full "CLASS#CODE" name and
+ * the code alone, so rules written with bare codes (e.g. "RIZ6")
+ * keep working. Rules are stored in a prefix trie and
+ * evaluated once per instrument into a mask of suppressed datatypes, so
+ * checking a tick is a single AND.
+ */
+class TickFilter
+{
+public:
+	typedef uint64_t Mask;
+
+	static const Mask AllDatatypes = ~(Mask)0;
+
+	static const int ExtendedBits = 48;
+	static const int OtherBit = 63;
+
+	TickFilter();
+	virtual ~TickFilter();
+
+	/**
+	 * Adds rule "<pattern>[/<datatype>]". Throws ParameterError on malformed
+	 * rule or if datatype has no bit of its own.
+	 */
+	void addRule(const std::string& rule);
+
+	bool empty() const
+	{
+		return m_empty;
+	}
+
+	Mask mask(const std::string& ticker) const;
+
+	/**
+	 * Rules which match none of given tickers
+	 */
+	std::vector<std::string> unmatchedRules(const std::vector<std::string>& tickers) const;
+
+	static Mask datatypeBit(int datatype)
+	{
+		// Upstream datatypes take low bits, extended ones the bits from
+		// ExtendedBits up; bit 63 covers every datatype without a bit of its own
+		if(datatype >= 0 && datatype < ExtendedBits)
+			return (Mask)1 << datatype;
+		int extended = datatype - ExtendedDatatype::First;
+		if(extended >= 0 && extended < OtherBit - ExtendedBits)
+			return (Mask)1 << (ExtendedBits + extended);
+		return (Mask)1 << OtherBit;
+	}
+
+	static bool suppressed(Mask mask, int datatype)
+	{
+		return (mask & datatypeBit(datatype)) != 0;
+	}
+
+private:
+	struct Node
+	{
+		std::vector<std::pair<char, int>> children;
+		Mask prefixMask;
+		Mask exactMask;
+	};
+
+	struct Rule
+	{
+		std::string text;
+		int node;
+		bool wildcard;
+	};
+
+	Mask match(const char* begin, const char* end) const;
+	int child(int node, char c) const;
+	int addChild(int node, char c);
+
+private:
+	std::vector<Node> m_nodes;
+	std::vector<Rule> m_rules;
+	bool m_empty;
+};
+
+#endif /* TABLES_TICKFILTER_H_ */
@@ -0,0 +1,113 @@
+/*
+ * tradededupindex.cpp
+ */
+
+#include "tradededupindex.h"
+
+#include "log.h"
+
+#include <boost/filesystem.hpp>
+
+#include <cstring>
+#include <fstream>
+
+using namespace boost::interprocess;
+
+static const uint32_t gs_magic = 0x58444454; // "TDDX"
+static const uint64_t gs_noBase = ~(uint64_t)0;
+
+TradeDedupIndex::TradeDedupIndex(const std::string& path, uint64_t capacity) : m_header(nullptr),
+	m_bits(nullptr)
+{
+	capacity = (capacity + 63) & ~(uint64_t)63;
+	uint64_t size = sizeof(Header) + capacity / 8;
+
+	if(!boost::filesystem::exists(path))
+		std::ofstream(path.c_str(), std::ios::binary | std::ios::out);
+	bool fresh = boost::filesystem::file_size(path) != size;
+	if(fresh)
+		boost::filesystem::resize_file(path, size);
+
+	m_file = file_mapping(path.c_str(), read_write);
+	m_region = mapped_region(m_file, read_write, 0, size);
+	m_header = static_cast<Header*>(m_region.get_address());
+	m_bits = reinterpret_cast<uint64_t*>(m_header + 1);
+
+	if(fresh || m_header->magic != gs_magic || m_header->capacity != capacity)
+	{
+		m_header->magic = gs_magic;
+		m_header->capacity = capacity;
+		reset(0);
+	}
+	LOG(info) << "Trade dedup index: " << path << ", session " << m_header->session << ", " << m_header->count << " trades";
+}
+
+TradeDedupIndex::~TradeDedupIndex()
+{
+	flush();
+}
+
+void TradeDedupIndex::setSession(uint32_t session)
+{
+	if(session != m_header->session)
+		reset(session);
+}
+
+uint32_t TradeDedupIndex::session() const
+{
+	return m_header->session;
+}
+
+bool TradeDedupIndex::insert(uint64_t tradeNum)
+{
+	if(m_header->base == gs_noBase)
+	{
+		// Tables are exported in trade order, so the first trade seen is
+		// close to the start of the session; leave some room below it
+		uint64_t slack = m_header->capacity / 16;
+		m_header->base = (tradeNum > slack ? tradeNum - slack : 0) & ~(uint64_t)63;
+	}
+
+	uint64_t offset = tradeNum - m_header->base;
+	if(tradeNum >= m_header->base && offset < m_header->capacity)
+	{
+		uint64_t& word = m_bits[offset >> 6];
+		uint64_t mask = (uint64_t)1 << (offset & 63);
+		if(word & mask)
+			return false;
+		word |= mask;
+	}
+	else if(!m_overflow.insert(tradeNum).second)
+	{
+		return false;
+	}
+	m_header->count++;
+	return true;
+}
+
+bool TradeDedupIndex::contains(uint64_t tradeNum) const
+{
+	uint64_t offset = tradeNum - m_header->base;
+	if(m_header->base != gs_noBase && tradeNum >= m_header->base && offset < m_header->capacity)
+		return (m_bits[offset >> 6] >> (offset & 63)) & 1;
+	return m_overflow.count(tradeNum) > 0;
+}
+
+uint64_t TradeDedupIndex::size() const
+{
+	return m_header->count;
+}
+
+void TradeDedupIndex::flush()
+{
+	m_region.flush(0, 0, true);
+}
+
+void TradeDedupIndex::reset(uint32_t session)
+{
+	m_header->session = session;
+	m_header->base = gs_noBase;
+	m_header->count = 0;
+	std::memset(m_bits, 0, m_header->capacity / 8);
+	m_overflow.clear();
+}
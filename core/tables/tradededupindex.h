@@ -0,0 +1,72 @@
+/*
+ * tradededupindex.h
+ */
+
+#ifndef TABLES_TRADEDEDUPINDEX_H_
+#define TABLES_TRADEDEDUPINDEX_H_
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_set>
+
+/**
+ * Set of trade numbers already emitted during a trading session.
+ *
+ * Trade numbers of one session are dense, so they are kept in a bitmap over
+ * [base, base + capacity) where base is the first trade number seen in the
+ * session. Numbers outside of the window fall back to a hash set. The bitmap
+ * lives in a memory-mapped file, so it survives gateway restarts; the
+ * fallback set is in-memory only.
+ *
+ * Index is reset when session (trading date, YYYYMMDD) changes.
+ */
+class TradeDedupIndex
+{
+public:
+	typedef std::shared_ptr<TradeDedupIndex> Ptr;
+
+	/**
+	 * Opens or creates index file. capacity is the bitmap window in trade
+	 * numbers, rounded up to 64; file takes capacity / 8 bytes.
+	 */
+	TradeDedupIndex(const std::string& path, uint64_t capacity = 1 << 25);
+	virtual ~TradeDedupIndex();
+
+	void setSession(uint32_t session);
+	uint32_t session() const;
+
+	/**
+	 * Returns false if trade number is already in the index
+	 */
+	bool insert(uint64_t tradeNum);
+	bool contains(uint64_t tradeNum) const;
+
+	uint64_t size() const;
+
+	void flush();
+
+private:
+	struct Header
+	{
+		uint32_t magic;
+		uint32_t session;
+		uint64_t capacity;
+		uint64_t base;
+		uint64_t count;
+	};
+
+	void reset(uint32_t session);
+
+private:
+	boost::interprocess::file_mapping m_file;
+	boost::interprocess::mapped_region m_region;
+	Header* m_header;
+	uint64_t* m_bits;
+	std::unordered_set<uint64_t> m_overflow;
+};
+
+#endif /* TABLES_TRADEDEDUPINDEX_H_ */
@@ -0,0 +1,224 @@
+/*
+ * tickring.cpp
+ */
+
+#include "tickring.h"
+
+#include "core/stats/latencyclock.h"
+
+#include "exceptions.h"
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+TickRing::TickRing(size_t capacity) : m_mask(capacity - 1),
+	m_slots(new Slot[capacity]),
+	m_claimed(0),
+	m_gatingCache(0),
+	m_waiters(0),
+	m_wakeups(0)
+{
+	if(capacity == 0 || (capacity & (capacity - 1)) != 0)
+		BOOST_THROW_EXCEPTION(ParameterError() << errinfo_str("Tick ring capacity should be a power of two"));
+
+	// Sequence stored in a slot is the sequence of its tick plus one, so
+	// zero means "never written"
+	for(size_t i = 0; i < capacity; i++)
+		m_slots[i].sequence.store(0, std::memory_order_relaxed);
+}
+
+TickRing::~TickRing()
+{
+}
+
+int TickRing::addConsumer(bool gating)
+{
+	std::unique_ptr<Cursor> cursor(new Cursor);
+	cursor->next.store(m_claimed.load(std::memory_order_acquire), std::memory_order_release);
+	cursor->dropped.store(0, std::memory_order_relaxed);
+	cursor->gating = gating;
+	m_cursors.push_back(std::move(cursor));
+	return m_cursors.size() - 1;
+}
+
+void TickRing::publish(const TickUpdate* updates, size_t count)
+{
+	// Claim no more than half of the ring at once, so that a big batch
+	// doesn't wait for consumers to drain the whole ring
+	size_t maxClaim = std::max<size_t>(capacity() / 2, 1);
+	while(count > 0)
+	{
+		size_t n = std::min(count, maxClaim);
+		uint64_t first = m_claimed.fetch_add(n, std::memory_order_relaxed);
+		claim(first, n);
+
+		auto now = LatencyClock::now();
+		const auto& poke = LatencyRecorder::current();
+		for(size_t i = 0; i < n; i++)
+		{
+			// Slot is invalidated first, so that a lapped non-gating
+			// consumer reading it concurrently notices the overwrite
+			auto& slot = m_slots[(first + i) & m_mask];
+			slot.sequence.store(0, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			slot.published = now;
+			slot.poke = poke;
+			slot.update = updates[i];
+			slot.sequence.store(first + i + 1, std::memory_order_release);
+		}
+		updates += n;
+		count -= n;
+	}
+
+	// Pairs with the increment in waitForTicks(): either the waiter sees the
+	// claimed ticks or this thread sees the waiter
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if(m_waiters.load(std::memory_order_relaxed) > 0)
+	{
+		boost::unique_lock<boost::mutex> lock(m_waitMutex);
+		m_waitCondition.notify_all();
+	}
+}
+
+bool TickRing::waitForTicks(int consumer, boost::chrono::milliseconds timeout)
+{
+	boost::unique_lock<boost::mutex> lock(m_waitMutex);
+	m_waiters.fetch_add(1);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	auto deadline = boost::chrono::steady_clock::now() + timeout;
+	auto wakeups = m_wakeups;
+	bool ready = true;
+	while(lag(consumer) == 0 && wakeups == m_wakeups)
+	{
+		if(m_waitCondition.wait_until(lock, deadline) == boost::cv_status::timeout)
+		{
+			ready = lag(consumer) > 0;
+			break;
+		}
+	}
+	m_waiters.fetch_sub(1);
+	return ready;
+}
+
+void TickRing::wake()
+{
+	boost::unique_lock<boost::mutex> lock(m_waitMutex);
+	m_wakeups++;
+	m_waitCondition.notify_all();
+}
+
+size_t TickRing::poll(int consumer, TickUpdate* out, size_t maxCount, uint64_t* published,
+	LatencyRecorder::PokeContext* pokes)
+{
+	auto& cursor = *m_cursors[consumer];
+	if(!cursor.gating)
+		return pollLapped(cursor, out, maxCount, published, pokes);
+
+	uint64_t next = cursor.next.load(std::memory_order_relaxed);
+	size_t count = 0;
+	while(count < maxCount)
+	{
+		const auto& slot = m_slots[next & m_mask];
+		if(slot.sequence.load(std::memory_order_acquire) != next + 1)
+			break;
+		if(count == 0 && published)
+			*published = slot.published;
+		if(pokes)
+			pokes[count] = slot.poke;
+		out[count++] = slot.update;
+		next++;
+	}
+	if(count > 0)
+		cursor.next.store(next, std::memory_order_release);
+	return count;
+}
+
+size_t TickRing::pollLapped(Cursor& cursor, TickUpdate* out, size_t maxCount, uint64_t* published,
+	LatencyRecorder::PokeContext* pokes)
+{
+	uint64_t next = cursor.next.load(std::memory_order_relaxed);
+	size_t count = 0;
+	while(count < maxCount)
+	{
+		const auto& slot = m_slots[next & m_mask];
+		uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+		if(sequence == next + 1)
+		{
+			// Seqlock-style read: the copy is valid if the slot wasn't touched meanwhile
+			auto update = slot.update;
+			auto time = slot.published;
+			auto poke = slot.poke;
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if(slot.sequence.load(std::memory_order_relaxed) == sequence)
+			{
+				if(count == 0 && published)
+					*published = time;
+				if(pokes)
+					pokes[count] = poke;
+				out[count++] = update;
+				next++;
+				continue;
+			}
+		}
+		else if(sequence < next + 1)
+		{
+			// Either not published yet, or being overwritten by a later lap
+			bool lapped = (sequence == 0) && (m_claimed.load(std::memory_order_acquire) > next + capacity());
+			if(!lapped)
+				break;
+		}
+
+		// Lapped: continue from the oldest tick that can still be in the ring
+		uint64_t claimed = m_claimed.load(std::memory_order_acquire);
+		uint64_t oldest = std::max(next + 1, claimed > capacity() ? claimed - capacity() : 0);
+		cursor.dropped.fetch_add(oldest - next, std::memory_order_relaxed);
+		next = oldest;
+	}
+	cursor.next.store(next, std::memory_order_release);
+	return count;
+}
+
+uint64_t TickRing::dropped(int consumer) const
+{
+	return m_cursors[consumer]->dropped.load(std::memory_order_relaxed);
+}
+
+uint64_t TickRing::lag(int consumer) const
+{
+	auto claimed = m_claimed.load(std::memory_order_relaxed);
+	auto next = m_cursors[consumer]->next.load(std::memory_order_relaxed);
+	return claimed > next ? claimed - next : 0;
+}
+
+void TickRing::claim(uint64_t first, size_t count)
+{
+	// Slots of the previous lap may be overwritten once every consumer has passed them
+	uint64_t end = first + count;
+	if(end <= capacity())
+		return;
+	uint64_t wrapPoint = end - capacity();
+	if(wrapPoint <= m_gatingCache.load(std::memory_order_acquire))
+		return;
+
+	int spins = 0;
+	uint64_t gating;
+	while(wrapPoint > (gating = minimumCursor()))
+	{
+		if(++spins < 100)
+			continue;
+		std::this_thread::yield();
+	}
+	m_gatingCache.store(gating, std::memory_order_release);
+}
+
+uint64_t TickRing::minimumCursor() const
+{
+	uint64_t result = std::numeric_limits<uint64_t>::max();
+	for(const auto& cursor : m_cursors)
+	{
+		if(cursor->gating)
+			result = std::min(result, cursor->next.load(std::memory_order_acquire));
+	}
+	return result;
+}
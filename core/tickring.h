@@ -0,0 +1,127 @@
+/*
+ * tickring.h
+ */
+
+#ifndef CORE_TICKRING_H_
+#define CORE_TICKRING_H_
+
+#include "core/tables/datasink.h"
+#include "core/stats/latencyrecorder.h"
+
+#include <boost/thread.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * Pre-allocated ring of ticks between producers (parsers, ingest servers)
+ * and consumers (publishers), in the spirit of LMAX Disruptor.
+ *
+ * A producer claims a run of slots with one fetch_add on the claim counter,
+ * fills them and marks each slot published by storing its sequence number.
+ * Every consumer has its own cursor and sees every tick; producers wait
+ * only when the slowest gating consumer is a whole ring behind. Non-gating
+ * consumers never hold producers back: when lapped, they skip the
+ * overwritten ticks and count them as dropped. No locks are taken on either
+ * side while the stream flows; an idle consumer may block in waitForTicks(),
+ * and only then publish() takes a mutex to wake it.
+ */
+class TickRing
+{
+public:
+	typedef std::shared_ptr<TickRing> Ptr;
+
+	/**
+	 * capacity should be a power of two
+	 */
+	TickRing(size_t capacity);
+	virtual ~TickRing();
+
+	/**
+	 * Registers a consumer starting at the current end of the stream.
+	 * Should be called before producers start.
+	 */
+	int addConsumer(bool gating = true);
+
+	void publish(const TickUpdate* updates, size_t count);
+
+	/**
+	 * Copies up to maxCount published ticks following consumer's cursor to
+	 * out and releases their slots. Doesn't block; returns number of ticks.
+	 * If published is given, it receives LatencyClock time when the first
+	 * returned tick was published. If pokes is given, it receives the
+	 * latency poke each returned tick was published from.
+	 */
+	size_t poll(int consumer, TickUpdate* out, size_t maxCount, uint64_t* published = nullptr,
+		LatencyRecorder::PokeContext* pokes = nullptr);
+
+	/**
+	 * Blocks until consumer has ticks to poll, wake() is called or timeout
+	 * expires. Returns false on timeout.
+	 */
+	bool waitForTicks(int consumer, boost::chrono::milliseconds timeout);
+
+	/**
+	 * Wakes every consumer blocked in waitForTicks()
+	 */
+	void wake();
+
+	/**
+	 * Ticks lost by non-gating consumer because it was lapped
+	 */
+	uint64_t dropped(int consumer) const;
+
+	/**
+	 * Number of ticks published but not yet polled by consumer
+	 */
+	uint64_t lag(int consumer) const;
+
+	size_t capacity() const
+	{
+		return m_mask + 1;
+	}
+
+private:
+	struct Slot
+	{
+		std::atomic<uint64_t> sequence;
+		uint64_t published;
+		LatencyRecorder::PokeContext poke;
+		TickUpdate update;
+	};
+
+	// Cursors are modified by different threads, keep them on separate cache lines
+	struct Cursor
+	{
+		std::atomic<uint64_t> next;
+		std::atomic<uint64_t> dropped;
+		bool gating;
+		char pad[64 - 2 * sizeof(std::atomic<uint64_t>) - sizeof(bool)];
+	};
+
+	size_t pollLapped(Cursor& cursor, TickUpdate* out, size_t maxCount, uint64_t* published,
+		LatencyRecorder::PokeContext* pokes);
+
+	void claim(uint64_t first, size_t count);
+	uint64_t minimumCursor() const;
+
+private:
+	uint64_t m_mask;
+	std::unique_ptr<Slot[]> m_slots;
+	char m_pad0[64];
+	std::atomic<uint64_t> m_claimed;
+	char m_pad1[64];
+	std::atomic<uint64_t> m_gatingCache;
+	char m_pad2[64];
+	// Consumers blocked in waitForTicks(); publish() reads it on every call
+	std::atomic<int> m_waiters;
+	char m_pad3[64];
+	boost::mutex m_waitMutex;
+	boost::condition_variable m_waitCondition;
+	uint64_t m_wakeups;
+	std::vector<std::unique_ptr<Cursor>> m_cursors;
+};
+
+#endif /* CORE_TICKRING_H_ */
@@ -0,0 +1,111 @@
+/*
+ * workerpool.cpp
+ */
+
+#include "workerpool.h"
+
+#include <algorithm>
+
+WorkerPool::WorkerPool(int threads) : m_size(std::max(threads, 1)),
+	m_generation(0),
+	m_activeWorkers(0),
+	m_stop(false),
+	m_function(nullptr),
+	m_tasks(0),
+	m_nextTask(0)
+{
+	for(int i = 1; i < m_size; i++)
+		m_threads.create_thread(std::bind(&WorkerPool::workerLoop, this));
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		boost::unique_lock<boost::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_startCondition.notify_all();
+	m_threads.join_all();
+}
+
+void WorkerPool::run(int tasks, const std::function<void(int task)>& f)
+{
+	if(tasks <= 0)
+		return;
+
+	if(m_size == 1 || tasks == 1)
+	{
+		for(int i = 0; i < tasks; i++)
+			f(i);
+		return;
+	}
+
+	{
+		boost::unique_lock<boost::mutex> lock(m_mutex);
+		m_function = &f;
+		m_tasks = tasks;
+		m_nextTask = 0;
+		m_error = nullptr;
+		m_activeWorkers = m_size - 1;
+		m_generation++;
+	}
+	m_startCondition.notify_all();
+
+	executeTasks();
+
+	boost::unique_lock<boost::mutex> lock(m_mutex);
+	while(m_activeWorkers > 0)
+		m_doneCondition.wait(lock);
+	m_function = nullptr;
+
+	if(m_error)
+	{
+		auto error = m_error;
+		m_error = nullptr;
+		std::rethrow_exception(error);
+	}
+}
+
+void WorkerPool::workerLoop()
+{
+	uint64_t generation = 0;
+	while(true)
+	{
+		{
+			boost::unique_lock<boost::mutex> lock(m_mutex);
+			while(!m_stop && m_generation == generation)
+				m_startCondition.wait(lock);
+			if(m_stop)
+				return;
+			generation = m_generation;
+		}
+
+		executeTasks();
+
+		boost::unique_lock<boost::mutex> lock(m_mutex);
+		if(--m_activeWorkers == 0)
+			m_doneCondition.notify_one();
+	}
+}
+
+void WorkerPool::executeTasks()
+{
+	while(true)
+	{
+		int task = m_nextTask.fetch_add(1);
+		if(task >= m_tasks)
+			return;
+		try
+		{
+			(*m_function)(task);
+		}
+		catch(...)
+		{
+			boost::unique_lock<boost::mutex> lock(m_mutex);
+			if(!m_error)
+				m_error = std::current_exception();
+			m_nextTask = m_tasks;
+			return;
+		}
+	}
+}
@@ -0,0 +1,56 @@
+/*
+ * workerpool.h
+ */
+
+#ifndef CORE_WORKERPOOL_H_
+#define CORE_WORKERPOOL_H_
+
+#include <boost/thread.hpp>
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+
+/**
+ * Fixed set of threads executing indexed tasks in parallel. run() blocks
+ * until every task is done; the calling thread takes tasks too, so a pool
+ * of N threads starts N - 1 workers. If a task throws, tasks not yet started
+ * are skipped and run() rethrows the first exception.
+ */
+class WorkerPool
+{
+public:
+	typedef std::shared_ptr<WorkerPool> Ptr;
+
+	WorkerPool(int threads);
+	virtual ~WorkerPool();
+
+	int size() const
+	{
+		return m_size;
+	}
+
+	void run(int tasks, const std::function<void(int task)>& f);
+
+private:
+	void workerLoop();
+	void executeTasks();
+
+private:
+	int m_size;
+	boost::thread_group m_threads;
+	boost::mutex m_mutex;
+	boost::condition_variable m_startCondition;
+	boost::condition_variable m_doneCondition;
+	uint64_t m_generation;
+	int m_activeWorkers;
+	bool m_stop;
+
+	const std::function<void(int)>* m_function;
+	int m_tasks;
+	std::atomic<int> m_nextTask;
+	std::exception_ptr m_error;
+};
+
+#endif /* CORE_WORKERPOOL_H_ */
@@ -23,6 +23,14 @@ int main(int argc, char** argv)
 		("quik.dll-path", po::value<std::string>(), "Path to Trans2Quik.dll")
 		("quik.exe-path", po::value<std::string>(), "Path to directory with QUIK executable")
 		("stats-endpoint", po::value<std::string>(), "Endpoint of stats server")
+		("shm-ring-name", po::value<std::string>(), "Name of shared memory ring written by QUIK exporter script")
+		("binary-ingest-endpoint", po::value<std::string>(), "Endpoint for binary update protocol clients")
+		("import-all-deals", po::value<std::string>(), "QUIK all deals export file to republish on startup")
+		("import-threads", po::value<int>()->default_value(1), "Number of threads used to parse imported files")
+		("tick-ring-size", po::value<int>()->default_value(65536), "Capacity of tick ring between parsers and publishers, power of two")
+		("quotesource-sink-policy", po::value<std::string>()->default_value("block"), "What to do when quote publishing falls behind: block or drop")
+		("journal-dir", po::value<std::string>(), "Directory for daily tick journal files")
+		("journal-sink-policy", po::value<std::string>()->default_value("drop"), "What to do when tick journal falls behind: block or drop")
 		;
 	po::variables_map vm;
 	po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -0,0 +1,96 @@
+/*
+ * alldealsimporter_test.cpp
+ */
+
+#include "catch.hpp"
+#include "core/ingest/alldealsimporter.h"
+#include "binary/textscanner.h"
+#include "tests/testsinks.h"
+
+#include <vector>
+
+TEST_CASE("TextScanner", "[binary][text_scanner]")
+{
+	SECTION("Fields and line ends are reported")
+	{
+		std::string text = "a;bb;;ccc\r\nlonger line field;x\nlast";
+		std::vector<std::string> fields;
+		std::vector<bool> lineEnds;
+		scanFields(text.data(), text.data() + text.size(), ';', [&](const char* b, const char* e, bool eol)
+			{
+				fields.push_back(std::string(b, e));
+				lineEnds.push_back(eol);
+			});
+
+		REQUIRE(fields == std::vector<std::string>({ "a", "bb", "", "ccc", "longer line field", "x", "last" }));
+		REQUIRE(lineEnds == std::vector<bool>({ false, false, false, true, false, true, true }));
+	}
+
+	SECTION("Numbers are parsed without locale")
+	{
+		double v = 0;
+		auto parse = [&](const std::string& s) { return parseNumber(s.data(), s.data() + s.size(), v); };
+
+		REQUIRE(parse("123"));
+		REQUIRE(v == 123.);
+		REQUIRE(parse("-0.05"));
+		REQUIRE(v == -0.05);
+		REQUIRE(parse("1 234,5"));
+		REQUIRE(v == 1234.5);
+		REQUIRE(parse("98765.4321"));
+		REQUIRE(v == 98765.4321);
+		REQUIRE(!parse(""));
+		REQUIRE(!parse("-"));
+		REQUIRE(!parse("12.05.2016"));
+		REQUIRE(!parse("RIZ6"));
+	}
+}
+
+TEST_CASE("AllDealsImporter", "[ingest][all_deals_importer]")
+{
+	std::string header = "TRADENUM;TRADEDATE;TRADETIME;CLASSCODE;SECCODE;PRICE;QTY;BUYSELL\r\n";
+	std::string rows;
+	for(int i = 0; i < 1000; i++)
+	{
+		rows += std::to_string(i) + ";15.06.2016;10:00:" + (i % 60 < 10 ? "0" : "") + std::to_string(i % 60) +
+			";SPBFUT;" + (i % 2 ? "RIU6" : "SiU6") + ";" + std::to_string(90000 + i) + ".5;" + std::to_string(i + 1) +
+			";" + (i % 3 ? "B" : "S") + "\r\n";
+	}
+	std::string file = header + rows;
+
+	SECTION("Rows are imported in order with multi-threaded chunking")
+	{
+		auto sink = std::make_shared<CollectingSink>();
+		AllDealsImporter importer(sink, 4, 256);
+		auto count = importer.importBuffer(file.data(), file.data() + file.size());
+
+		REQUIRE(count == 1000);
+		REQUIRE(sink->ticks.size() == 1000);
+		// One batch per chunk, no per-tick calls
+		REQUIRE(sink->singleTicks == 0);
+		REQUIRE(sink->batches.size() <= file.size() / 256 + 1);
+		for(int i = 0; i < 1000; i++)
+		{
+			REQUIRE(sink->ticker(i) == (i % 2 ? "SPBFUT#RIU6" : "SPBFUT#SiU6"));
+			REQUIRE(sink->ticks[i].tick.value.toDouble() == 90000.5 + i);
+			REQUIRE(sink->ticks[i].tick.volume == (i % 3 ? i + 1 : -(i + 1)));
+			REQUIRE(sink->ticks[i].tick.timestamp - sink->ticks[0].tick.timestamp == (uint64_t)(i % 60));
+		}
+	}
+
+	SECTION("Malformed rows are skipped")
+	{
+		std::string broken = header + "1;15.06.2016;10:00:00;SPBFUT;RIU6;abc;1;B\n\n2;15.06.2016;10:00:01;SPBFUT;RIU6;100;1;B";
+		auto sink = std::make_shared<CollectingSink>();
+		AllDealsImporter importer(sink);
+		REQUIRE(importer.importBuffer(broken.data(), broken.data() + broken.size()) == 1);
+		REQUIRE(sink->ticks[0].tick.value.toDouble() == 100.);
+	}
+
+	SECTION("Missing required columns are reported")
+	{
+		std::string noPrice = "TRADEDATE;TRADETIME;CLASSCODE;SECCODE;QTY\n";
+		AllDealsImporter importer(std::make_shared<CollectingSink>());
+		REQUIRE_THROWS(importer.importBuffer(noPrice.data(), noPrice.data() + noPrice.size()));
+	}
+}
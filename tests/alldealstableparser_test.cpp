@@ -0,0 +1,98 @@
+/*
+ * alldealstableparser_test.cpp
+ */
+
+#include "catch.hpp"
+#include "core/tables/parsers/alldealstableparser.h"
+#include "tests/testsinks.h"
+
+namespace
+{
+struct Deal
+{
+	int tradeNum;
+	double price;
+	const char* classCode;
+};
+
+XlTable::Ptr makeDeals(const std::vector<Deal>& deals, bool withTradeNum, bool withHeader = true)
+{
+	int headerRows = withHeader ? 1 : 0;
+	auto table = std::make_shared<XlTable>(9, deals.size() + headerRows);
+	if(withHeader)
+	{
+		std::vector<std::string> header = { "CLASSCODE", "SECCODE", "TRADEDATE", "TRADETIME", "TRADETIME_MSEC",
+			"PRICE", "QTY", "BUYSELL", withTradeNum ? "TRADENUM" : "COMMENT" };
+		for(size_t i = 0; i < header.size(); i++)
+			table->set(0, i, header[i]);
+	}
+	for(size_t i = 0; i < deals.size(); i++)
+	{
+		int row = i + headerRows;
+		table->set(row, 0, std::string(deals[i].classCode ? deals[i].classCode : "SPBFUT"));
+		table->set(row, 1, std::string(deals[i].classCode ? "SBER" : "RIZ6"));
+		table->set(row, 2, std::string("19.10.2026"));
+		table->set(row, 3, std::string("10:00:01"));
+		table->set(row, 4, 0.);
+		table->set(row, 5, deals[i].price);
+		table->set(row, 6, 1.);
+		table->set(row, 7, std::string("Buy"));
+		if(withTradeNum)
+			table->set(row, 8, (double)deals[i].tradeNum);
+	}
+	return table;
+}
+}
+
+TEST_CASE("AllDealsTableParser", "[tables][all_deals]")
+{
+	auto sink = std::make_shared<CollectingSink>();
+	AllDealsTableParser parser("alld", sink);
+
+	SECTION("Re-sent table emits only new trades by trade number")
+	{
+		parser.incomingTable(makeDeals({ { 10, 100 }, { 11, 101 } }, true));
+		REQUIRE(sink->ticks.size() == 2);
+
+		parser.incomingTable(makeDeals({ { 10, 100 }, { 11, 101 }, { 12, 102 } }, true));
+		REQUIRE(sink->ticks.size() == 3);
+		REQUIRE(sink->ticks[2].tick.value.toDouble() == 102);
+	}
+
+	SECTION("Trade numbers are tracked per class code")
+	{
+		// TQBR numbers are far behind SPBFUT ones in the same table
+		parser.incomingTable(makeDeals({ { 5000, 100 }, { 10, 250, "TQBR" } }, true));
+		REQUIRE(sink->ticks.size() == 2);
+
+		parser.incomingTable(makeDeals({ { 5000, 100 }, { 10, 250, "TQBR" }, { 11, 251, "TQBR" }, { 5001, 101 } }, true));
+		REQUIRE(sink->ticks.size() == 4);
+		REQUIRE(sink->ticks[2].tick.value.toDouble() == 251);
+		REQUIRE(sink->ticks[3].tick.value.toDouble() == 101);
+		REQUIRE(sink->ticks[2].instrument != sink->ticks[3].instrument);
+	}
+
+	SECTION("Without trade number, absolute row index is used")
+	{
+		parser.incomingTable(makeDeals({ { 0, 100 } }, false));
+		auto update = makeDeals({ { 0, 101 }, { 0, 102 } }, false, false);
+		update->setOrigin(2, 0);
+		parser.incomingTable(update);
+		// Overlapping poke: row 2 was already seen
+		update = makeDeals({ { 0, 102 }, { 0, 103 } }, false, false);
+		update->setOrigin(3, 0);
+		parser.incomingTable(update);
+
+		REQUIRE(sink->ticks.size() == 4);
+		REQUIRE(sink->ticks[3].tick.value.toDouble() == 103);
+	}
+
+	SECTION("Table reset is detected by the first trade")
+	{
+		parser.incomingTable(makeDeals({ { 10, 100 }, { 11, 101 } }, true));
+		parser.incomingTable(makeDeals({ { 1, 90 } }, true));
+
+		REQUIRE(sink->ticks.size() == 3);
+		REQUIRE(sink->ticks[2].tick.value.toDouble() == 90);
+	}
+}
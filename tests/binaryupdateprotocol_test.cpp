@@ -0,0 +1,93 @@
+/*
+ * binaryupdateprotocol_test.cpp
+ */
+
+#include "catch.hpp"
+#include "core/ingest/binaryupdateprotocol.h"
+#include "tests/testsinks.h"
+
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	const uint64_t arrivalTime = 1600000000123456ULL;
+
+	void decodeAll(BinaryUpdateDecoder& decoder, const std::vector<uint8_t>& stream)
+	{
+		size_t offset = 0;
+		while(offset < stream.size())
+		{
+			uint32_t length;
+			std::memcpy(&length, stream.data() + offset, sizeof(length));
+			offset += sizeof(length);
+			decoder.decodeFrame(stream.data() + offset, length, arrivalTime);
+			offset += length;
+		}
+	}
+}
+
+TEST_CASE("BinaryUpdateProtocol", "[ingest][binary_protocol]")
+{
+	auto sink = std::make_shared<RecordingSink>();
+	BinaryUpdateDecoder decoder(sink);
+	BinaryUpdateEncoder encoder;
+
+	SECTION("Encoded updates are decoded to ticks")
+	{
+		encoder.defineInstrument(0, "SPBFUT#RIZ6");
+		encoder.defineInstrument(7, "SPBFUT#SiZ6");
+		encoder.addUpdate(0, (int)goldmine::Datatype::Price, 100000., 3, 1500000000000001ULL);
+		encoder.addUpdate(7, (int)goldmine::Datatype::BestBid, 65000., 0, 1500000000999999ULL);
+
+		decodeAll(decoder, encoder.finish());
+
+		REQUIRE(sink->ticks.size() == 2);
+		REQUIRE(sink->tickers[0] == "SPBFUT#RIZ6");
+		REQUIRE(sink->ticks[0].datatype == (int)goldmine::Datatype::Price);
+		REQUIRE(sink->ticks[0].value.toDouble() == 100000.);
+		REQUIRE(sink->ticks[0].volume == 3);
+		REQUIRE(sink->ticks[0].timestamp == 1500000000);
+		REQUIRE(sink->ticks[0].useconds == 1);
+		REQUIRE(sink->tickers[1] == "SPBFUT#SiZ6");
+		REQUIRE(sink->ticks[1].useconds == 999999);
+	}
+
+	SECTION("Large batches are split into several frames")
+	{
+		encoder.defineInstrument(1, "SPBFUT#RIZ6");
+		for(int i = 0; i < 100000; i++)
+			encoder.addUpdate(1, (int)goldmine::Datatype::Price, i, 1, 0);
+
+		decodeAll(decoder, encoder.finish());
+
+		REQUIRE(sink->ticks.size() == 100000);
+		REQUIRE(sink->ticks.back().value.toDouble() == 99999.);
+		// Updates without timestamp get the arrival time of their frame
+		REQUIRE(sink->ticks.back().timestamp == 1600000000);
+		REQUIRE(sink->ticks.back().useconds == 123456);
+	}
+
+	SECTION("Updates for undefined instruments are rejected")
+	{
+		encoder.defineInstrument(1, "SPBFUT#RIZ6");
+		encoder.addUpdate(1, (int)goldmine::Datatype::Price, 1., 1, 0);
+		encoder.addUpdate(3, (int)goldmine::Datatype::Price, 1., 1, 0);
+		REQUIRE_THROWS(decodeAll(decoder, encoder.finish()));
+		REQUIRE(sink->ticks.empty());
+
+		// Updates decoded before the error are not delivered with the next frame
+		encoder.addUpdate(1, (int)goldmine::Datatype::Price, 2., 1, 0);
+		decodeAll(decoder, encoder.finish());
+		REQUIRE(sink->ticks.size() == 1);
+		REQUIRE(sink->ticks[0].value.toDouble() == 2.);
+	}
+
+	SECTION("Truncated frames are rejected")
+	{
+		encoder.defineInstrument(0, "SPBFUT#RIZ6");
+		encoder.addUpdate(0, (int)goldmine::Datatype::Price, 1., 1, 0);
+		auto stream = encoder.finish();
+		REQUIRE_THROWS(decoder.decodeFrame(stream.data() + 4, 3, arrivalTime));
+	}
+}
@@ -0,0 +1,88 @@
+/*
+ * black76_test.cpp
+ */
+
+#include "catch.hpp"
+#include "core/pricing/black76.h"
+#include "core/tables/parsers/optionsboardtableparser.h"
+#include "core/tables/datatypes.h"
+#include "tests/testsinks.h"
+
+#include <cmath>
+
+TEST_CASE("Black76", "[pricing][black76]")
+{
+	SECTION("Implied volatility recovers the pricing volatility")
+	{
+		OptionBatch batch;
+		std::vector<double> volatilities;
+		for(int i = 0; i < 40; i++)
+		{
+			double strike = 90000 + i * 500;
+			double side = (i % 2) ? 1 : -1;
+			double volatility = 0.15 + 0.01 * (i % 10);
+			double time = (20 + i) / 365.;
+			batch.add(100000, strike, time, Black76::price(100000, strike, time, volatility, side), side);
+			volatilities.push_back(volatility);
+		}
+
+		Black76 model;
+		model.solve(batch);
+		for(size_t i = 0; i < batch.size(); i++)
+		{
+			REQUIRE(batch.valid[i]);
+			REQUIRE(batch.volatility[i] == Approx(volatilities[i]).epsilon(1e-6));
+			REQUIRE(std::abs(batch.delta[i]) <= 1);
+			REQUIRE(batch.gamma[i] > 0);
+			REQUIRE(batch.vega[i] > 0);
+		}
+	}
+
+	SECTION("Premium below intrinsic value has no solution")
+	{
+		OptionBatch batch;
+		batch.add(100000, 90000, 30 / 365., 5000, 1);
+		Black76 model;
+		model.solve(batch);
+		REQUIRE(!batch.valid[0]);
+	}
+}
+
+TEST_CASE("OptionsBoardTableParser", "[tables][options_board]")
+{
+	auto sink = std::make_shared<CollectingSink>();
+	auto quoteTable = std::make_shared<QuoteTable>();
+	OptionsBoardTableParser parser("options", sink, quoteTable);
+
+	goldmine::Tick underlying;
+	underlying.datatype = (int)goldmine::Datatype::Price;
+	underlying.value = 100000.;
+	quoteTable->updateQuote("SPBFUT#RIZ6", underlying);
+
+	auto premium = Black76::price(100000, 105000, 30 / 365., 0.3, 1);
+	auto table = std::make_shared<XlTable>(7, 2);
+	std::vector<std::string> header = { "CLASS_CODE", "CODE", "STRIKE", "OPTIONTYPE", "OPTIONBASE", "DAYS_TO_MAT_DATE", "last" };
+	for(size_t i = 0; i < header.size(); i++)
+		table->set(0, i, header[i]);
+	table->set(1, 0, std::string("SPBOPT"));
+	table->set(1, 1, std::string("RI105000BX6"));
+	table->set(1, 2, 105000.);
+	table->set(1, 3, std::string("Call"));
+	table->set(1, 4, std::string("RIZ6"));
+	table->set(1, 5, 30.);
+	table->set(1, 6, premium);
+
+	parser.incomingTable(table);
+
+	REQUIRE(sink->ticks.size() == 4);
+	REQUIRE(sink->ticks[0].instrument == InstrumentRegistry::instance().find("SPBOPT#RI105000BX6"));
+	REQUIRE(sink->ticks[0].tick.datatype == ExtendedDatatype::ImpliedVolatility);
+	REQUIRE(sink->ticks[0].tick.value.toDouble() == Approx(30).epsilon(1e-4));
+	REQUIRE(sink->ticks[1].tick.datatype == ExtendedDatatype::Delta);
+
+	SECTION("Unchanged rows are not solved again")
+	{
+		parser.incomingTable(table);
+		REQUIRE(sink->ticks.size() == 4);
+	}
+}
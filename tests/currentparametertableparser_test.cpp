@@ -0,0 +1,190 @@
+/*
+ * currentparametertableparser_test.cpp
+ */
+
+#include "catch.hpp"
+#include "core/tables/parsers/currentparametertableparser.h"
+#include "tests/testsinks.h"
+
+TEST_CASE("CurrentParameterTableParser", "[tables][current_parameters]")
+{
+	auto sink = std::make_shared<CollectingSink>();
+	CurrentParameterTableParser parser("current", sink);
+
+	auto table = std::make_shared<XlTable>(6, 3);
+	table->set(0, 0, std::string("CLASS_CODE"));
+	table->set(0, 1, std::string("CODE"));
+	table->set(0, 2, std::string("bid"));
+	table->set(0, 3, std::string("offer"));
+	table->set(0, 4, std::string("last"));
+	table->set(0, 5, std::string("numcontracts"));
+	for(int row = 1; row < 3; row++)
+	{
+		table->set(row, 0, std::string("SPBFUT"));
+		table->set(row, 1, std::string(row == 1 ? "RIZ6" : "SiZ6"));
+		table->set(row, 2, 100.);
+		table->set(row, 3, 101.);
+		table->set(row, 4, 100.);
+		table->set(row, 5, 10.);
+	}
+
+	SECTION("Whole table is delivered as a single batch")
+	{
+		parser.incomingTable(table);
+
+		REQUIRE(sink->singleTicks == 0);
+		REQUIRE(sink->batches.size() == 1);
+		// best bid, best offer and open interest per row
+		REQUIRE(sink->batches[0].size() == 6);
+
+		auto riz6 = InstrumentRegistry::instance().find("SPBFUT#RIZ6");
+		REQUIRE(sink->batches[0][0].instrument == riz6);
+		REQUIRE(sink->batches[0][0].tick.datatype == (int)goldmine::Datatype::BestBid);
+		REQUIRE(sink->batches[0][5].instrument == InstrumentRegistry::instance().find("SPBFUT#SiZ6"));
+	}
+
+	SECTION("Ticks are stamped with table arrival time")
+	{
+		table->setArrivalTime(1476871200123456ULL);
+		parser.incomingTable(table);
+
+		REQUIRE(sink->batches.size() == 1);
+		for(const auto& update : sink->batches[0])
+		{
+			REQUIRE(update.tick.timestamp == 1476871200);
+			REQUIRE(update.tick.useconds == 123456);
+		}
+	}
+
+	SECTION("Ignore rules suppress ticks per instrument and datatype")
+	{
+		Json::Value config;
+		config["ignore"].append("SPBFUT#Si*");
+		config["exclude"].append("SPBFUT#RIZ6/open_interest");
+		parser.parseConfig(config);
+		parser.incomingTable(table);
+
+		REQUIRE(sink->batches.size() == 1);
+		REQUIRE(sink->batches[0].size() == 2);
+		REQUIRE(sink->batches[0][0].tick.datatype == (int)goldmine::Datatype::BestBid);
+		REQUIRE(sink->batches[0][1].tick.datatype == (int)goldmine::Datatype::BestOffer);
+	}
+
+	SECTION("Unchanged quotes are not re-emitted")
+	{
+		parser.incomingTable(table);
+		parser.incomingTable(table);
+		REQUIRE(sink->batches.size() == 1);
+
+		table->set(1, 2, 99.);
+		parser.incomingTable(table);
+		REQUIRE(sink->batches.size() == 2);
+		REQUIRE(sink->batches[1].size() == 1);
+		REQUIRE(sink->batches[1][0].tick.datatype == (int)goldmine::Datatype::BestBid);
+	}
+
+	SECTION("Header row is skipped on every poke of the whole table")
+	{
+		parser.incomingTable(table);
+		table->set(1, 2, 99.);
+		parser.incomingTable(table);
+
+		REQUIRE(sink->batches.size() == 2);
+		REQUIRE(sink->batches[1].size() == 1);
+		REQUIRE(InstrumentRegistry::instance().find("CLASS_CODE#CODE") == NoInstrument);
+	}
+
+	SECTION("Refresh interval re-emits unchanged quotes")
+	{
+		Json::Value config;
+		config["refresh_interval"] = 1;
+		parser.parseConfig(config);
+
+		table->setArrivalTime(1476871200000000ULL);
+		parser.incomingTable(table);
+		REQUIRE(sink->batches.size() == 1);
+
+		table->setArrivalTime(1476871200500000ULL);
+		parser.incomingTable(table);
+		REQUIRE(sink->batches.size() == 1);
+
+		table->setArrivalTime(1476871201000000ULL);
+		parser.incomingTable(table);
+		REQUIRE(sink->batches.size() == 2);
+		REQUIRE(sink->batches[1].size() == 6);
+	}
+
+	SECTION("Batch buffer is reused between pokes")
+	{
+		Json::Value config;
+		config["refresh_interval"] = 1;
+		parser.parseConfig(config);
+
+		table->setArrivalTime(1476871200000000ULL);
+		parser.incomingTable(table);
+		table->setArrivalTime(1476871201000000ULL);
+		parser.incomingTable(table);
+
+		REQUIRE(sink->batches.size() == 2);
+		REQUIRE(sink->batches[1].size() == 6);
+		REQUIRE(sink->buffers[1] == sink->buffers[0]);
+	}
+}
+
+TEST_CASE("CurrentParameterTableParser parallel", "[tables][current_parameters]")
+{
+	auto makeTable = [](int rows, double price)
+	{
+		auto table = std::make_shared<XlTable>(6, rows + 1);
+		table->set(0, 0, std::string("CLASS_CODE"));
+		table->set(0, 1, std::string("CODE"));
+		table->set(0, 2, std::string("bid"));
+		table->set(0, 3, std::string("offer"));
+		table->set(0, 4, std::string("numcontracts"));
+		table->set(0, 5, std::string("last"));
+		for(int row = 1; row <= rows; row++)
+		{
+			table->set(row, 0, std::string("TQBR"));
+			table->set(row, 1, "P" + std::to_string(row));
+			table->set(row, 2, price + row);
+			table->set(row, 3, price + row + 1);
+			table->set(row, 4, price + row);
+			table->set(row, 5, price + row + 0.5);
+		}
+		return table;
+	};
+
+	auto serialSink = std::make_shared<CollectingSink>();
+	CurrentParameterTableParser serial("current", serialSink);
+
+	auto parallelSink = std::make_shared<CollectingSink>();
+	CurrentParameterTableParser parallel("current", parallelSink);
+	Json::Value config;
+	config["threads"] = 4;
+	config["parallel_threshold"] = 1;
+	parallel.parseConfig(config);
+
+	for(double price : { 100., 200. })
+	{
+		auto table = makeTable(1000, price);
+		serial.incomingTable(table);
+		parallel.incomingTable(table);
+	}
+
+	REQUIRE(parallelSink->batches.size() == 2);
+	for(size_t batch = 0; batch < 2; batch++)
+	{
+		const auto& expected = serialSink->batches[batch];
+		const auto& actual = parallelSink->batches[batch];
+		REQUIRE(actual.size() == 3000);
+		REQUIRE(actual.size() == expected.size());
+		bool same = true;
+		for(size_t i = 0; i < expected.size(); i++)
+		{
+			same = same && (actual[i].instrument == expected[i].instrument) &&
+				(actual[i].tick.datatype == expected[i].tick.datatype) &&
+				(actual[i].tick.value == expected[i].tick.value);
+		}
+		REQUIRE(same);
+	}
+}
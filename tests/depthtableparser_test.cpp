@@ -0,0 +1,134 @@
+/*
+ * depthtableparser_test.cpp
+ */
+
+#include "catch.hpp"
+#include "core/tables/parsers/depthtableparser.h"
+#include "core/tables/datatypes.h"
+#include "tests/testsinks.h"
+
+namespace
+{
+XlTable::Ptr makeGlass(const std::vector<std::pair<double, int>>& levels)
+{
+	// Offers first (negative volumes), then bids, descending by price as QUIK exports them
+	auto table = std::make_shared<XlTable>(3, levels.size() + 1);
+	table->set(0, 0, std::string("BID_VOLUME"));
+	table->set(0, 1, std::string("PRICE"));
+	table->set(0, 2, std::string("OFFER_VOLUME"));
+	for(size_t i = 0; i < levels.size(); i++)
+	{
+		table->set(i + 1, 1, levels[i].first);
+		if(levels[i].second > 0)
+			table->set(i + 1, 0, (double)levels[i].second);
+		else
+			table->set(i + 1, 2, (double)-levels[i].second);
+	}
+	return table;
+}
+}
+
+TEST_CASE("DepthBook", "[tables][depth]")
+{
+	DepthBook book;
+	book.setDepth(2);
+	book.addBid(99, 1);
+	book.addBid(101, 2);
+	book.addBid(100, 3);
+	book.addOffer(103, 1);
+	book.addOffer(102, 1);
+	book.addOffer(102, 4);
+
+	REQUIRE(book.bidsCount() == 2);
+	REQUIRE(book.bids()[0].price == 101);
+	REQUIRE(book.bids()[1].price == 100);
+	REQUIRE(book.offersCount() == 2);
+	REQUIRE(book.offers()[0].price == 102);
+	REQUIRE(book.offers()[0].volume == 5);
+}
+
+TEST_CASE("DepthTableParser", "[tables][depth]")
+{
+	auto sink = std::make_shared<CollectingSink>();
+	DepthTableParser parser("glass", sink);
+	Json::Value config;
+	config["instrument"] = "SPBFUT#SiZ6";
+	parser.parseConfig(config);
+	auto instrument = InstrumentRegistry::instance().find("SPBFUT#SiZ6");
+
+	parser.incomingTable(makeGlass({ { 102, -5 }, { 101, -3 }, { 100, 4 }, { 99, 7 } }));
+
+	SECTION("First snapshot emits every level and top of book")
+	{
+		REQUIRE(sink->ticks.size() == 6);
+		REQUIRE(sink->ticks[0].instrument == instrument);
+		REQUIRE(sink->ticks[0].tick.datatype == (int)goldmine::Datatype::Depth);
+		REQUIRE(sink->ticks[0].tick.value.toDouble() == 100);
+		REQUIRE(sink->ticks[0].tick.volume == 4);
+		REQUIRE(sink->ticks[2].tick.value.toDouble() == 101);
+		REQUIRE(sink->ticks[2].tick.volume == -3);
+		REQUIRE(sink->ticks[4].tick.datatype == (int)goldmine::Datatype::BestBid);
+		REQUIRE(sink->ticks[5].tick.datatype == (int)goldmine::Datatype::BestOffer);
+		REQUIRE(sink->ticks[5].tick.value.toDouble() == 101);
+	}
+
+	SECTION("Subsequent snapshot emits only changed levels")
+	{
+		sink->ticks.clear();
+		parser.incomingTable(makeGlass({ { 102, -5 }, { 101, -3 }, { 100, 6 } }));
+
+		REQUIRE(sink->ticks.size() == 3);
+		REQUIRE(sink->ticks[0].tick.value.toDouble() == 100);
+		REQUIRE(sink->ticks[0].tick.volume == 6);
+		REQUIRE(sink->ticks[1].tick.datatype == ExtendedDatatype::DepthRemoved);
+		REQUIRE(sink->ticks[1].tick.value.toDouble() == 99);
+		REQUIRE(sink->ticks[1].tick.volume == 1);
+		REQUIRE(sink->ticks[2].tick.datatype == (int)goldmine::Datatype::BestBid);
+		REQUIRE(sink->ticks[2].tick.volume == 6);
+	}
+
+	SECTION("Removed offers and emptied side are reported")
+	{
+		sink->ticks.clear();
+		parser.incomingTable(makeGlass({ { 100, 4 }, { 99, 7 } }));
+
+		REQUIRE(sink->ticks.size() == 3);
+		REQUIRE(sink->ticks[0].tick.datatype == ExtendedDatatype::DepthRemoved);
+		REQUIRE(sink->ticks[0].tick.value.toDouble() == 101);
+		REQUIRE(sink->ticks[0].tick.volume == -1);
+		REQUIRE(sink->ticks[1].tick.datatype == ExtendedDatatype::DepthRemoved);
+		REQUIRE(sink->ticks[1].tick.value.toDouble() == 102);
+		REQUIRE(sink->ticks[1].tick.volume == -1);
+		REQUIRE(sink->ticks[2].tick.datatype == (int)goldmine::Datatype::BestOffer);
+		REQUIRE(sink->ticks[2].tick.value.toDouble() == 0);
+		REQUIRE(sink->ticks[2].tick.volume == 0);
+	}
+
+	SECTION("Partial poke updates only the rows it covers")
+	{
+		// Row 3 of the table is the bid at 100
+		sink->ticks.clear();
+		auto update = std::make_shared<XlTable>(3, 1);
+		update->setOrigin(3, 0);
+		update->set(0, 0, 5.);
+		update->set(0, 1, 100.);
+		parser.incomingTable(update);
+
+		REQUIRE(sink->ticks.size() == 2);
+		REQUIRE(sink->ticks[0].tick.datatype == (int)goldmine::Datatype::Depth);
+		REQUIRE(sink->ticks[0].tick.value.toDouble() == 100);
+		REQUIRE(sink->ticks[0].tick.volume == 5);
+		REQUIRE(sink->ticks[1].tick.datatype == (int)goldmine::Datatype::BestBid);
+		REQUIRE(sink->ticks[1].tick.volume == 5);
+
+		// Emptied row removes its level
+		sink->ticks.clear();
+		update = std::make_shared<XlTable>(3, 1);
+		update->setOrigin(4, 0);
+		parser.incomingTable(update);
+
+		REQUIRE(sink->ticks.size() == 1);
+		REQUIRE(sink->ticks[0].tick.datatype == ExtendedDatatype::DepthRemoved);
+		REQUIRE(sink->ticks[0].tick.value.toDouble() == 99);
+	}
+}
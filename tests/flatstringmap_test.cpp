@@ -0,0 +1,37 @@
+/*
+ * flatstringmap_test.cpp
+ */
+
+#include "catch.hpp"
+#include "core/tables/flatstringmap.h"
+
+TEST_CASE("FlatStringMap", "[tables][flat_string_map]")
+{
+	FlatStringMap<int> map(4);
+
+	SECTION("Values are default-initialized on first access")
+	{
+		REQUIRE(map.find("SPBFUT#RIZ6") == nullptr);
+		REQUIRE(map["SPBFUT#RIZ6"] == 0);
+		REQUIRE(map.size() == 1);
+		REQUIRE(map.find("SPBFUT#RIZ6") != nullptr);
+	}
+
+	SECTION("Values survive growth")
+	{
+		for(int i = 0; i < 5000; i++)
+			map["SPBFUT#" + std::to_string(i)] = i;
+
+		REQUIRE(map.size() == 5000);
+		for(int i = 0; i < 5000; i++)
+			REQUIRE(*map.find("SPBFUT#" + std::to_string(i)) == i);
+
+		int sum = 0;
+		map.forEach([&](const std::string& key, int value) { sum += value; });
+		REQUIRE(sum == 4999 * 5000 / 2);
+
+		map.clear();
+		REQUIRE(map.size() == 0);
+		REQUIRE(map.find("SPBFUT#1") == nullptr);
+	}
+}
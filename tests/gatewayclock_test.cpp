@@ -0,0 +1,51 @@
+/*
+ * gatewayclock_test.cpp
+ */
+
+#include "catch.hpp"
+#include "core/gatewayclock.h"
+
+#include <cstdlib>
+#include <thread>
+
+TEST_CASE("GatewayClock", "[core][clock]")
+{
+	GatewayClock clock(10);
+
+	SECTION("Follows system clock")
+	{
+		auto system = GatewayClock::systemMicroseconds();
+		auto gateway = clock.now();
+		REQUIRE(std::llabs((long long)gateway - (long long)system) < 5000);
+	}
+
+	SECTION("Never goes backwards, also across resync")
+	{
+		uint64_t last = 0;
+		for(int i = 0; i < 30; i++)
+		{
+			auto ticks = LatencyClock::now();
+			auto time = clock.microseconds(ticks);
+			REQUIRE(time >= last);
+			REQUIRE(clock.microseconds(ticks) >= time);
+			last = time;
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+	SECTION("Small step back is hidden, big one is followed")
+	{
+		GatewayClock slow(100000);
+		auto ticks = LatencyClock::now();
+		auto wall = GatewayClock::systemMicroseconds();
+		slow.anchor(ticks, wall);
+		REQUIRE(slow.microseconds(ticks) == wall);
+
+		slow.anchor(ticks, wall - GatewayClock::MaxStepBackMicroseconds / 2);
+		REQUIRE(slow.microseconds(ticks) == wall);
+
+		slow.anchor(ticks, wall - 1000000);
+		REQUIRE(slow.microseconds(ticks) == wall - 1000000);
+		REQUIRE(slow.microseconds(ticks) == wall - 1000000);
+	}
+}
@@ -0,0 +1,95 @@
+/*
+ * generictableparser_test.cpp
+ */
+
+#include "catch.hpp"
+#include "core/tables/parsers/generictableparser.h"
+#include "tests/testsinks.h"
+
+namespace
+{
+Json::Value parseJson(const std::string& str)
+{
+	Json::Value root;
+	Json::Reader reader;
+	reader.parse(str, root);
+	return root;
+}
+}
+
+TEST_CASE("GenericTableParser", "[tables][generic]")
+{
+	auto sink = std::make_shared<CollectingSink>();
+	GenericTableParser parser("fx", sink);
+	parser.parseConfig(parseJson(R"({
+		"type" : "generic", "topic" : "fx",
+		"instrument" : ["CLASS_CODE", "CODE"],
+		"date" : "TRADEDATE", "time" : "TIME",
+		"fields" : [
+			{ "column" : "last", "datatype" : "price", "volume" : "voltoday", "cumulative_volume" : true },
+			{ "column" : "bid", "datatype" : "best_bid", "emit" : "on_change" }
+		] })"));
+
+	auto table = std::make_shared<XlTable>(6, 2);
+	table->set(0, 0, std::string("bid"));
+	table->set(0, 1, std::string("CODE"));
+	table->set(0, 2, std::string("CLASS_CODE"));
+	table->set(0, 3, std::string("last"));
+	table->set(0, 4, std::string("TIME"));
+	table->set(0, 5, std::string("TRADEDATE"));
+	table->set(1, 0, 64.5);
+	table->set(1, 1, std::string("USD000UTSTOM"));
+	table->set(1, 2, std::string("CETS"));
+	table->set(1, 3, 64.6);
+	table->set(1, 4, std::string("10:00:05"));
+	table->set(1, 5, std::string("19.10.2026"));
+	parser.incomingTable(table);
+
+	auto instrument = InstrumentRegistry::instance().find("CETS#USD000UTSTOM");
+	REQUIRE(instrument != NoInstrument);
+
+	SECTION("Header row is skipped and configured fields are emitted")
+	{
+		REQUIRE(sink->ticks.size() == 2);
+		REQUIRE(sink->ticks[0].instrument == instrument);
+		REQUIRE(sink->ticks[0].tick.datatype == (int)goldmine::Datatype::Price);
+		REQUIRE(sink->ticks[0].tick.value.toDouble() == Approx(64.6));
+		REQUIRE(sink->ticks[0].tick.volume == 0);
+		REQUIRE(sink->ticks[1].tick.datatype == (int)goldmine::Datatype::BestBid);
+		REQUIRE(sink->ticks[1].tick.timestamp == sink->ticks[0].tick.timestamp);
+	}
+
+	SECTION("Header row is skipped when the whole table is poked again")
+	{
+		table->set(1, 3, 64.7);
+		sink->ticks.clear();
+		parser.incomingTable(table);
+
+		REQUIRE(sink->ticks.size() == 1);
+		REQUIRE(sink->ticks[0].tick.value.toDouble() == Approx(64.7));
+		REQUIRE(InstrumentRegistry::instance().find("CLASS_CODE#CODE") == NoInstrument);
+	}
+
+	SECTION("on_change fields are suppressed when value is unchanged")
+	{
+		auto update = std::make_shared<XlTable>(6, 1);
+		update->setOrigin(1, 0);
+		update->set(0, 0, 64.5);
+		update->set(0, 1, std::string("USD000UTSTOM"));
+		update->set(0, 2, std::string("CETS"));
+		update->set(0, 3, 64.6);
+		update->set(0, 4, std::string("10:00:06"));
+		update->set(0, 5, std::string("19.10.2026"));
+		sink->ticks.clear();
+		parser.incomingTable(update);
+
+		REQUIRE(sink->ticks.size() == 1);
+		REQUIRE(sink->ticks[0].tick.datatype == (int)goldmine::Datatype::Price);
+	}
+
+	SECTION("Unknown datatype is a config error")
+	{
+		GenericTableParser bad("bad", sink);
+		REQUIRE_THROWS(bad.parseConfig(parseJson(R"({ "instrument" : "CODE", "fields" : [ { "column" : "x", "datatype" : "nope" } ] })")));
+	}
+}
@@ -0,0 +1,66 @@
+/*
+ * instrumentmetadata_test.cpp
+ */
+
+#include "catch.hpp"
+#include "core/instrumentmetadata.h"
+#include "core/quotetable.h"
+#include "core/tables/parsers/currentparametertableparser.h"
+#include "tests/testsinks.h"
+
+TEST_CASE("InstrumentMetadata", "[core][metadata]")
+{
+	auto& metadata = InstrumentMetadata::instance();
+	auto unknown = InstrumentRegistry::instance().id("TQBR#METADATA_UNKNOWN");
+	REQUIRE(metadata.priceStep(unknown) == InstrumentMetadata::DefaultPriceStep);
+	REQUIRE(metadata.scale(unknown) == -1);
+
+	REQUIRE(InstrumentMetadata::toTicks(0.1 + 0.2, 0.1) == 3);
+	REQUIRE(InstrumentMetadata::toTicks(123.45, 0.01) == 12345);
+	REQUIRE(InstrumentMetadata::toTicks(64123, 1) == 64123);
+	REQUIRE(InstrumentMetadata::toTicks(64125, 5) == 12825);
+
+	// Limits off the grid: buy rounds down, sell rounds up
+	REQUIRE(InstrumentMetadata::toTicksFloor(100.03, 0.05) == 2000);
+	REQUIRE(InstrumentMetadata::toTicksCeil(100.03, 0.05) == 2001);
+	REQUIRE(InstrumentMetadata::toTicksFloor(-0.03, 0.05) == -1);
+	REQUIRE(InstrumentMetadata::toTicksCeil(-0.03, 0.05) == 0);
+
+	// On the grid, despite binary rounding of the price
+	REQUIRE(InstrumentMetadata::toTicksFloor(100.05, 0.05) == 2001);
+	REQUIRE(InstrumentMetadata::toTicksCeil(100.05, 0.05) == 2001);
+	REQUIRE(InstrumentMetadata::toTicksFloor(0.1 + 0.2, 0.1) == 3);
+	REQUIRE(InstrumentMetadata::toTicksCeil(0.1 + 0.2, 0.1) == 3);
+}
+
+TEST_CASE("Price step is taken from current parameters table", "[core][metadata]")
+{
+	CurrentParameterTableParser parser("current", std::make_shared<CollectingSink>());
+
+	auto table = std::make_shared<XlTable>(5, 2);
+	table->set(0, 0, std::string("CLASS_CODE"));
+	table->set(0, 1, std::string("CODE"));
+	table->set(0, 2, std::string("last"));
+	table->set(0, 3, std::string("SEC_PRICE_STEP"));
+	table->set(0, 4, std::string("SEC_SCALE"));
+	table->set(1, 0, std::string("TQBR"));
+	table->set(1, 1, std::string("SBER"));
+	table->set(1, 2, 250.17);
+	table->set(1, 3, 0.01);
+	table->set(1, 4, 2.);
+	parser.incomingTable(table);
+
+	auto sber = InstrumentRegistry::instance().find("TQBR#SBER");
+	REQUIRE(InstrumentMetadata::instance().priceStep(sber) == 0.01);
+	REQUIRE(InstrumentMetadata::instance().scale(sber) == 2);
+
+	QuoteTable quotes;
+	goldmine::Tick tick;
+	tick.datatype = (int)goldmine::Datatype::BestBid;
+	tick.value = 250.17;
+	quotes.updateQuote(sber, tick);
+
+	auto quote = quotes.quote(sber, goldmine::Datatype::BestBid);
+	REQUIRE(quote.price == 25017);
+	REQUIRE(quote.step == 0.01);
+}
@@ -0,0 +1,43 @@
+/*
+ * instrumentregistry_test.cpp
+ */
+
+#include "catch.hpp"
+#include "core/instrumentregistry.h"
+
+TEST_CASE("InstrumentRegistry", "[instrumentregistry]")
+{
+	auto& registry = InstrumentRegistry::instance();
+
+	SECTION("Ids are dense and stable")
+	{
+		auto first = registry.id("TEST#REGISTRY1");
+		auto second = registry.id("TEST#REGISTRY2");
+
+		// Other tests register instruments too, so only ids found by name
+		// are compared
+		REQUIRE(first != NoInstrument);
+		REQUIRE(second != first);
+		REQUIRE(first <= registry.size());
+		REQUIRE(second <= registry.size());
+		REQUIRE(registry.id("TEST#REGISTRY1") == first);
+		REQUIRE(registry.find("TEST#REGISTRY1") == first);
+		REQUIRE(registry.find("TEST#REGISTRY2") == second);
+	}
+
+	SECTION("Names are resolved back from ids")
+	{
+		auto id = registry.id("TEST#REGISTRY3");
+
+		REQUIRE(registry.name(id) == "TEST#REGISTRY3");
+		REQUIRE(registry.name(NoInstrument).empty());
+	}
+
+	SECTION("Unknown names are not registered by find")
+	{
+		auto size = registry.size();
+
+		REQUIRE(registry.find("TEST#UNKNOWN") == NoInstrument);
+		REQUIRE(registry.size() == size);
+	}
+}
@@ -0,0 +1,123 @@
+/*
+ * journalcodec_test.cpp
+ */
+
+#include "catch.hpp"
+#include "core/journal/journalcodec.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+
+namespace
+{
+struct Block
+{
+	std::vector<uint32_t> instruments;
+	std::vector<int32_t> datatypes;
+	std::vector<uint64_t> timestamps;
+	std::vector<double> values;
+	std::vector<int32_t> volumes;
+
+	void add(uint32_t instrument, int32_t datatype, uint64_t timestamp, double value, int32_t volume)
+	{
+		instruments.push_back(instrument);
+		datatypes.push_back(datatype);
+		timestamps.push_back(timestamp);
+		values.push_back(value);
+		volumes.push_back(volume);
+	}
+
+	size_t encode(std::vector<char>& out, const JournalStepLookup& steps) const
+	{
+		JournalEncoder encoder;
+		out.resize(JournalEncoder::maxSize(timestamps.size()));
+		return encoder.encode(instruments.data(), datatypes.data(), timestamps.data(), values.data(), volumes.data(),
+				timestamps.size(), steps, out.data());
+	}
+
+	void check(const std::vector<char>& payload, size_t size) const
+	{
+		JournalBlockHeader header;
+		std::memset(&header, 0, sizeof(header));
+		header.encoding = (uint32_t)JournalEncoding::Packed;
+		header.count = timestamps.size();
+		header.size = size;
+		header.firstTimestamp = timestamps.front();
+
+		JournalColumns columns;
+		journalDecode(header, payload.data(), columns);
+		REQUIRE(columns.count == timestamps.size());
+		for(size_t i = 0; i < columns.count; i++)
+		{
+			REQUIRE(columns.instruments[i] == instruments[i]);
+			REQUIRE(columns.datatypes[i] == datatypes[i]);
+			REQUIRE(columns.timestamps[i] == timestamps[i]);
+			REQUIRE(std::memcmp(&columns.values[i], &values[i], sizeof(double)) == 0);
+			REQUIRE(columns.volumes[i] == volumes[i]);
+		}
+	}
+};
+}
+
+TEST_CASE("JournalCodec", "[core][journal]")
+{
+	REQUIRE(journalStep(10).units == 10);
+	REQUIRE(journalStep(10).decimals == 0);
+	REQUIRE(journalStep(0.0025).units == 25);
+	REQUIRE(journalStep(0.0025).decimals == 4);
+	REQUIRE(journalStep(0).units == 1);
+	REQUIRE(journalStep(0).decimals == 8);
+
+	auto steps = [](uint32_t instrument)
+		{
+			return journalStep(instrument % 2 ? 10 : 0.001);
+		};
+	std::vector<char> payload;
+
+	// Mixed keys: prices on step, values off step, non-finite values and
+	// volumes and timestamps going backwards
+	Block mixed;
+	std::mt19937 random(42);
+	uint64_t timestamp = 1477994400000000ULL;
+	for(int i = 0; i < 2000; i++)
+	{
+		uint32_t instrument = random() % 300;
+		timestamp += random() % 3 == 0 ? random() % 5000 : 0;
+		double price = instrument % 2 ? 100000 + 10 * (int)(random() % 100) : 60 + 0.001 * (int)(random() % 1000);
+		mixed.add(instrument, 1, timestamp, price, (int)(random() % 200) - 100);
+	}
+	mixed.add(1, 1, timestamp - 1000000, 100005, std::numeric_limits<int32_t>::min());
+	mixed.add(2, 50, timestamp, 0.1234567891234, std::numeric_limits<int32_t>::max());
+	mixed.add(2, 51, timestamp, -0.0, 0);
+	mixed.add(2, 52, timestamp, std::numeric_limits<double>::quiet_NaN(), 0);
+	mixed.add(2, 53, timestamp, 1e300, 0);
+	mixed.add(3, 1, 0, -1e-8, 0);
+	mixed.check(payload, mixed.encode(payload, steps));
+
+	// Single tick
+	Block single;
+	single.add(7, 1, 123, 1.5, 1);
+	single.check(payload, single.encode(payload, steps));
+
+	// Typical stream: few instruments, ticks in pokes, small price moves
+	Block typical;
+	// Prices as parsed from decimal strings, in steps of 10 and 0.001
+	std::vector<int64_t> prices(20, 0);
+	for(size_t i = 0; i < prices.size(); i++)
+		prices[i] = i % 2 ? 10000 : 65500;
+	timestamp = 1477994400000000ULL;
+	for(int i = 0; i < 4096; i++)
+	{
+		if(i % 8 == 0)
+			timestamp += 500 + random() % 100;
+		uint32_t instrument = random() % prices.size();
+		prices[instrument] += (int)(random() % 7) - 3;
+		double price = instrument % 2 ? prices[instrument] * 10. : prices[instrument] / 1000.;
+		typical.add(instrument, 1, timestamp, price, 1 + random() % 20);
+	}
+	size_t size = typical.encode(payload, steps);
+	typical.check(payload, size);
+	REQUIRE(JournalRawLayout(4096).size > 5 * size);
+}
@@ -0,0 +1,152 @@
+/*
+ * journalindex_test.cpp
+ */
+
+#include "catch.hpp"
+#include "core/journal/tickjournal.h"
+#include "core/journal/journalreader.h"
+#include "core/journal/journalindex.h"
+#include "exceptions.h"
+#include "tests/testjournal.h"
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <fstream>
+
+namespace
+{
+// 2016-11-01 10:00:00 UTC
+const uint64_t gs_start = 1477994400;
+
+// Blocks which really have ticks of instrument within [from, to]
+std::vector<uint32_t> scan(const JournalReader& reader, uint32_t instrument, uint64_t from, uint64_t to)
+{
+	std::vector<uint32_t> result;
+	JournalColumns columns;
+	for(size_t block = 0; block < reader.blocks(); block++)
+	{
+		reader.readBlock(block, columns);
+		for(size_t i = 0; i < columns.count; i++)
+		{
+			if((instrument == NoJournalInstrument || columns.instruments[i] == instrument) &&
+					columns.timestamps[i] >= from && columns.timestamps[i] <= to)
+			{
+				result.push_back(block);
+				break;
+			}
+		}
+	}
+	return result;
+}
+
+void checkQueries(const JournalReader& reader, const JournalIndex& index)
+{
+	REQUIRE(index.blocks() == reader.blocks());
+	for(size_t block = 0; block < reader.blocks(); block++)
+		REQUIRE(index.entry(block).offset == reader.blockOffset(block));
+
+	const uint64_t second = 1000000;
+	const uint64_t ranges[][2] = { { 0, ~(uint64_t)0 }, { gs_start * second, gs_start * second },
+			{ (gs_start + 100) * second, (gs_start + 130) * second }, { (gs_start + 590) * second, (gs_start + 700) * second },
+			{ (gs_start - 10) * second, (gs_start - 1) * second } };
+	const uint32_t instruments[] = { NoJournalInstrument, 0, 1, 2, 3 };
+	for(const auto& range : ranges)
+	{
+		for(auto instrument : instruments)
+		{
+			auto found = index.find(instrument, range[0], range[1]);
+			auto expected = scan(reader, instrument, range[0], range[1]);
+			REQUIRE(std::is_sorted(found.begin(), found.end()));
+			REQUIRE(std::includes(found.begin(), found.end(), expected.begin(), expected.end()));
+			if(index.complete())
+			{
+				for(auto block : found)
+				{
+					const auto& entry = index.entry(block);
+					REQUIRE(entry.minTimestamp <= range[1]);
+					REQUIRE(entry.maxTimestamp >= range[0]);
+				}
+			}
+		}
+	}
+}
+}
+
+TEST_CASE("JournalIndex", "[core][journal]")
+{
+	TempDirectory directory;
+	auto path = journalFileName(directory.path, 20161101);
+
+	{
+		TickJournal journal(directory.path, 16, 4096);
+
+		// Three instruments over 10 minutes, the third one only in the middle
+		std::vector<TickUpdate> ticks;
+		for(int i = 0; i < 600; i++)
+		{
+			ticks.push_back(makeTick("SPBFUT#RIZ6", gs_start + i, 0, 100000 + 10 * (i % 7)));
+			if(i % 3 == 0)
+				ticks.push_back(makeTick("SPBFUT#SiZ6", gs_start + i, 0, 65 + 0.001 * i));
+			if(i >= 200 && i < 250)
+				ticks.push_back(makeTick("SPBFUT#BRZ6", gs_start + i, 0, 50 + 0.01 * i));
+		}
+		journal.consume(ticks.data(), ticks.size());
+
+		// Trades replayed late, with earlier timestamps
+		ticks.clear();
+		for(int i = 0; i < 20; i++)
+			ticks.push_back(makeTick("SPBFUT#BRZ6", gs_start + 110 + i, 0, 49));
+		journal.consume(ticks.data(), ticks.size());
+		journal.sealBlock();
+
+		// Live index has entries but no per-instrument lists yet
+		JournalIndex live(journalIndexFileName(path));
+		REQUIRE_FALSE(live.complete());
+		REQUIRE(live.day() == 20161101);
+		checkQueries(JournalReader(path), live);
+	}
+
+	JournalReader reader(path);
+	REQUIRE(reader.instrument("SPBFUT#BRZ6") == 2);
+	{
+		JournalIndex index(journalIndexFileName(path));
+		REQUIRE(index.complete());
+		checkQueries(reader, index);
+
+		// Late trades are found although later blocks started after them
+		const uint64_t second = 1000000;
+		auto found = index.find(2, (gs_start + 115) * second, (gs_start + 116) * second);
+		REQUIRE(found.size() == 1);
+		REQUIRE(reader.blockHeader(found[0]).firstTimestamp > (gs_start + 500) * second);
+		REQUIRE(found == scan(reader, 2, (gs_start + 115) * second, (gs_start + 116) * second));
+		REQUIRE(index.find(2, (gs_start - 100) * second, (gs_start + 100) * second).empty());
+		REQUIRE(index.find(7, 0, ~(uint64_t)0).empty());
+	}
+
+	// Index is rebuilt when the journal is reopened
+	boost::filesystem::remove(journalIndexFileName(path));
+	{
+		TickJournal journal(directory.path, 16, 4096);
+		auto tick = makeTick("SPBFUT#RIZ6", gs_start + 1000, 0, 100000);
+		journal.consume(&tick, 1);
+	}
+	JournalReader reopened(path);
+	JournalIndex index(journalIndexFileName(path));
+	REQUIRE(index.complete());
+	REQUIRE(index.blocks() == reader.blocks() + 1);
+	checkQueries(reopened, index);
+
+	// Block list pointing past the last block is rejected on open
+	auto corrupted = directory.path + "/corrupted.idx";
+	boost::filesystem::copy_file(journalIndexFileName(path), corrupted);
+	{
+		std::fstream file(corrupted, std::ios::in | std::ios::out | std::ios::binary);
+		JournalIndexHeader header;
+		file.read(reinterpret_cast<char*>(&header), sizeof(header));
+		uint32_t block = header.blocks;
+		file.seekp(header.postingsOffset + (header.instruments + 1) * sizeof(uint64_t));
+		file.write(reinterpret_cast<const char*>(&block), sizeof(block));
+	}
+	REQUIRE_THROWS_AS(JournalIndex(corrupted), FormatError);
+}
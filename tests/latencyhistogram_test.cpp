@@ -0,0 +1,81 @@
+/*
+ * latencyhistogram_test.cpp
+ */
+
+#include "catch.hpp"
+#include "core/stats/latencyhistogram.h"
+#include "core/stats/latencyrecorder.h"
+
+TEST_CASE("LatencyHistogram", "[stats][latency_histogram]")
+{
+	SECTION("Small values map to exact buckets")
+	{
+		for(uint64_t i = 0; i < 32; i++)
+		{
+			REQUIRE(LatencyHistogram::bucketIndex(i) == (int)i);
+			REQUIRE(LatencyHistogram::bucketLowerBound(i) == i);
+		}
+	}
+
+	SECTION("Bucket lower bound is within precision of the value")
+	{
+		for(uint64_t v = 1; v < (1ULL << 36); v = v * 3 + 1)
+		{
+			auto lower = LatencyHistogram::bucketLowerBound(LatencyHistogram::bucketIndex(v));
+			REQUIRE(lower <= v);
+			REQUIRE((v - lower) * LatencyHistogram::SubBuckets <= v);
+		}
+	}
+
+	SECTION("Huge values are clamped to the last bucket")
+	{
+		REQUIRE(LatencyHistogram::bucketIndex(~0ULL) == LatencyHistogram::BucketsCount - 1);
+	}
+
+	SECTION("Percentiles")
+	{
+		LatencyHistogram h;
+		REQUIRE(h.count() == 0);
+		REQUIRE(h.percentile(50) == 0);
+
+		for(int i = 1; i <= 100; i++)
+			h.record(i * 1000);
+
+		REQUIRE(h.count() == 100);
+		REQUIRE(h.max() == 100000);
+
+		auto median = h.percentile(50);
+		REQUIRE(median <= 50000);
+		REQUIRE(median >= 50000 * 15 / 16);
+
+		h.reset();
+		REQUIRE(h.count() == 0);
+		REQUIRE(h.max() == 0);
+	}
+}
+
+TEST_CASE("LatencyRecorder", "[stats][latency_histogram]")
+{
+	auto& recorder = LatencyRecorder::instance();
+	auto topic = recorder.topic("test:recorder");
+	auto parser = recorder.topic("test:recorder/1");
+	REQUIRE(recorder.topic("test:recorder") == topic);
+	REQUIRE(parser != topic);
+
+	const auto& parse = topic->stages[(size_t)LatencyStage::Parse];
+	const auto& total = topic->stages[(size_t)LatencyStage::Total];
+	auto parseCount = parse.count();
+	auto totalCount = total.count();
+	auto parserCount = parser->stages[(size_t)LatencyStage::Parse].count();
+	{
+		LatencyPoke poke(topic);
+		LatencyRecorder::mark(LatencyStage::Parse, parser);
+	}
+
+	// Marks outside of a poke are ignored
+	LatencyRecorder::mark(LatencyStage::Parse);
+
+	REQUIRE(parser->stages[(size_t)LatencyStage::Parse].count() == parserCount + 1);
+	REQUIRE(parse.count() == parseCount);
+	REQUIRE(total.count() == totalCount + 1);
+}
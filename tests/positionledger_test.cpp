@@ -0,0 +1,171 @@
+/*
+ * positionledger_test.cpp
+ */
+
+#include "catch.hpp"
+#include "core/positionledger.h"
+#include "core/tables/parsers/futurespositionstableparser.h"
+#include "core/tables/parsers/futureslimitstableparser.h"
+
+namespace
+{
+struct PositionRow
+{
+	std::string account;
+	std::string code;
+	double position;
+};
+
+XlTable::Ptr makePositions(const std::vector<PositionRow>& rows)
+{
+	auto table = std::make_shared<XlTable>(3, rows.size() + 1);
+	table->set(0, 0, std::string("TRDACCID"));
+	table->set(0, 1, std::string("SEC_CODE"));
+	table->set(0, 2, std::string("TOTAL_NET"));
+	for(size_t i = 0; i < rows.size(); i++)
+	{
+		table->set(i + 1, 0, rows[i].account);
+		table->set(i + 1, 1, rows[i].code);
+		table->set(i + 1, 2, rows[i].position);
+	}
+	return table;
+}
+}
+
+TEST_CASE("PositionLedger", "[core][positions]")
+{
+	PositionLedger ledger;
+	auto first = ledger.account("SPBFUT0001");
+	auto second = ledger.account("SPBFUT0002");
+	REQUIRE(ledger.account("SPBFUT0001") == first);
+	REQUIRE(first != second);
+
+	auto si = InstrumentRegistry::instance().id("SPBFUT#SiZ6");
+	auto ri = InstrumentRegistry::instance().id("SPBFUT#RIZ6");
+	std::vector<PositionUpdate> updates { { first, si, 3 }, { first, ri, -2 }, { second, si, 5 } };
+	ledger.updatePositions(updates.data(), updates.size());
+
+	REQUIRE(ledger.position(first, si) == 3);
+	REQUIRE(ledger.position(second, ri) == 0);
+
+	PositionUpdate closed { first, ri, 0 };
+	ledger.updatePositions(&closed, 1);
+
+	auto positions = ledger.positions({ "SPBFUT0001", "UNKNOWN" });
+	REQUIRE(positions.size() == 1);
+	REQUIRE(positions.front().security == "SPBFUT#SiZ6");
+	REQUIRE(positions.front().amount == 3);
+}
+
+TEST_CASE("FuturesPositionsTableParser", "[tables][positions]")
+{
+	auto ledger = std::make_shared<PositionLedger>();
+	FuturesPositionsTableParser parser("positions", ledger);
+	parser.parseConfig(Json::Value());
+
+	parser.incomingTable(makePositions({ { "SPBFUT0001", "SiZ6", 2 }, { "SPBFUT0001", "RIZ6", -1 } }));
+	auto account = ledger->account("SPBFUT0001");
+	auto si = InstrumentRegistry::instance().id("SPBFUT#SiZ6");
+	auto ri = InstrumentRegistry::instance().id("SPBFUT#RIZ6");
+	REQUIRE(ledger->position(account, si) == 2);
+	REQUIRE(ledger->position(account, ri) == -1);
+
+	SECTION("Partial update changes only poked row")
+	{
+		auto update = std::make_shared<XlTable>(3, 1);
+		update->setOrigin(2, 0);
+		update->set(0, 0, std::string("SPBFUT0001"));
+		update->set(0, 1, std::string("RIZ6"));
+		update->set(0, 2, 4.);
+		parser.incomingTable(update);
+
+		REQUIRE(ledger->position(account, si) == 2);
+		REQUIRE(ledger->position(account, ri) == 4);
+		REQUIRE(ledger->positions({ "SPBFUT0001" }).size() == 2);
+	}
+
+	SECTION("Row showing another contract closes the old position")
+	{
+		auto update = std::make_shared<XlTable>(3, 1);
+		update->setOrigin(2, 0);
+		update->set(0, 0, std::string("SPBFUT0001"));
+		update->set(0, 1, std::string("BRZ6"));
+		update->set(0, 2, 7.);
+		parser.incomingTable(update);
+
+		REQUIRE(ledger->position(account, ri) == 0);
+		REQUIRE(ledger->position(account, InstrumentRegistry::instance().id("SPBFUT#BRZ6")) == 7);
+	}
+
+	SECTION("Blanked row closes its position")
+	{
+		auto update = std::make_shared<XlTable>(3, 1);
+		update->setOrigin(1, 0);
+		parser.incomingTable(update);
+
+		REQUIRE(ledger->position(account, si) == 0);
+		REQUIRE(ledger->position(account, ri) == -1);
+	}
+
+	SECTION("Whole table poked again updates every row")
+	{
+		parser.incomingTable(makePositions({ { "SPBFUT0001", "SiZ6", 3 }, { "SPBFUT0001", "RIZ6", -1 } }));
+
+		REQUIRE(ledger->position(account, si) == 3);
+		REQUIRE(ledger->position(account, ri) == -1);
+		REQUIRE(ledger->positions({ "TRDACCID" }).empty());
+	}
+
+	SECTION("Row moved up keeps its position")
+	{
+		auto update = std::make_shared<XlTable>(3, 2);
+		update->setOrigin(1, 0);
+		update->set(0, 0, std::string("SPBFUT0001"));
+		update->set(0, 1, std::string("RIZ6"));
+		update->set(0, 2, -1.);
+		parser.incomingTable(update);
+
+		REQUIRE(ledger->position(account, si) == 0);
+		REQUIRE(ledger->position(account, ri) == -1);
+	}
+}
+
+TEST_CASE("FuturesLimitsTableParser", "[tables][positions]")
+{
+	auto ledger = std::make_shared<PositionLedger>();
+	FuturesLimitsTableParser parser("limits", ledger);
+	Json::Value config;
+	config["limit_type"] = "money";
+	parser.parseConfig(config);
+
+	auto table = std::make_shared<XlTable>(4, 3);
+	table->set(0, 0, std::string("TRDACCID"));
+	table->set(0, 1, std::string("LIMIT_TYPE"));
+	table->set(0, 2, std::string("CBPLIMIT"));
+	table->set(0, 3, std::string("CBPLUSED"));
+	table->set(1, 0, std::string("SPBFUT0001"));
+	table->set(1, 1, std::string("collateral"));
+	table->set(1, 2, 1000.);
+	table->set(2, 0, std::string("SPBFUT0001"));
+	table->set(2, 1, std::string("money"));
+	table->set(2, 2, 500000.);
+	table->set(2, 3, 12000.);
+	parser.incomingTable(table);
+
+	AccountLimits limits;
+	REQUIRE(ledger->limits(ledger->account("SPBFUT0001"), limits));
+	REQUIRE(limits.limit == 500000.);
+	REQUIRE(limits.used == 12000.);
+	REQUIRE(limits.variationMargin == 0);
+	REQUIRE(!ledger->limits(ledger->account("SPBFUT0002"), limits));
+
+	SECTION("Limit type is required if table has the column")
+	{
+		FuturesLimitsTableParser untyped("limits", ledger);
+		REQUIRE_THROWS(untyped.parseConfig(Json::Value()));
+
+		Json::Value noColumn;
+		noColumn["columns"]["limit_type"] = "";
+		REQUIRE_NOTHROW(untyped.parseConfig(noColumn));
+	}
+}
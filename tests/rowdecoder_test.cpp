@@ -0,0 +1,41 @@
+/*
+ * rowdecoder_test.cpp
+ */
+
+#include "catch.hpp"
+#include "core/tables/rowdecoder.h"
+
+TEST_CASE("RowDecoder", "[tables][row_decoder]")
+{
+	enum { Code = 0, Price, Volume, MaxId };
+	std::vector<std::string> columns = { "CODE", "last", "voltoday" };
+
+	XlTable table(3, 2);
+	table.set(0, 0, std::string("last"));
+	table.set(0, 1, std::string("CODE"));
+	table.set(0, 2, std::string("unknown"));
+	table.set(1, 0, 100.5);
+	table.set(1, 1, std::string("RIZ6"));
+
+	RowDecoder decoder;
+	REQUIRE(!decoder.compiled());
+	decoder.compile(table, columns);
+	REQUIRE(decoder.compiled());
+
+	SECTION("Column presence is known after compilation")
+	{
+		REQUIRE(decoder.hasColumn(Code));
+		REQUIRE(decoder.hasColumn(Price));
+		REQUIRE(!decoder.hasColumn(Volume));
+	}
+
+	SECTION("Typed accessors do not throw on missing or mistyped cells")
+	{
+		auto row = decoder.row(table, 1);
+		REQUIRE(*row.number(Price) == 100.5);
+		REQUIRE(*row.string(Code) == "RIZ6");
+		REQUIRE(!row.number(Volume));
+		REQUIRE(!row.string(Price));
+		REQUIRE(!row.number(Code));
+	}
+}
@@ -0,0 +1,60 @@
+/*
+ * sharedmemoryring_test.cpp
+ */
+
+#include "catch.hpp"
+#include "core/ingest/sharedmemoryring.h"
+#include "core/ingest/sharedmemoryingestserver.h"
+#include "tests/testsinks.h"
+
+#include <boost/thread.hpp>
+#include <vector>
+
+TEST_CASE("SharedMemoryRing", "[ingest][shm]")
+{
+	SECTION("Ring rejects writes when full and releases slots on consume")
+	{
+		std::vector<char> buffer(SharedMemoryRing::bytesRequired(4));
+		SharedMemoryRing ring(buffer.data());
+		ring.initialize(4);
+		REQUIRE(ring.valid());
+
+		ShmTickRecord record = {};
+		for(int i = 0; i < 4; i++)
+		{
+			record.volume = i;
+			REQUIRE(ring.tryWrite(record));
+		}
+		REQUIRE(!ring.tryWrite(record));
+		REQUIRE(ring.available() == 4);
+
+		std::vector<int> volumes;
+		auto consumed = ring.consume(3, [&](const ShmTickRecord& r) { volumes.push_back(r.volume); });
+		REQUIRE(consumed == 3);
+		REQUIRE(volumes == std::vector<int>({ 0, 1, 2 }));
+		REQUIRE(ring.tryWrite(record));
+		REQUIRE(ring.available() == 2);
+	}
+
+	SECTION("Ingest server delivers records written by the writer stand-in")
+	{
+		auto sink = std::make_shared<RecordingSink>();
+		SharedMemoryRingWriter writer("gqg-test-ring", 1024);
+		SharedMemoryIngestServer server("gqg-test-ring", sink);
+		server.start();
+
+		for(int i = 0; i < 100; i++)
+			REQUIRE(writer.write("SPBFUT#RIZ6", (int)goldmine::Datatype::Price, 100000. + i, i + 1, 1500000000123456ULL));
+
+		for(int i = 0; i < 500 && sink->size() < 100; i++)
+			boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+		server.stop();
+
+		REQUIRE(sink->size() == 100);
+		REQUIRE(sink->tickers[99] == "SPBFUT#RIZ6");
+		REQUIRE(sink->ticks[99].value.toDouble() == 100099.);
+		REQUIRE(sink->ticks[99].volume == 100);
+		REQUIRE(sink->ticks[99].timestamp == 1500000000);
+		REQUIRE(sink->ticks[99].useconds == 123456);
+	}
+}
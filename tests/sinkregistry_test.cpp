@@ -0,0 +1,105 @@
+/*
+ * sinkregistry_test.cpp
+ */
+
+#include "catch.hpp"
+#include "core/sinks/sinkregistry.h"
+
+#include <sstream>
+#include <thread>
+
+namespace
+{
+class CountingSink : public TickSink
+{
+public:
+	CountingSink(int delayUs = 0) : count(0), idleCalls(0), m_delayUs(delayUs)
+	{
+	}
+
+	virtual void consume(const TickUpdate* updates, size_t n) override
+	{
+		if(m_delayUs > 0)
+			std::this_thread::sleep_for(std::chrono::microseconds(m_delayUs));
+		count += n;
+	}
+
+	virtual void idle() override
+	{
+		idleCalls++;
+	}
+
+	std::atomic<size_t> count;
+	std::atomic<int> idleCalls;
+
+private:
+	int m_delayUs;
+};
+
+class PublishingSink : public CountingSink
+{
+public:
+	virtual bool publishes() const override
+	{
+		return true;
+	}
+};
+}
+
+TEST_CASE("SinkRegistry", "[core][sinks]")
+{
+	REQUIRE(SinkRegistry::parsePolicy("drop") == SlowSinkPolicy::Drop);
+	REQUIRE_THROWS(SinkRegistry::parsePolicy("wait"));
+
+	auto ring = std::make_shared<TickRing>(256);
+	SinkRegistry registry(ring);
+	auto fast = std::make_shared<CountingSink>();
+	auto slow = std::make_shared<CountingSink>(2000);
+	registry.registerSink("fast", fast, SlowSinkPolicy::Block);
+	registry.registerSink("slow", slow, SlowSinkPolicy::Drop);
+	registry.start();
+	REQUIRE_THROWS(registry.registerSink("late", fast, SlowSinkPolicy::Block));
+
+	const size_t total = 20000;
+	std::vector<TickUpdate> batch(100);
+	for(size_t i = 0; i < total / batch.size(); i++)
+		ring->publish(batch.data(), batch.size());
+	registry.stop();
+
+	std::ostringstream stats;
+	registry.dumpStats(stats);
+
+	REQUIRE(fast->count == total);
+	REQUIRE(fast->idleCalls >= 1);
+	REQUIRE(slow->count < total);
+	REQUIRE(stats.str().find("slow consumed=") != std::string::npos);
+}
+
+TEST_CASE("SinkRegistry marks publish latency", "[core][sinks]")
+{
+	auto topic = LatencyRecorder::instance().topic("sinkregistry_test");
+	auto& histogram = topic->stages[(size_t)LatencyStage::Publish];
+	histogram.reset();
+
+	auto ring = std::make_shared<TickRing>(256);
+	SinkRegistry registry(ring);
+	auto publishing = std::make_shared<PublishingSink>();
+	auto other = std::make_shared<CountingSink>();
+	registry.registerSink("publishing", publishing, SlowSinkPolicy::Block);
+	registry.registerSink("other", other, SlowSinkPolicy::Block);
+	registry.start();
+
+	std::vector<TickUpdate> batch(10);
+	for(int poke = 0; poke < 3; poke++)
+	{
+		LatencyPoke latency(topic, LatencyClock::now() + poke);
+		ring->publish(batch.data(), batch.size());
+	}
+	// Ticks published outside of a poke are not measured
+	ring->publish(batch.data(), batch.size());
+	registry.stop();
+
+	REQUIRE(publishing->count == 40);
+	REQUIRE(other->count == 40);
+	REQUIRE(histogram.count() == 3);
+}
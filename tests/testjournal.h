@@ -0,0 +1,42 @@
+/*
+ * testjournal.h
+ */
+
+#ifndef TESTS_TESTJOURNAL_H_
+#define TESTS_TESTJOURNAL_H_
+
+#include "core/tables/datasink.h"
+
+#include <boost/filesystem.hpp>
+
+#include <string>
+
+/**
+ * Unique directory under the system temp path, removed with its contents
+ */
+struct TempDirectory
+{
+	TempDirectory() : path((boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string())
+	{
+	}
+
+	~TempDirectory()
+	{
+		boost::filesystem::remove_all(path);
+	}
+
+	std::string path;
+};
+
+inline TickUpdate makeTick(const std::string& ticker, uint64_t seconds, uint32_t useconds, double value, int volume = 1)
+{
+	goldmine::Tick tick;
+	tick.timestamp = seconds;
+	tick.useconds = useconds;
+	tick.datatype = (int)goldmine::Datatype::Price;
+	tick.value = value;
+	tick.volume = volume;
+	return TickUpdate { InstrumentRegistry::instance().id(ticker), tick };
+}
+
+#endif /* TESTS_TESTJOURNAL_H_ */
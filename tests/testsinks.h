@@ -0,0 +1,69 @@
+/*
+ * testsinks.h
+ */
+
+#ifndef TESTS_TESTSINKS_H_
+#define TESTS_TESTSINKS_H_
+
+#include "core/tables/datasink.h"
+
+#include <boost/thread.hpp>
+
+#include <string>
+#include <vector>
+
+/**
+ * Keeps every batch passed to incomingTicks(). Single-tick calls are only
+ * counted, so tests can check that a producer delivers batches.
+ */
+class CollectingSink : public DataSink
+{
+public:
+	virtual void incomingTick(const std::string& ticker, const goldmine::Tick& tick) override
+	{
+		singleTicks++;
+	}
+
+	virtual void incomingTicks(const TickUpdate* updates, size_t count) override
+	{
+		ticks.insert(ticks.end(), updates, updates + count);
+		batches.push_back(std::vector<TickUpdate>(updates, updates + count));
+		buffers.push_back(updates);
+	}
+
+	const std::string& ticker(size_t i) const
+	{
+		return InstrumentRegistry::instance().name(ticks[i].instrument);
+	}
+
+	int singleTicks = 0;
+	std::vector<TickUpdate> ticks;
+	std::vector<std::vector<TickUpdate>> batches;
+	std::vector<const TickUpdate*> buffers;
+};
+
+/**
+ * Keeps ticks passed to incomingTick() by name; may be fed from another thread.
+ */
+class RecordingSink : public DataSink
+{
+public:
+	virtual void incomingTick(const std::string& ticker, const goldmine::Tick& tick) override
+	{
+		boost::unique_lock<boost::mutex> lock(mutex);
+		tickers.push_back(ticker);
+		ticks.push_back(tick);
+	}
+
+	size_t size()
+	{
+		boost::unique_lock<boost::mutex> lock(mutex);
+		return ticks.size();
+	}
+
+	boost::mutex mutex;
+	std::vector<std::string> tickers;
+	std::vector<goldmine::Tick> ticks;
+};
+
+#endif /* TESTS_TESTSINKS_H_ */
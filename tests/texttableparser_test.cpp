@@ -0,0 +1,254 @@
+/*
+ * texttableparser_test.cpp
+ */
+
+#include "catch.hpp"
+#include "xl/texttableparser.h"
+#include "xl/xlparser.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+	void appendWord(std::vector<uint8_t>& buf, uint16_t word)
+	{
+		buf.push_back(word & 0xff);
+		buf.push_back(word >> 8);
+	}
+
+	std::vector<uint8_t> makeXlTable()
+	{
+		std::vector<uint8_t> buf;
+		appendWord(buf, 16);
+		appendWord(buf, 4);
+		appendWord(buf, 2); // height
+		appendWord(buf, 3); // width
+
+		appendWord(buf, 2);
+		appendWord(buf, 12);
+		buf.push_back(6);
+		for(char c : std::string("SPBFUT"))
+			buf.push_back(c);
+		buf.push_back(4);
+		for(char c : std::string("RIZ6"))
+			buf.push_back(c);
+
+		appendWord(buf, 1);
+		appendWord(buf, 8);
+		double price = 101230.5;
+		uint8_t raw[8];
+		std::memcpy(raw, &price, 8);
+		buf.insert(buf.end(), raw, raw + 8);
+
+		appendWord(buf, 2);
+		appendWord(buf, 7);
+		buf.push_back(6);
+		for(char c : std::string("SPBFUT"))
+			buf.push_back(c);
+
+		appendWord(buf, 5);
+		appendWord(buf, 2);
+		appendWord(buf, 2);
+		return buf;
+	}
+
+	typedef std::vector<std::vector<XlTable::XlCell>> Cells;
+
+	// Board-like table: codes, prices, volumes, names and empty cells
+	Cells makeCells(int height)
+	{
+		Cells cells;
+		for(int i = 0; i < height; i++)
+		{
+			cells.push_back({ std::string("SPBFUT"), std::string("RI") + std::to_string(i), 100000. + i * 0.25,
+				(double)(i % 97), XlTable::XlEmpty(), std::string("Futures contract RTS index ") + std::to_string(i) });
+		}
+		return cells;
+	}
+
+	std::vector<uint8_t> encodeXl(const Cells& cells)
+	{
+		std::vector<uint8_t> buf;
+		appendWord(buf, 16);
+		appendWord(buf, 4);
+		appendWord(buf, cells.size());
+		appendWord(buf, cells[0].size());
+		for(const auto& row : cells)
+		{
+			for(const auto& cell : row)
+			{
+				if(auto d = boost::get<double>(&cell))
+				{
+					appendWord(buf, 1);
+					appendWord(buf, 8);
+					uint8_t raw[8];
+					std::memcpy(raw, d, 8);
+					buf.insert(buf.end(), raw, raw + 8);
+				}
+				else if(auto s = boost::get<std::string>(&cell))
+				{
+					appendWord(buf, 2);
+					appendWord(buf, s->size() + 1);
+					buf.push_back(s->size());
+					buf.insert(buf.end(), s->begin(), s->end());
+				}
+				else
+				{
+					appendWord(buf, 5);
+					appendWord(buf, 2);
+					appendWord(buf, 1);
+				}
+			}
+		}
+		return buf;
+	}
+
+	std::string encodeText(const Cells& cells)
+	{
+		std::ostringstream out;
+		out.precision(15);
+		for(const auto& row : cells)
+		{
+			for(size_t column = 0; column < row.size(); column++)
+			{
+				if(column > 0)
+					out << '\t';
+				if(auto d = boost::get<double>(&row[column]))
+					out << *d;
+				else if(auto s = boost::get<std::string>(&row[column]))
+					out << *s;
+			}
+			out << "\r\n";
+		}
+		return out.str();
+	}
+
+	bool sameCell(const XlTable::XlCell& a, const XlTable::XlCell& b)
+	{
+		if(a.which() != b.which())
+			return false;
+		if(auto d = boost::get<double>(&a))
+			return *d == boost::get<double>(b);
+		if(auto s = boost::get<std::string>(&a))
+			return *s == boost::get<std::string>(b);
+		return true;
+	}
+}
+
+TEST_CASE("TextTableParser", "[xl][text_table_parser]")
+{
+	SECTION("Text table is decoded to the same representation as XlTable")
+	{
+		std::string text = "SPBFUT\tRIZ6\t101230.5\r\nSPBFUT\t\t\r\n";
+		text.push_back('\0');
+
+		TextTableParser textParser;
+		textParser.parse(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+		auto textTable = textParser.getParsedTable();
+
+		auto xlData = makeXlTable();
+		XlParser xlParser;
+		xlParser.parse(xlData.data(), xlData.size());
+		auto xlTable = xlParser.getParsedTable();
+
+		REQUIRE(textTable->width() == xlTable->width());
+		REQUIRE(textTable->height() == xlTable->height());
+		for(int row = 0; row < xlTable->height(); row++)
+		{
+			for(int column = 0; column < xlTable->width(); column++)
+				REQUIRE(sameCell(textTable->get(row, column), xlTable->get(row, column)));
+		}
+	}
+
+	SECTION("Ragged lines are padded to the widest one")
+	{
+		std::string text = "SPBFUT\tRIZ6\r\nSPBFUT\tSiZ6\t64000\r\nTQBR\r\n";
+		TextTableParser parser;
+		parser.parse(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+		auto table = parser.getParsedTable();
+
+		REQUIRE(table->width() == 3);
+		REQUIRE(table->height() == 3);
+		REQUIRE(boost::get<double>(table->get(1, 2)) == 64000.);
+		REQUIRE(boost::get<XlTable::XlEmpty>(&table->cell(0, 2)));
+		REQUIRE(boost::get<std::string>(table->get(2, 0)) == "TQBR");
+		REQUIRE(boost::get<XlTable::XlEmpty>(&table->cell(2, 1)));
+	}
+
+	SECTION("Empty last cell of the last line counts")
+	{
+		std::string text = "SPBFUT\tRIZ6\r\nTQBR\t\r\n";
+		TextTableParser parser;
+		parser.parse(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+		auto table = parser.getParsedTable();
+
+		REQUIRE(table->width() == 2);
+		REQUIRE(table->height() == 2);
+		REQUIRE(boost::get<std::string>(table->get(1, 0)) == "TQBR");
+		REQUIRE(boost::get<XlTable::XlEmpty>(&table->cell(1, 1)));
+	}
+
+	SECTION("Empty data gives empty table")
+	{
+		std::string text = "\r\n";
+		TextTableParser parser;
+		parser.parse(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+		REQUIRE(parser.getParsedTable()->height() == 0);
+	}
+}
+
+TEST_CASE("TextTableParser matches XlParser on a board table", "[xl][text_table_parser]")
+{
+	auto cells = makeCells(1000);
+	auto text = encodeText(cells);
+	auto xlData = encodeXl(cells);
+
+	TextTableParser textParser;
+	textParser.parse(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+	auto textTable = textParser.getParsedTable();
+	XlParser xlParser;
+	xlParser.parse(xlData.data(), xlData.size());
+	auto xlTable = xlParser.getParsedTable();
+
+	REQUIRE(textTable->width() == xlTable->width());
+	REQUIRE(textTable->height() == xlTable->height());
+	bool same = true;
+	for(int row = 0; row < xlTable->height(); row++)
+	{
+		for(int column = 0; column < xlTable->width(); column++)
+			same = same && sameCell(textTable->cell(row, column), xlTable->cell(row, column));
+	}
+	REQUIRE(same);
+}
+
+// Hidden; run with: tests "[benchmark]"
+TEST_CASE("TextTableParser and XlParser throughput", "[.][benchmark][text_table_parser]")
+{
+	const int iterations = 200;
+	auto cells = makeCells(1000);
+	auto text = encodeText(cells);
+	auto xlData = encodeXl(cells);
+
+	TextTableParser textParser;
+	auto started = std::chrono::steady_clock::now();
+	for(int i = 0; i < iterations; i++)
+		textParser.parse(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+	auto textTime = std::chrono::steady_clock::now() - started;
+
+	XlParser xlParser;
+	started = std::chrono::steady_clock::now();
+	for(int i = 0; i < iterations; i++)
+		xlParser.parse(xlData.data(), xlData.size());
+	auto xlTime = std::chrono::steady_clock::now() - started;
+
+	auto us = [&](std::chrono::steady_clock::duration d)
+		{
+			return std::chrono::duration_cast<std::chrono::microseconds>(d).count() / iterations;
+		};
+	std::cout << "1000x6 table, us per parse: CF_TEXT " << us(textTime) << " (" << text.size() << " bytes), XlTable "
+		<< us(xlTime) << " (" << xlData.size() << " bytes)" << std::endl;
+	REQUIRE(textParser.getParsedTable()->height() == xlParser.getParsedTable()->height());
+}
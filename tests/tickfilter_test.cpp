@@ -0,0 +1,75 @@
+/*
+ * tickfilter_test.cpp
+ */
+
+#include "catch.hpp"
+#include "core/tables/tickfilter.h"
+#include "core/tables/datatypes.h"
+
+TEST_CASE("TickFilter", "[tables][tick_filter]")
+{
+	TickFilter filter;
+	REQUIRE(filter.empty());
+
+	filter.addRule("SPBFUT#RIZ6");
+	filter.addRule("SPBFUT#Si*/price");
+	filter.addRule("*/depth");
+	REQUIRE(!filter.empty());
+
+	SECTION("Exact rule without datatype suppresses everything")
+	{
+		auto mask = filter.mask("SPBFUT#RIZ6");
+		REQUIRE(TickFilter::suppressed(mask, (int)goldmine::Datatype::Price));
+		REQUIRE(TickFilter::suppressed(mask, 150));
+		REQUIRE(!TickFilter::suppressed(filter.mask("SPBFUT#RIZ7"), (int)goldmine::Datatype::Price));
+		REQUIRE(!TickFilter::suppressed(filter.mask("SPBFUT#RIZ"), (int)goldmine::Datatype::Price));
+	}
+
+	SECTION("Wildcards match by prefix")
+	{
+		auto mask = filter.mask("SPBFUT#SiZ6");
+		REQUIRE(TickFilter::suppressed(mask, (int)goldmine::Datatype::Price));
+		REQUIRE(TickFilter::suppressed(mask, (int)goldmine::Datatype::Depth));
+		REQUIRE(!TickFilter::suppressed(mask, (int)goldmine::Datatype::BestBid));
+
+		mask = filter.mask("TQBR#SBER");
+		REQUIRE(TickFilter::suppressed(mask, (int)goldmine::Datatype::Depth));
+		REQUIRE(!TickFilter::suppressed(mask, (int)goldmine::Datatype::Price));
+	}
+
+	SECTION("Extended datatypes are filtered separately")
+	{
+		filter.addRule("SPBFUT#RI*/delta");
+		auto mask = filter.mask("SPBFUT#RIH7");
+		REQUIRE(TickFilter::suppressed(mask, ExtendedDatatype::Delta));
+		REQUIRE(!TickFilter::suppressed(mask, ExtendedDatatype::ImpliedVolatility));
+		REQUIRE(!TickFilter::suppressed(mask, ExtendedDatatype::Gamma));
+		REQUIRE(!TickFilter::suppressed(mask, ExtendedDatatype::Vega));
+		REQUIRE(!TickFilter::suppressed(mask, (int)goldmine::Datatype::Price));
+		REQUIRE(!TickFilter::suppressed(mask, 150));
+	}
+
+	SECTION("Pattern also matches the code without class")
+	{
+		filter.addRule("RIH7");
+		filter.addRule("GAZP*/price");
+		REQUIRE(TickFilter::suppressed(filter.mask("SPBFUT#RIH7"), (int)goldmine::Datatype::BestBid));
+		REQUIRE(TickFilter::suppressed(filter.mask("TQBR#GAZP"), (int)goldmine::Datatype::Price));
+		REQUIRE(!TickFilter::suppressed(filter.mask("TQBR#GAZP"), (int)goldmine::Datatype::BestBid));
+		REQUIRE(!TickFilter::suppressed(filter.mask("SPBFUT#RIH8"), (int)goldmine::Datatype::BestBid));
+	}
+
+	SECTION("Rules matching no instrument are reported")
+	{
+		filter.addRule("RIH7");
+		filter.addRule("TQBR#*");
+		auto unmatched = filter.unmatchedRules({ "SPBFUT#RIZ6", "SPBFUT#RIH7" });
+		REQUIRE(unmatched == std::vector<std::string>({ "SPBFUT#Si*/price", "TQBR#*" }));
+	}
+
+	SECTION("Malformed rules are rejected")
+	{
+		REQUIRE_THROWS(filter.addRule("SPB*FUT"));
+		REQUIRE_THROWS(filter.addRule("SPBFUT#RIZ6/unknown"));
+	}
+}
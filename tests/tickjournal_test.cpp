@@ -0,0 +1,102 @@
+/*
+ * tickjournal_test.cpp
+ */
+
+#include "catch.hpp"
+#include "core/journal/tickjournal.h"
+#include "core/journal/journalreader.h"
+#include "tests/testjournal.h"
+
+namespace
+{
+// 2016-11-01 10:00:00 UTC
+const uint64_t gs_day = 1477994400;
+}
+
+TEST_CASE("TickJournal", "[core][journal]")
+{
+	REQUIRE(journalDay(gs_day * 1000000) == 20161101);
+	REQUIRE(journalDay(0) == 19700101);
+	REQUIRE(journalDay(951782400ULL * 1000000) == 20000229);
+
+	TempDirectory directory;
+	{
+		TickJournal journal(directory.path, 4, 4096);
+		std::vector<TickUpdate> ticks;
+		for(int i = 0; i < 300; i++)
+			ticks.push_back(makeTick(i % 2 ? "SPBFUT#RIZ6" : "SPBFUT#SiZ6", gs_day + i, i, 100 + i * 0.5, i));
+		journal.consume(ticks.data(), ticks.size());
+		REQUIRE(journal.day() == 20161101);
+
+		// Next day goes to its own file
+		auto next = makeTick("SPBFUT#RIZ6", gs_day + 86400, 0, 1, 1);
+		journal.consume(&next, 1);
+		REQUIRE(journal.day() == 20161102);
+		REQUIRE(journal.ticks() == 301);
+	}
+
+	{
+		JournalReader reader(journalFileName(directory.path, 20161101));
+		REQUIRE(reader.day() == 20161101);
+		REQUIRE(reader.ticks() == 300);
+		REQUIRE(reader.blocks() == 75);
+		REQUIRE(reader.instruments() == 2);
+		REQUIRE(reader.instrumentName(0) == "SPBFUT#SiZ6");
+		REQUIRE(reader.instrument("SPBFUT#RIZ6") == 1);
+		REQUIRE(reader.instrument("SPBFUT#BRZ6") == NoJournalInstrument);
+
+		int i = 0;
+		JournalColumns columns;
+		for(size_t block = 0; block < reader.blocks(); block++)
+		{
+			reader.readBlock(block, columns);
+			REQUIRE(reader.blockHeader(block).firstTimestamp == columns.timestamps[0]);
+			REQUIRE(reader.blockHeader(block).lastTimestamp == columns.timestamps[columns.count - 1]);
+			for(size_t j = 0; j < columns.count; j++, i++)
+			{
+				REQUIRE(columns.instruments[j] == (uint32_t)(i % 2));
+				REQUIRE(columns.datatypes[j] == (int)goldmine::Datatype::Price);
+				REQUIRE(columns.timestamps[j] == (gs_day + i) * 1000000 + i);
+				REQUIRE(columns.values[j] == Approx(100 + i * 0.5));
+				REQUIRE(columns.volumes[j] == i);
+			}
+		}
+		REQUIRE(i == 300);
+	}
+
+	// Restart appends to the file of the day and keeps instrument ids
+	{
+		TickJournal journal(directory.path, 4, 4096);
+		auto ri = makeTick("SPBFUT#RIZ6", gs_day + 1000, 0, 2, 2);
+		auto br = makeTick("SPBFUT#BRZ6", gs_day + 1001, 0, 3, 3);
+		journal.consume(&ri, 1);
+		journal.consume(&br, 1);
+	}
+
+	JournalReader reader(journalFileName(directory.path, 20161101));
+	REQUIRE(reader.ticks() == 302);
+	REQUIRE(reader.instruments() == 3);
+	REQUIRE(reader.instrument("SPBFUT#BRZ6") == 2);
+
+	JournalColumns columns;
+	reader.readBlock(reader.blocks() - 1, columns);
+	REQUIRE(columns.count == 2);
+	REQUIRE(columns.instruments[0] == 1);
+	REQUIRE(columns.instruments[1] == 2);
+	REQUIRE(columns.values[1] == 3);
+
+	REQUIRE(JournalReader(journalFileName(directory.path, 20161102)).ticks() == 1);
+
+	// Late ticks of the previous day stay in the current file
+	{
+		TickJournal journal(directory.path, 4, 4096);
+		std::vector<TickUpdate> ticks;
+		for(int i = 0; i < 10; i++)
+			ticks.push_back(makeTick("SPBFUT#RIZ6", gs_day + (i % 2 ? 86400 : 0) + i, 0, 4, 4));
+		journal.consume(ticks.data(), ticks.size());
+		REQUIRE(journal.day() == 20161102);
+	}
+
+	REQUIRE(JournalReader(journalFileName(directory.path, 20161101)).ticks() == 303);
+	REQUIRE(JournalReader(journalFileName(directory.path, 20161102)).ticks() == 10);
+}
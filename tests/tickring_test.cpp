@@ -0,0 +1,157 @@
+/*
+ * tickring_test.cpp
+ */
+
+#include "catch.hpp"
+#include "core/tickring.h"
+
+#include <thread>
+
+namespace
+{
+TickUpdate makeUpdate(InstrumentId instrument, int volume)
+{
+	goldmine::Tick tick;
+	tick.datatype = (int)goldmine::Datatype::Price;
+	tick.value = 100;
+	tick.volume = volume;
+	return TickUpdate { instrument, tick };
+}
+}
+
+TEST_CASE("TickRing", "[core][ring]")
+{
+	REQUIRE_THROWS(TickRing(100));
+
+	TickRing ring(8);
+	int first = ring.addConsumer();
+	int second = ring.addConsumer();
+
+	std::vector<TickUpdate> updates;
+	for(int i = 0; i < 6; i++)
+		updates.push_back(makeUpdate(1, i));
+	ring.publish(updates.data(), updates.size());
+	REQUIRE(ring.lag(first) == 6);
+
+	std::vector<TickUpdate> out(16);
+	REQUIRE(ring.poll(first, out.data(), 4) == 4);
+	REQUIRE(out[3].tick.volume == 3);
+	REQUIRE(ring.poll(first, out.data(), out.size()) == 2);
+	REQUIRE(ring.poll(first, out.data(), out.size()) == 0);
+
+	SECTION("Every consumer sees every tick")
+	{
+		REQUIRE(ring.poll(second, out.data(), out.size()) == 6);
+		REQUIRE(out[0].tick.volume == 0);
+		REQUIRE(out[5].tick.volume == 5);
+	}
+
+	SECTION("Ring wraps once all consumers passed the slots")
+	{
+		REQUIRE(ring.poll(second, out.data(), out.size()) == 6);
+		updates.clear();
+		for(int i = 6; i < 14; i++)
+			updates.push_back(makeUpdate(1, i));
+		ring.publish(updates.data(), updates.size());
+
+		REQUIRE(ring.poll(second, out.data(), out.size()) == 8);
+		REQUIRE(out[0].tick.volume == 6);
+		REQUIRE(out[7].tick.volume == 13);
+	}
+}
+
+TEST_CASE("TickRing non-gating consumer", "[core][ring]")
+{
+	TickRing ring(4);
+	int slow = ring.addConsumer(false);
+
+	std::vector<TickUpdate> updates;
+	for(int i = 0; i < 10; i++)
+		updates.push_back(makeUpdate(1, i));
+	ring.publish(updates.data(), updates.size());
+
+	// Producer wasn't held back; the consumer gets the last lap only
+	std::vector<TickUpdate> out(16);
+	REQUIRE(ring.poll(slow, out.data(), out.size()) == 4);
+	REQUIRE(out[0].tick.volume == 6);
+	REQUIRE(ring.dropped(slow) == 6);
+	REQUIRE(ring.lag(slow) == 0);
+}
+
+TEST_CASE("TickRing with concurrent producers", "[core][ring]")
+{
+	const int producers = 4;
+	const int ticksPerProducer = 50000;
+
+	TickRing ring(1024);
+	int consumer = ring.addConsumer();
+
+	std::vector<std::thread> threads;
+	for(int p = 0; p < producers; p++)
+	{
+		threads.push_back(std::thread([&ring, p]()
+			{
+				std::vector<TickUpdate> batch;
+				for(int i = 0; i < ticksPerProducer; i++)
+				{
+					batch.push_back(makeUpdate(p + 1, i));
+					if(batch.size() == 7 || i == ticksPerProducer - 1)
+					{
+						ring.publish(batch.data(), batch.size());
+						batch.clear();
+					}
+				}
+			}));
+	}
+
+	std::vector<int> expected(producers, 0);
+	std::vector<TickUpdate> out(256);
+	int received = 0;
+	bool ordered = true;
+	while(received < producers * ticksPerProducer)
+	{
+		auto count = ring.poll(consumer, out.data(), out.size());
+		for(size_t i = 0; i < count; i++)
+		{
+			auto& next = expected[out[i].instrument - 1];
+			ordered = ordered && (out[i].tick.volume == next);
+			next++;
+		}
+		received += count;
+		if(count == 0)
+			std::this_thread::yield();
+	}
+	for(auto& thread : threads)
+		thread.join();
+
+	REQUIRE(ordered);
+	REQUIRE(ring.lag(consumer) == 0);
+}
+
+TEST_CASE("TickRing wakes idle consumers", "[core][ring]")
+{
+	TickRing ring(8);
+	int consumer = ring.addConsumer();
+
+	REQUIRE(!ring.waitForTicks(consumer, boost::chrono::milliseconds(1)));
+
+	std::thread producer([&]()
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			auto update = makeUpdate(1, 1);
+			ring.publish(&update, 1);
+		});
+	// Producer wakes the consumer long before the timeout
+	auto started = boost::chrono::steady_clock::now();
+	REQUIRE(ring.waitForTicks(consumer, boost::chrono::milliseconds(10000)));
+	REQUIRE(boost::chrono::steady_clock::now() - started < boost::chrono::seconds(5));
+	producer.join();
+
+	std::vector<TickUpdate> out(8);
+	REQUIRE(ring.poll(consumer, out.data(), out.size()) == 1);
+
+	// Ticks already waiting are reported without blocking
+	auto update = makeUpdate(1, 2);
+	ring.publish(&update, 1);
+	REQUIRE(ring.waitForTicks(consumer, boost::chrono::milliseconds(10000)));
+}
@@ -0,0 +1,116 @@
+/*
+ * tradededupindex_test.cpp
+ */
+
+#include "catch.hpp"
+#include "core/tables/tradededupindex.h"
+#include "core/tables/parsers/alldealstableparser.h"
+#include "tests/testsinks.h"
+
+#include <boost/filesystem.hpp>
+
+namespace
+{
+struct TempFile
+{
+	TempFile() : path((boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string())
+	{
+	}
+
+	~TempFile()
+	{
+		boost::filesystem::remove(path);
+	}
+
+	std::string path;
+};
+
+XlTable::Ptr makeDeals(int firstTradeNum, int count, const std::string& classCode = "SPBFUT")
+{
+	auto table = std::make_shared<XlTable>(9, count + 1);
+	std::vector<std::string> header = { "CLASSCODE", "SECCODE", "TRADEDATE", "TRADETIME", "TRADETIME_MSEC",
+		"PRICE", "QTY", "BUYSELL", "TRADENUM" };
+	for(size_t i = 0; i < header.size(); i++)
+		table->set(0, i, header[i]);
+	for(int i = 0; i < count; i++)
+	{
+		table->set(i + 1, 0, classCode);
+		table->set(i + 1, 1, std::string("SiZ6"));
+		table->set(i + 1, 2, std::string("19.10.2026"));
+		table->set(i + 1, 3, std::string("10:00:01"));
+		table->set(i + 1, 4, 0.);
+		table->set(i + 1, 5, 64000.);
+		table->set(i + 1, 6, 1.);
+		table->set(i + 1, 7, std::string("Buy"));
+		table->set(i + 1, 8, (double)(firstTradeNum + i));
+	}
+	return table;
+}
+}
+
+TEST_CASE("TradeDedupIndex", "[tables][all_deals]")
+{
+	TempFile file;
+
+	{
+		TradeDedupIndex index(file.path, 1024);
+		index.setSession(20261019);
+		REQUIRE(index.insert(1000000));
+		REQUIRE(!index.insert(1000000));
+		REQUIRE(index.insert(1000001));
+
+		// Outside of the bitmap window
+		REQUIRE(index.insert(5000000));
+		REQUIRE(!index.insert(5000000));
+		REQUIRE(index.insert(10));
+		REQUIRE(index.size() == 4);
+	}
+
+	{
+		// Bitmap survives reopening
+		TradeDedupIndex index(file.path, 1024);
+		REQUIRE(index.session() == 20261019);
+		REQUIRE(index.contains(1000000));
+		REQUIRE(!index.insert(1000001));
+		REQUIRE(!index.contains(1000002));
+
+		// New session starts empty
+		index.setSession(20261020);
+		REQUIRE(index.size() == 0);
+		REQUIRE(index.insert(1000002));
+	}
+
+	{
+		// Capacity change recreates index
+		TradeDedupIndex index(file.path, 2048);
+		REQUIRE(!index.contains(1000002));
+	}
+}
+
+TEST_CASE("AllDealsTableParser dedup across restart", "[tables][all_deals]")
+{
+	TempFile file;
+	Json::Value config;
+	config["dedup_file"] = file.path;
+
+	auto sink = std::make_shared<CollectingSink>();
+	{
+		AllDealsTableParser parser("alld", sink);
+		parser.parseConfig(config);
+		parser.incomingTable(makeDeals(700, 3));
+	}
+	REQUIRE(sink->ticks.size() == 3);
+
+	AllDealsTableParser restarted("alld", sink);
+	restarted.parseConfig(config);
+	restarted.incomingTable(makeDeals(700, 5));
+	REQUIRE(sink->ticks.size() == 5);
+
+	// Other class has its own trade numbers and its own index
+	restarted.incomingTable(makeDeals(700, 2, "TQBR"));
+	REQUIRE(sink->ticks.size() == 7);
+	REQUIRE(boost::filesystem::exists(file.path + ".SPBFUT"));
+	REQUIRE(boost::filesystem::exists(file.path + ".TQBR"));
+	boost::filesystem::remove(file.path + ".SPBFUT");
+	boost::filesystem::remove(file.path + ".TQBR");
+}
@@ -0,0 +1,54 @@
+/*
+ * workerpool_test.cpp
+ */
+
+#include "catch.hpp"
+#include "core/workerpool.h"
+#include "exceptions.h"
+
+TEST_CASE("WorkerPool", "[core][workerpool]")
+{
+	WorkerPool pool(4);
+
+	SECTION("Runs every task once")
+	{
+		std::vector<std::atomic<int>> counters(1000);
+		pool.run(counters.size(), [&](int task) { counters[task]++; });
+
+		bool once = true;
+		for(const auto& counter : counters)
+			once = once && (counter == 1);
+		REQUIRE(once);
+	}
+
+	SECTION("Task exception is rethrown from run")
+	{
+		std::atomic<int> done(0);
+		std::atomic<bool> failed(false);
+		REQUIRE_THROWS_AS(pool.run(1000, [&](int task)
+				{
+					if(task == 10)
+					{
+						failed = true;
+						BOOST_THROW_EXCEPTION(LogicError() << errinfo_str("Task failed"));
+					}
+					// Later tasks finish only after the failure, giving the pool
+					// time to cancel the rest
+					if(task > 10)
+					{
+						while(!failed)
+							boost::this_thread::yield();
+						boost::this_thread::sleep_for(boost::chrono::milliseconds(10));
+					}
+					done++;
+				}), LogicError);
+		// Tasks before the failing one, plus at most one in flight per other thread
+		REQUIRE(done >= 10);
+		REQUIRE(done <= 10 + pool.size() - 1);
+
+		// Pool is usable after failure
+		done = 0;
+		pool.run(100, [&](int task) { done++; });
+		REQUIRE(done == 100);
+	}
+}
@@ -3,9 +3,11 @@
 
 MainWindow::MainWindow() : Fl_Window(800, 600)
 {
-	m_box = std::unique_ptr<Fl_Box>(new Fl_Box(10, 10, 780, 580, "Goldmine-Quik Gateway v2"));
+	m_box = std::unique_ptr<Fl_Box>(new Fl_Box(10, 10, 780, 540, "Goldmine-Quik Gateway v2"));
 	m_box->box(FL_UP_BOX);
 	m_box->labelfont(FL_BOLD);
+	m_dumpStatsButton = std::unique_ptr<Fl_Button>(new Fl_Button(10, 560, 200, 30, "Dump latency stats"));
+	m_dumpStatsButton->callback(&MainWindow::dumpStatsButtonClicked, this);
 	this->end();
 }
 
@@ -13,3 +15,14 @@ MainWindow::~MainWindow()
 {
 }
 
+void MainWindow::setDumpStatsCallback(const std::function<void()>& callback)
+{
+	m_dumpStatsCallback = callback;
+}
+
+void MainWindow::dumpStatsButtonClicked(Fl_Widget* widget, void* data)
+{
+	auto wnd = static_cast<MainWindow*>(data);
+	if(wnd->m_dumpStatsCallback)
+		wnd->m_dumpStatsCallback();
+}
@@ -5,11 +5,13 @@
 #ifndef UI_MAINWINDOW_H_
 #define UI_MAINWINDOW_H_
 
+#include <functional>
 #include <memory>
 
 #include <FL/Fl.H>
 #include <FL/Fl_Window.H>
 #include <FL/Fl_Box.H>
+#include <FL/Fl_Button.H>
 
 class MainWindow : public Fl_Window
 {
@@ -17,8 +19,15 @@ public:
 	MainWindow();
 	virtual ~MainWindow();
 
+	void setDumpStatsCallback(const std::function<void()>& callback);
+
+private:
+	static void dumpStatsButtonClicked(Fl_Widget* widget, void* data);
+
 private:
 	std::unique_ptr<Fl_Box> m_box;
+	std::unique_ptr<Fl_Button> m_dumpStatsButton;
+	std::function<void()> m_dumpStatsCallback;
 };
 
 #endif /* UI_MAINWINDOW_H_ */
@@ -0,0 +1,72 @@
+/*
+ * texttableparser.cpp
+ */
+
+#include "texttableparser.h"
+
+#include "binary/textscanner.h"
+
+#include <algorithm>
+
+TextTableParser::TextTableParser()
+{
+}
+
+TextTableParser::~TextTableParser()
+{
+}
+
+void TextTableParser::parse(const uint8_t* data, int datalength)
+{
+	const char* begin = reinterpret_cast<const char*>(data);
+	const char* end = begin + datalength;
+
+	while(end > begin && (end[-1] == '\0' || end[-1] == '\n' || end[-1] == '\r'))
+		end--;
+
+	if(begin == end)
+	{
+		m_table = std::make_shared<XlTable>(0, 0);
+		return;
+	}
+
+	// Lines may be ragged (e.g. trailing empty cells dropped), so the table
+	// is as wide as the widest line; missing cells stay empty
+	int width = 0;
+	int row = 0;
+	int column = 0;
+	m_fields.clear();
+	scanFields(begin, end, '\t', [&](const char* fieldBegin, const char* fieldEnd, bool endOfLine)
+		{
+			if(fieldBegin != fieldEnd)
+				m_fields.push_back(Field { fieldBegin, fieldEnd, row, column });
+			width = std::max(width, column + 1);
+
+			if(endOfLine)
+			{
+				row++;
+				column = 0;
+			}
+			else
+			{
+				column++;
+			}
+		});
+
+	// scanFields doesn't report an empty field ending the last line
+	if(column > 0)
+	{
+		width = std::max(width, column + 1);
+		row++;
+	}
+
+	m_table = std::make_shared<XlTable>(width, row);
+	for(const auto& field : m_fields)
+	{
+		double value;
+		if(parseNumber(field.begin, field.end, value))
+			m_table->set(field.row, field.column, value);
+		else
+			m_table->setString(field.row, field.column, field.begin, field.end);
+	}
+}
@@ -0,0 +1,46 @@
+/*
+ * texttableparser.h
+ */
+
+#ifndef CORE_TEXTTABLEPARSER_H_
+#define CORE_TEXTTABLEPARSER_H_
+
+#include "xltable.h"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Parses CF_TEXT DDE data (cells separated by tabs, rows by CRLF) into the
+ * same XlTable representation XlParser produces: numeric cells become
+ * doubles, empty cells stay empty and everything else is a string. Table
+ * width is the widest line; cells missing from shorter lines are empty.
+ *
+ * The data is scanned once: non-empty fields are collected with their
+ * positions while the table size is counted, then stored into the table.
+ * Reuse the parser to keep the field buffer allocated.
+ */
+class TextTableParser
+{
+public:
+	TextTableParser();
+	virtual ~TextTableParser();
+
+	void parse(const uint8_t* data, int datalength);
+
+	XlTable::Ptr getParsedTable() const { return m_table; }
+
+private:
+	struct Field
+	{
+		const char* begin;
+		const char* end;
+		int row;
+		int column;
+	};
+
+	XlTable::Ptr m_table;
+	std::vector<Field> m_fields;
+};
+
+#endif /* CORE_TEXTTABLEPARSER_H_ */
@@ -4,11 +4,11 @@
 
 #include "xltable.h"
 
-XlTable::XlTable() : m_width(0), m_height(0)
+XlTable::XlTable() : m_width(0), m_height(0), m_originRow(0), m_originColumn(0), m_arrivalTime(0)
 {
 }
 
-XlTable::XlTable(int width, int height) : m_width(width), m_height(height)
+XlTable::XlTable(int width, int height) : m_width(width), m_height(height), m_originRow(0), m_originColumn(0), m_arrivalTime(0)
 {
 	m_data.resize(width * height, XlCell(XlEmpty()));
 }
@@ -32,7 +32,45 @@ void XlTable::set(int row, int column, const XlCell& value)
 	m_data[row * m_width + column] = value;
 }
 
+void XlTable::setString(int row, int column, const char* begin, const char* end)
+{
+	auto& cell = m_data[row * m_width + column];
+	auto string = boost::get<std::string>(&cell);
+	if(!string)
+	{
+		cell = std::string();
+		string = boost::get<std::string>(&cell);
+	}
+	string->assign(begin, end);
+}
+
 XlTable::XlCell XlTable::get(int row, int column)
 {
 	return m_data[row * m_width + column];
 }
+
+void XlTable::setOrigin(int row, int column)
+{
+	m_originRow = row;
+	m_originColumn = column;
+}
+
+int XlTable::originRow() const
+{
+	return m_originRow;
+}
+
+int XlTable::originColumn() const
+{
+	return m_originColumn;
+}
+
+void XlTable::setArrivalTime(uint64_t microseconds)
+{
+	m_arrivalTime = microseconds;
+}
+
+uint64_t XlTable::arrivalTime() const
+{
+	return m_arrivalTime;
+}
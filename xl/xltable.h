@@ -7,6 +7,7 @@
 
 #include <boost/variant.hpp>
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 
@@ -26,11 +27,39 @@ public:
 	int height() const;
 
 	void set(int row, int column, const XlCell& value);
+
+	/**
+	 * Stores string cell built in place, without a temporary std::string
+	 */
+	void setString(int row, int column, const char* begin, const char* end);
 	XlCell get(int row, int column);
 
+	const XlCell& cell(int row, int column) const
+	{
+		return m_data[row * m_width + column];
+	}
+
+	/**
+	 * Position of the top-left cell of this block in the source table
+	 * (zero-based). DDE pokes may carry only a part of the table.
+	 */
+	void setOrigin(int row, int column);
+	int originRow() const;
+	int originColumn() const;
+
+	/**
+	 * Wall time when the block arrived, microseconds since epoch; zero if
+	 * the source didn't stamp it. Every tick parsed from the block shares it.
+	 */
+	void setArrivalTime(uint64_t microseconds);
+	uint64_t arrivalTime() const;
+
 private:
 	int m_width;
 	int m_height;
+	int m_originRow;
+	int m_originColumn;
+	uint64_t m_arrivalTime;
 
 	std::vector<XlCell> m_data;
 };